@@ -14,22 +14,167 @@
 
 #include "lldb-eval/api.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "lldb-eval/ast.h"
+#include "lldb-eval/ast_printer.h"
+#include "lldb-eval/ast_serialization.h"
+#include "lldb-eval/batch_planner.h"
+#include "lldb-eval/child_pager.h"
+#include "lldb-eval/enum_table.h"
 #include "lldb-eval/eval.h"
 #include "lldb-eval/expression_context.h"
+#include "lldb-eval/memory_reader.h"
+#include "lldb-eval/module_index.h"
 #include "lldb-eval/parser.h"
+#include "lldb-eval/range_evaluator.h"
+#include "lldb-eval/result_cache.h"
+#include "lldb-eval/result_view.h"
+#include "lldb-eval/scope_resolver.h"
 #include "lldb-eval/value.h"
+#include "lldb-eval/watch_set.h"
 #include "lldb/API/SBError.h"
 #include "lldb/API/SBExecutionContext.h"
 #include "lldb/API/SBFrame.h"
+#include "lldb/API/SBModule.h"
+#include "lldb/API/SBProcess.h"
 #include "lldb/API/SBTarget.h"
 #include "lldb/API/SBValue.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ThreadPool.h"
+
+namespace {
+
+class TargetPreparationImpl : public lldb_eval::TargetPreparation {
+ public:
+  TargetPreparationImpl(
+      uint32_t num_modules,
+      std::function<void(uint32_t, uint32_t)> progress_callback)
+      : num_modules_(num_modules),
+        num_indexed_(0),
+        num_completed_(0),
+        progress_callback_(std::move(progress_callback)) {}
+
+  uint32_t GetNumModules() const override { return num_modules_; }
+
+  uint32_t GetNumIndexedModules() const override { return num_indexed_; }
+
+  bool IsDone() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_completed_ == num_modules_;
+  }
+
+  void Wait() override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return num_completed_ == num_modules_; });
+  }
+
+  void OnModuleIndexed() {
+    uint32_t indexed = ++num_indexed_;
+    if (progress_callback_) {
+      progress_callback_(indexed, num_modules_);
+    }
+
+    // Count the module as completed only after the callback has returned, so
+    // that Wait() doesn't return while the callback is still running.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (++num_completed_ == num_modules_) {
+      cv_.notify_all();
+    }
+  }
+
+ private:
+  const uint32_t num_modules_;
+  std::atomic<uint32_t> num_indexed_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  uint32_t num_completed_;
+
+  std::function<void(uint32_t, uint32_t)> progress_callback_;
+};
+
+// Indexing runs on its own pool, so that it never delays the lookups, which
+// use a pool of their own.
+llvm::ThreadPool& GetIndexingPool() {
+  static llvm::ThreadPool* pool = new llvm::ThreadPool();
+  return *pool;
+}
+
+}  // namespace
 
 namespace lldb_eval {
 
+namespace {
+
+void SetSyntaxError(const std::string& message, lldb::SBError& error) {
+  error.SetError(
+      static_cast<uint32_t>(EvalErrorCode::INVALID_EXPRESSION_SYNTAX),
+      lldb::eErrorTypeGeneric);
+  error.SetErrorString(message.c_str());
+}
+
+lldb::SBValue EvaluateAst(ExpressionContext& expr_ctx, const AstNode* tree,
+                          lldb::SBError& error) {
+  Interpreter eval(expr_ctx);
+
+  EvalError err;
+  Value result = eval.Eval(tree, err);
+
+  if (err) {
+    error.SetError(static_cast<uint32_t>(err.code()), lldb::eErrorTypeGeneric);
+    error.SetErrorString(err.message().c_str());
+    return lldb::SBValue();
+  }
+
+  return result.AsSbValue(expr_ctx.GetExecutionContext().GetTarget());
+}
+
+lldb::SBValue EvaluateAstCached(lldb::SBFrame frame,
+                                ExpressionContext& expr_ctx,
+                                const AstNode* tree,
+                                const EvaluateOptions& options,
+                                lldb::SBError& error) {
+  // Without a frame there is no stop to scope the results to.
+  if (!options.use_result_cache || !frame.IsValid()) {
+    return EvaluateAst(expr_ctx, tree, error);
+  }
+
+  // The results are keyed by the canonical form, so that e.g. "a+b" and
+  // "(a) + b" share the result.
+  ResultCache& cache = ResultCache::Get();
+  std::string canonical = PrintCanonical(tree);
+
+  lldb::SBValue value;
+  if (cache.Lookup(frame, canonical, &value, &error)) {
+    return value;
+  }
+
+  value = EvaluateAst(expr_ctx, tree, error);
+  cache.Insert(frame, canonical, value, error);
+  return value;
+}
+
+// The stop ID doesn't change when the process is modified while it stays
+// stopped, everything cached during the stop is dropped.
+void InvalidateAfterWrite() {
+  ResultCache::Get().Invalidate();
+  InvalidateStopCache();
+}
+
+}  // namespace
+
 lldb::SBValue EvaluateExpression(lldb::SBFrame frame, const char* expression,
-                                 lldb::SBError& error) {
+                                 lldb::SBError& error,
+                                 const EvaluateOptions& options) {
   error.Clear();
 
   ExpressionContext expr_ctx(expression, lldb::SBExecutionContext(frame));
@@ -38,25 +183,193 @@ lldb::SBValue EvaluateExpression(lldb::SBFrame frame, const char* expression,
   auto expr = p.Run();
 
   if (p.HasError()) {
-    error.SetError(
-        static_cast<uint32_t>(EvalErrorCode::INVALID_EXPRESSION_SYNTAX),
-        lldb::eErrorTypeGeneric);
-    error.SetErrorString(p.GetError().c_str());
+    SetSyntaxError(p.GetError(), error);
     return lldb::SBValue();
   }
 
+  return EvaluateAstCached(frame, expr_ctx, expr.get(), options, error);
+}
+
+bool EvaluateExpressionInto(lldb::SBFrame frame, const char* expression,
+                            ResultView& result, lldb::SBError& error) {
+  error.Clear();
+
+  ExpressionContext expr_ctx(expression, lldb::SBExecutionContext(frame));
+
+  Parser p(expr_ctx);
+  auto expr = p.Run();
+
+  if (p.HasError()) {
+    SetSyntaxError(p.GetError(), error);
+    return false;
+  }
+
   Interpreter eval(expr_ctx);
 
   EvalError err;
-  Value result = eval.Eval(expr.get(), err);
+  Value value = eval.Eval(expr.get(), err);
 
   if (err) {
     error.SetError(static_cast<uint32_t>(err.code()), lldb::eErrorTypeGeneric);
     error.SetErrorString(err.message().c_str());
+    return false;
+  }
+
+  return ResultViewBuilder::Build(
+      value, expr_ctx.GetExecutionContext().GetTarget(), &result, error);
+}
+
+bool EvaluateExpressionOverRange(lldb::SBFrame frame, const char* expression,
+                                 const char* index_name, int64_t begin,
+                                 int64_t end, RangeResult& result,
+                                 lldb::SBError& error) {
+  error.Clear();
+
+  ExpressionContext expr_ctx(expression, lldb::SBExecutionContext(frame));
+
+  Parser p(expr_ctx);
+  auto expr = p.Run();
+
+  if (p.HasError()) {
+    SetSyntaxError(p.GetError(), error);
+    return false;
+  }
+
+  EvalError err;
+  if (!EvaluateOverRange(expr_ctx, expr.get(), index_name, begin, end,
+                         &result, err)) {
+    error.SetError(static_cast<uint32_t>(err.code()), lldb::eErrorTypeGeneric);
+    error.SetErrorString(err.message().c_str());
+    return false;
+  }
+
+  return true;
+}
+
+std::string SerializeExpression(lldb::SBFrame frame, const char* expression,
+                                lldb::SBError& error) {
+  error.Clear();
+
+  ExpressionContext expr_ctx(expression, lldb::SBExecutionContext(frame));
+
+  Parser p(expr_ctx);
+  auto expr = p.Run();
+
+  if (p.HasError()) {
+    SetSyntaxError(p.GetError(), error);
+    return std::string();
+  }
+
+  return SerializeAst(expr.get());
+}
+
+lldb::SBValue EvaluateSerializedExpression(lldb::SBFrame frame,
+                                           const void* data, size_t size,
+                                           lldb::SBError& error,
+                                           const EvaluateOptions& options) {
+  error.Clear();
+
+  std::string decode_error;
+  auto expr = DeserializeAst(
+      llvm::StringRef(static_cast<const char*>(data), size), &decode_error);
+  if (!expr) {
+    SetSyntaxError(decode_error, error);
     return lldb::SBValue();
   }
 
-  return result.AsSbValue(expr_ctx.GetExecutionContext().GetTarget());
+  // The context needs the expression text for the diagnostics.
+  ExpressionContext expr_ctx(PrintCanonical(expr.get()),
+                             lldb::SBExecutionContext(frame));
+  return EvaluateAstCached(frame, expr_ctx, expr.get(), options, error);
+}
+
+ExpressionKey GetExpressionKey(lldb::SBFrame frame, const char* expression,
+                               lldb::SBError& error) {
+  error.Clear();
+
+  ExpressionContext expr_ctx(expression, lldb::SBExecutionContext(frame));
+
+  Parser p(expr_ctx);
+  auto expr = p.Run();
+
+  if (p.HasError()) {
+    SetSyntaxError(p.GetError(), error);
+    return ExpressionKey{"", 0, 0};
+  }
+
+  return GetExpressionKey(expr.get());
+}
+
+std::vector<EvaluationResult> EvaluateExpressions(
+    lldb::SBFrame frame, const std::vector<std::string>& expressions) {
+  return EvaluateBatch(frame, expressions);
+}
+
+void InvalidateResultCache() { ResultCache::Get().Invalidate(); }
+
+void SetResultCacheCapacity(size_t capacity) {
+  ResultCache::Get().SetCapacity(capacity);
+}
+
+ResultCacheStats GetResultCacheStats() { return ResultCache::Get().GetStats(); }
+
+bool SetValueFromCString(lldb::SBValue value, const char* value_str,
+                         lldb::SBError& error) {
+  bool success = value.SetValueFromCString(value_str, error);
+  // Even a failed write could have modified a part of the value.
+  InvalidateAfterWrite();
+  return success;
+}
+
+size_t WriteMemory(lldb::SBProcess process, lldb::addr_t address,
+                   const void* buffer, size_t size, lldb::SBError& error) {
+  size_t written = process.WriteMemory(address, buffer, size, error);
+  InvalidateAfterWrite();
+  return written;
+}
+
+void InvalidateMemoryCache() { InvalidateStopCache(); }
+
+void SetMemoryCacheCapacity(size_t capacity) {
+  SetStopCacheCapacity(capacity);
+}
+
+std::shared_ptr<TargetPreparation> PrepareTarget(
+    lldb::SBTarget target, const PrepareTargetOptions& options) {
+  std::vector<lldb::SBModule> modules;
+  uint32_t num_modules = target.GetNumModules();
+  for (uint32_t i = 0; i < num_modules; ++i) {
+    lldb::SBModule module = target.GetModuleAtIndex(i);
+    if (module.IsValid()) {
+      modules.push_back(module);
+    }
+  }
+
+  auto preparation = std::make_shared<TargetPreparationImpl>(
+      static_cast<uint32_t>(modules.size()), options.progress_callback);
+
+  // Takes the snapshot of the modules, the first evaluation doesn't have to.
+  ScopeResolver::Get(target);
+
+  for (const auto& module : modules) {
+    GetIndexingPool().async([preparation, module] {
+      // Loads the index from the cache or builds it.
+      ModuleIndex::Get(module);
+      PrepareEnumerators(module);
+      preparation->OnModuleIndexed();
+    });
+  }
+
+  return preparation;
+}
+
+std::unique_ptr<WatchSet> CreateWatchSet() {
+  return std::make_unique<WatchSetImpl>();
+}
+
+std::unique_ptr<ChildPager> CreateChildPager(lldb::SBValue value,
+                                             const ChildPageOptions& options) {
+  return std::make_unique<ChildPagerImpl>(value, options);
 }
 
 }  // namespace lldb_eval
@@ -17,17 +17,366 @@
 #ifndef LLDB_EVAL_API_H_
 #define LLDB_EVAL_API_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "lldb-eval/defines.h"
 #include "lldb/API/SBError.h"
 #include "lldb/API/SBFrame.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/API/SBTarget.h"
+#include "lldb/API/SBType.h"
 #include "lldb/API/SBValue.h"
+#include "lldb/lldb-enumerations.h"
+#include "lldb/lldb-types.h"
 
 namespace lldb_eval {
 
+struct EvaluateOptions {
+  // Memoize the result while the process stays stopped, see
+  // InvalidateResultCache(). Only for the clients that modify the process
+  // through SetValueFromCString() and WriteMemory(), or invalidate the cache
+  // after each write made through the SB API directly.
+  bool use_result_cache = false;
+};
+
+LLDB_EVAL_API
+lldb::SBValue EvaluateExpression(
+    lldb::SBFrame frame, const char* expression, lldb::SBError& error,
+    const EvaluateOptions& options = EvaluateOptions());
+
+// Options of the native value formatting (see ResultView::FormatValue()).
+struct FormatOptions {
+  enum class Radix { kDecimal, kHexadecimal, kOctal, kBinary };
+
+  // Radix of the integers. In non-decimal radixes all values are printed as
+  // their bit pattern, padded to the size of the value.
+  Radix radix = Radix::kDecimal;
+};
+
+// Result of EvaluateExpressionInto(): the bytes of the result written into a
+// caller-provided buffer and a lightweight description of its type. The SBValue
+// is created only if requested with GetSbValue().
+class LLDB_EVAL_API ResultView {
+ public:
+  ResultView(void* buffer, size_t buffer_size);
+
+  // Size of the result in bytes. If it's larger than the buffer, nothing is
+  // written into the buffer.
+  size_t size() const { return size_; }
+  const void* data() const { return buffer_; }
+
+  // Basic type of the result, lldb::eBasicTypeInvalid if the result is not of
+  // a basic type (e.g. a pointer or a struct). Typedefs are resolved.
+  lldb::BasicType basic_type() const { return basic_type_; }
+  bool is_pointer() const { return is_pointer_; }
+  bool is_enum() const { return is_enum_; }
+
+  // The type name is looked up only when requested.
+  std::string GetTypeName() const;
+
+  // Format the value and the type name into the buffer without allocating, if
+  // the result is a scalar, a pointer or an enumerator. Other results (e.g.
+  // structs) fall back to the LLDB formatters. Like snprintf(), return the
+  // length of the full output, which is truncated if it doesn't fit.
+  size_t FormatValue(char* buffer, size_t buffer_size,
+                     const FormatOptions& options = FormatOptions()) const;
+  size_t FormatTypeName(char* buffer, size_t buffer_size) const;
+
+  // Creates an SBValue holding the result, like EvaluateExpression() returns.
+  lldb::SBValue GetSbValue() const;
+
+ private:
+  friend class ResultViewBuilder;
+
+  void* buffer_;
+  size_t buffer_size_;
+  size_t size_;
+  lldb::BasicType basic_type_;
+  bool is_pointer_;
+  bool is_enum_;
+
+  lldb::SBTarget target_;
+  // Type of the result, invalid for the scalars computed by the interpreter
+  // (their type is the basic type).
+  lldb::SBType type_;
+  // Set if the result is an existing LLDB value (e.g. a variable).
+  lldb::SBValue value_;
+};
+
+// Evaluates the expression and writes the result into |result|. Unlike
+// EvaluateExpression() it doesn't create an SBValue for the results computed
+// by the interpreter, which makes it cheaper for the clients which only need
+// the bytes of the result. The results are not cached.
+LLDB_EVAL_API
+bool EvaluateExpressionInto(lldb::SBFrame frame, const char* expression,
+                            ResultView& result, lldb::SBError& error);
+
+// Parses the expression in the given frame and returns its compact binary
+// encoding, which can be stored or sent to another process and evaluated
+// without parsing it again. The encoding is versioned, encodings produced by
+// other versions of the library are rejected.
+LLDB_EVAL_API
+std::string SerializeExpression(lldb::SBFrame frame, const char* expression,
+                                lldb::SBError& error);
+
+// Evaluates the expression encoded by SerializeExpression(). The data is
+// decoded in place, e.g. it can point into a memory mapped file.
+LLDB_EVAL_API
+lldb::SBValue EvaluateSerializedExpression(
+    lldb::SBFrame frame, const void* data, size_t size, lldb::SBError& error,
+    const EvaluateOptions& options = EvaluateOptions());
+
+// Key identifying an expression in the caches, see GetExpressionKey().
+struct ExpressionKey {
+  // Canonical form of the expression, e.g. "a + b" for "(a)+b".
+  std::string canonical;
+  // 128-bit structural hash of the canonical form. The low half can be used
+  // as a 64-bit hash. The hash is stable across runs and processes.
+  uint64_t hash_low;
+  uint64_t hash_high;
+};
+
+// Parses the expression in the given frame and returns its key. Expressions
+// differing only in the whitespace, the redundant parentheses or the spelling
+// of the type names have the same key. The frame is required because the
+// parsing depends on the types visible in it, e.g. "(x)-1" is a cast if "x" is
+// a type.
+LLDB_EVAL_API
+ExpressionKey GetExpressionKey(lldb::SBFrame frame, const char* expression,
+                               lldb::SBError& error);
+
+struct EvaluationResult {
+  lldb::SBValue value;
+  lldb::SBError error;
+};
+
+// Evaluates a batch of expressions in the given frame. The subexpressions
+// shared by several expressions (e.g. "obj->a" in "obj->a->b" and "obj->a->c")
+// are evaluated once, so the number of the memory reads and the lookups
+// depends on the number of the distinct subexpressions. The results are not
+// cached.
+LLDB_EVAL_API
+std::vector<EvaluationResult> EvaluateExpressions(
+    lldb::SBFrame frame, const std::vector<std::string>& expressions);
+
+struct ResultCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t size;
+  uint64_t capacity;
+
+  double hit_ratio() const {
+    uint64_t total = hits + misses;
+    return total ? static_cast<double>(hits) / static_cast<double>(total)
+                 : 0.0;
+  }
+};
+
+// Results of the evaluations with EvaluateOptions::use_result_cache are cached
+// while the process stays stopped. The cache is invalidated automatically when
+// the process resumes and by the writes made through SetValueFromCString() and
+// WriteMemory(), but not when the memory or the registers are modified through
+// the SB API directly (e.g. lldb::SBProcess::WriteMemory). Call
+// InvalidateResultCache() after such writes.
+LLDB_EVAL_API
+void InvalidateResultCache();
+
+// Sets the maximum number of cached results, zero disables the cache.
+LLDB_EVAL_API
+void SetResultCacheCapacity(size_t capacity);
+
+LLDB_EVAL_API
+ResultCacheStats GetResultCacheStats();
+
+// Writes the value, like lldb::SBValue::SetValueFromCString(), and drops the
+// results and the memory cached during the current stop (see
+// InvalidateResultCache() and InvalidateMemoryCache()).
+LLDB_EVAL_API
+bool SetValueFromCString(lldb::SBValue value, const char* value_str,
+                         lldb::SBError& error);
+
+// Writes the memory of the process, like lldb::SBProcess::WriteMemory(), and
+// drops the results and the memory cached during the current stop.
+LLDB_EVAL_API
+size_t WriteMemory(lldb::SBProcess process, lldb::addr_t address,
+                   const void* buffer, size_t size, lldb::SBError& error);
+
+// The builtins walking the linked structures and the containers (e.g.
+// list_len() or std::map lookups) cache the nodes they read while the process
+// stays stopped. The cache is dropped automatically when the process resumes
+// and by the writes made through SetValueFromCString() and WriteMemory(), but
+// not by the writes made through the SB API directly (e.g.
+// lldb::SBProcess::WriteMemory). Call InvalidateMemoryCache() after such
+// writes.
+LLDB_EVAL_API
+void InvalidateMemoryCache();
+
+// Sets the maximum number of cached bytes, zero disables the cache.
+LLDB_EVAL_API
+void SetMemoryCacheCapacity(size_t capacity);
+
+struct PrepareTargetOptions {
+  // Called from a background thread every time a module is indexed.
+  std::function<void(uint32_t indexed_modules, uint32_t total_modules)>
+      progress_callback;
+};
+
+// Progress of the background work started by PrepareTarget().
+class LLDB_EVAL_API TargetPreparation {
+ public:
+  virtual ~TargetPreparation() = default;
+
+  virtual uint32_t GetNumModules() const = 0;
+  virtual uint32_t GetNumIndexedModules() const = 0;
+  virtual bool IsDone() const = 0;
+
+  // Blocks until all modules are indexed.
+  virtual void Wait() = 0;
+};
+
+// Builds the lookup indexes for all modules of the target on background
+// threads, together with the enumerator indexes and the tables of all
+// enumeration types. Expressions can be evaluated while the indexes are being
+// built, the modules without an index are searched the slow way. Call it again
+// when new modules are loaded, modules indexed before are skipped.
+//
+// The names are still resolved on the first use in each function, only their
+// lookups get faster.
+//
+// The background work must be finished (see TargetPreparation::Wait()) before
+// calling lldb::SBDebugger::Terminate().
+LLDB_EVAL_API
+std::shared_ptr<TargetPreparation> PrepareTarget(
+    lldb::SBTarget target,
+    const PrepareTargetOptions& options = PrepareTargetOptions());
+
+// State of an evaluation result at the time it was produced. SBValues of
+// variables are live and always show the current contents, so the previous
+// results are kept as snapshots.
+struct WatchSnapshot {
+  bool success;
+  std::string value;
+  std::string summary;
+  std::string type;
+  std::string error;
+};
+
+// Entry of the watch set whose result has changed since the previous call to
+// WatchSet::Evaluate().
+struct WatchChange {
+  uint32_t id;
+  lldb::SBValue value;
+  lldb::SBError error;
+  // True if the entry is evaluated for the first time, in which case
+  // |previous| is empty.
+  bool is_new;
+  WatchSnapshot previous;
+};
+
+// WatchSet is a list of expressions evaluated together on every stop, e.g. the
+// contents of a watch window. Evaluate() returns only the entries whose value,
+// type or error has changed since the previous evaluation.
+class LLDB_EVAL_API WatchSet {
+ public:
+  virtual ~WatchSet() = default;
+
+  // Adds the expression to the set, returns the ID identifying its results.
+  virtual uint32_t Add(const char* expression) = 0;
+
+  virtual bool Remove(uint32_t id) = 0;
+
+  virtual uint32_t GetSize() const = 0;
+
+  // Evaluates all expressions in the given frame. The changes are ordered by
+  // the entry ID.
+  virtual std::vector<WatchChange> Evaluate(lldb::SBFrame frame) = 0;
+};
+
 LLDB_EVAL_API
-lldb::SBValue EvaluateExpression(lldb::SBFrame frame, const char* expression,
+std::unique_ptr<WatchSet> CreateWatchSet();
+
+// Result of EvaluateExpressionOverRange(), one scalar per index.
+struct RangeResult {
+  // Basic type of the elements: bool, int, unsigned int, long long, unsigned
+  // long long, float or double. Narrower integers are promoted to int, like in
+  // arithmetic.
+  lldb::BasicType type = lldb::eBasicTypeInvalid;
+  size_t element_size = 0;
+  // Elements in the host byte order.
+  std::vector<char> data;
+  // False if the expression couldn't be evaluated over columns and was
+  // evaluated for every index separately.
+  bool vectorized = false;
+
+  size_t size() const { return element_size ? data.size() / element_size : 0; }
+
+  // T must match the type, e.g. int32_t for lldb::eBasicTypeInt.
+  template <typename T>
+  T Get(size_t index) const {
+    T value;
+    memcpy(&value, data.data() + index * sizeof(T), sizeof(T));
+    return value;
+  }
+};
+
+// Evaluates the expression for every value of the index variable in the range
+// [begin, end), e.g. "arr[i].field * scale" with the index "i". The index is a
+// "long long" and shadows the variables with the same name. The result must be
+// a scalar.
+//
+// The expression is evaluated over columns of values: the parts which don't
+// depend on the index are evaluated once, the memory is read in bulk (e.g. a
+// field of every element of an array at once), and the arithmetic runs over
+// native arrays. Expressions which can't be evaluated this way fall back to
+// evaluating the expression once per index.
+LLDB_EVAL_API
+bool EvaluateExpressionOverRange(lldb::SBFrame frame, const char* expression,
+                                 const char* index_name, int64_t begin,
+                                 int64_t end, RangeResult& result,
                                  lldb::SBError& error);
 
+struct ChildPageOptions {
+  // Number of children per page.
+  uint32_t page_size = 256;
+  // Read the next page together with the requested one, so scrolling through
+  // the children takes one memory read per two pages.
+  bool prefetch_next_page = true;
+};
+
+struct ChildPage {
+  // Index of the first child of the page.
+  uint32_t first_index;
+  // Element type of arrays, invalid for other aggregates.
+  lldb::SBType element_type;
+  std::vector<lldb::SBValue> children;
+};
+
+// ChildPager enumerates the children of a (possibly huge) aggregate value in
+// pages. The elements of an array in memory are decoded from a single memory
+// read per page, instead of reading every element separately. The decoded
+// elements are snapshots, unlike the children returned by
+// lldb::SBValue::GetChildAtIndex().
+class LLDB_EVAL_API ChildPager {
+ public:
+  virtual ~ChildPager() = default;
+
+  virtual uint32_t GetNumChildren() const = 0;
+  virtual uint32_t GetNumPages() const = 0;
+
+  virtual ChildPage GetPage(uint32_t page_index, lldb::SBError& error) = 0;
+};
+
+LLDB_EVAL_API
+std::unique_ptr<ChildPager> CreateChildPager(
+    lldb::SBValue value, const ChildPageOptions& options = ChildPageOptions());
+
 }  // namespace lldb_eval
 
 #endif  // LLDB_EVAL_API_H_
@@ -67,6 +67,8 @@ void BooleanLiteralNode::Accept(Visitor* v) const { v->Visit(this); }
 
 void NumericLiteralNode::Accept(Visitor* v) const { v->Visit(this); }
 
+void StringLiteralNode::Accept(Visitor* v) const { v->Visit(this); }
+
 void IdentifierNode::Accept(Visitor* v) const { v->Visit(this); }
 
 void CStyleCastNode::Accept(Visitor* v) const { v->Visit(this); }
@@ -75,6 +77,12 @@ void MemberOfNode::Accept(Visitor* v) const { v->Visit(this); }
 
 void BinaryOpNode::Accept(Visitor* v) const { v->Visit(this); }
 
+void ArraySliceNode::Accept(Visitor* v) const { v->Visit(this); }
+
+void CallNode::Accept(Visitor* v) const { v->Visit(this); }
+
+void MethodCallNode::Accept(Visitor* v) const { v->Visit(this); }
+
 void UnaryOpNode::Accept(Visitor* v) const { v->Visit(this); }
 
 void TernaryOpNode::Accept(Visitor* v) const { v->Visit(this); }
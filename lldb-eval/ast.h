@@ -90,6 +90,19 @@ class NumericLiteralNode : public AstNode {
   Scalar value_;
 };
 
+// String literal, e.g. "foo". The value doesn't include the null terminator.
+class StringLiteralNode : public AstNode {
+ public:
+  explicit StringLiteralNode(const std::string& value) : value_(value) {}
+
+  void Accept(Visitor* v) const override;
+
+  std::string value() const { return value_; }
+
+ private:
+  std::string value_;
+};
+
 class IdentifierNode : public AstNode {
  public:
   explicit IdentifierNode(const std::string& name) : name_(name) {}
@@ -161,6 +174,71 @@ class BinaryOpNode : public AstNode {
   ExprResult rhs_;
 };
 
+// Slice of an array or a pointer -- base[begin:end]. The result is an array of
+// the elements in the half-open range [begin, end).
+class ArraySliceNode : public AstNode {
+ public:
+  ArraySliceNode(ExprResult base, ExprResult begin, ExprResult end)
+      : base_(std::move(base)),
+        begin_(std::move(begin)),
+        end_(std::move(end)) {}
+
+  void Accept(Visitor* v) const override;
+
+  AstNode* base() const { return base_.get(); }
+  AstNode* begin() const { return begin_.get(); }
+  AstNode* end() const { return end_.get(); }
+
+ private:
+  ExprResult base_;
+  ExprResult begin_;
+  ExprResult end_;
+};
+
+// Call of a builtin function -- name(args...), e.g. "sum(arr)". The functions
+// of the target are never called.
+class CallNode : public AstNode {
+ public:
+  CallNode(const std::string& name, std::vector<ExprResult> args)
+      : name_(name), args_(std::move(args)) {}
+
+  void Accept(Visitor* v) const override;
+
+  std::string name() const { return name_; }
+  size_t num_args() const { return args_.size(); }
+  AstNode* arg(size_t index) const { return args_[index].get(); }
+
+ private:
+  std::string name_;
+  std::vector<ExprResult> args_;
+};
+
+// Call of a member function, e.g. "v.size()". Only the member functions of
+// the known standard library classes are supported, see std_layout.h.
+class MethodCallNode : public AstNode {
+ public:
+  MethodCallNode(MemberOfNode::Type type, ExprResult object,
+                 const std::string& name, std::vector<ExprResult> args)
+      : type_(type),
+        object_(std::move(object)),
+        name_(name),
+        args_(std::move(args)) {}
+
+  void Accept(Visitor* v) const override;
+
+  MemberOfNode::Type type() const { return type_; }
+  AstNode* object() const { return object_.get(); }
+  std::string name() const { return name_; }
+  size_t num_args() const { return args_.size(); }
+  AstNode* arg(size_t index) const { return args_[index].get(); }
+
+ private:
+  MemberOfNode::Type type_;
+  ExprResult object_;
+  std::string name_;
+  std::vector<ExprResult> args_;
+};
+
 class UnaryOpNode : public AstNode {
  public:
   UnaryOpNode(clang::tok::TokenKind op, ExprResult rhs)
@@ -201,10 +279,14 @@ class Visitor {
   virtual void Visit(const ErrorNode* node) = 0;
   virtual void Visit(const BooleanLiteralNode* node) = 0;
   virtual void Visit(const NumericLiteralNode* node) = 0;
+  virtual void Visit(const StringLiteralNode* node) = 0;
   virtual void Visit(const IdentifierNode* node) = 0;
   virtual void Visit(const CStyleCastNode* node) = 0;
   virtual void Visit(const MemberOfNode* node) = 0;
   virtual void Visit(const BinaryOpNode* node) = 0;
+  virtual void Visit(const ArraySliceNode* node) = 0;
+  virtual void Visit(const CallNode* node) = 0;
+  virtual void Visit(const MethodCallNode* node) = 0;
   virtual void Visit(const UnaryOpNode* node) = 0;
   virtual void Visit(const TernaryOpNode* node) = 0;
 };
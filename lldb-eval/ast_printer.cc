@@ -0,0 +1,312 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/ast_printer.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "clang/Basic/TokenKinds.h"
+#include "lldb-eval/api.h"
+#include "lldb-eval/ast.h"
+#include "lldb-eval/scalar.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/xxhash.h"
+
+namespace {
+
+using lldb_eval::AstNode;
+
+// Operator precedence, higher binds tighter.
+enum Precedence {
+  kLowest = 0,
+  kConditional = 3,
+  kLogicalOr,
+  kLogicalAnd,
+  kBitwiseOr,
+  kBitwiseXor,
+  kBitwiseAnd,
+  kEquality,
+  kRelational,
+  kShift,
+  kArtificialArray,
+  kAdditive,
+  kMultiplicative,
+  kUnary = 15,
+  kPostfix,
+  kPrimary,
+};
+
+int GetBinaryPrecedence(clang::tok::TokenKind op) {
+  switch (op) {
+    case clang::tok::star:
+    case clang::tok::slash:
+    case clang::tok::percent:
+      return kMultiplicative;
+    case clang::tok::plus:
+    case clang::tok::minus:
+      return kAdditive;
+    case clang::tok::at:
+      return kArtificialArray;
+    case clang::tok::lessless:
+    case clang::tok::greatergreater:
+      return kShift;
+    case clang::tok::less:
+    case clang::tok::greater:
+    case clang::tok::lessequal:
+    case clang::tok::greaterequal:
+      return kRelational;
+    case clang::tok::equalequal:
+    case clang::tok::exclaimequal:
+      return kEquality;
+    case clang::tok::amp:
+      return kBitwiseAnd;
+    case clang::tok::caret:
+      return kBitwiseXor;
+    case clang::tok::pipe:
+      return kBitwiseOr;
+    case clang::tok::ampamp:
+      return kLogicalAnd;
+    case clang::tok::pipepipe:
+      return kLogicalOr;
+    default:
+      return kLowest;
+  }
+}
+
+std::string GetSpelling(clang::tok::TokenKind op) {
+  const char* spelling = clang::tok::getPunctuatorSpelling(op);
+  return spelling ? spelling : clang::tok::getTokenName(op);
+}
+
+// Prints the floating point value with the fewest digits which still parse
+// back to the same value.
+template <typename T>
+std::string PrintFloat(T value) {
+  char buffer[64];
+  for (int precision = 1; precision <= 17; ++precision) {
+    snprintf(buffer, sizeof(buffer), "%.*g", precision,
+             static_cast<double>(value));
+    if (static_cast<T>(strtod(buffer, nullptr)) == value) {
+      break;
+    }
+  }
+  std::string result = buffer;
+  // Make sure the literal isn't parsed as an integer.
+  if (result.find_first_of(".e") == std::string::npos) {
+    result += ".0";
+  }
+  return result;
+}
+
+std::string PrintNumericLiteral(const lldb_eval::Scalar& value) {
+  using Type = lldb_eval::Scalar::Type;
+
+  // The suffixes make the parser pick the same type again.
+  switch (value.type_) {
+    case Type::INT32:
+      return std::to_string(value.GetAs<int64_t>());
+    case Type::UINT32:
+      return std::to_string(value.GetAs<uint64_t>()) + "u";
+    case Type::INT64:
+      return std::to_string(value.GetAs<int64_t>()) + "ll";
+    case Type::UINT64:
+      return std::to_string(value.GetAs<uint64_t>()) + "ull";
+    case Type::FLOAT:
+      return PrintFloat(value.GetAs<float>()) + "f";
+    case Type::DOUBLE:
+      return PrintFloat(value.GetAs<double>());
+    case Type::INT128:
+    case Type::UINT128:
+    case Type::LONG_DOUBLE:
+      // The parser doesn't produce such literals.
+    case Type::INVALID:
+      break;
+  }
+  return "<invalid>";
+}
+
+std::string PrintStringLiteral(const std::string& value) {
+  std::string result = "\"";
+  for (char c : value) {
+    unsigned char byte = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if (c == '\n') {
+      result += "\\n";
+    } else if (byte < 0x20 || byte >= 0x7f) {
+      // Octal escapes have at most three digits, unlike the hex ones, which
+      // would swallow the following hex digits.
+      char escape[8];
+      snprintf(escape, sizeof(escape), "\\%03o", byte);
+      result += escape;
+    } else {
+      result += c;
+    }
+  }
+  return result + "\"";
+}
+
+class CanonicalPrinter : lldb_eval::Visitor {
+ public:
+  std::string Print(const AstNode* node, int min_precedence = kLowest) {
+    node->Accept(this);
+    if (precedence_ < min_precedence) {
+      return "(" + text_ + ")";
+    }
+    return std::move(text_);
+  }
+
+ private:
+  void SetText(std::string text, int precedence) {
+    text_ = std::move(text);
+    precedence_ = precedence;
+  }
+
+  void Visit(const lldb_eval::ErrorNode*) override {
+    SetText("<error>", kPrimary);
+  }
+
+  void Visit(const lldb_eval::BooleanLiteralNode* node) override {
+    SetText(node->value() ? "true" : "false", kPrimary);
+  }
+
+  void Visit(const lldb_eval::NumericLiteralNode* node) override {
+    SetText(PrintNumericLiteral(node->value()), kPrimary);
+  }
+
+  void Visit(const lldb_eval::StringLiteralNode* node) override {
+    SetText(PrintStringLiteral(node->value()), kPrimary);
+  }
+
+  void Visit(const lldb_eval::IdentifierNode* node) override {
+    SetText(node->name(), kPrimary);
+  }
+
+  void Visit(const lldb_eval::CStyleCastNode* node) override {
+    std::string rhs = Print(node->rhs(), kUnary);
+    SetText("(" + node->type_decl().GetName() + ")" + rhs, kUnary);
+  }
+
+  void Visit(const lldb_eval::MemberOfNode* node) override {
+    std::string lhs = Print(node->lhs(), kPostfix);
+    const char* op =
+        node->type() == lldb_eval::MemberOfNode::Type::OF_POINTER ? "->" : ".";
+    SetText(lhs + op + node->member_id()->name(), kPostfix);
+  }
+
+  void Visit(const lldb_eval::BinaryOpNode* node) override {
+    if (node->op() == clang::tok::l_square) {
+      std::string lhs = Print(node->lhs(), kPostfix);
+      std::string rhs = Print(node->rhs());
+      SetText(lhs + "[" + rhs + "]", kPostfix);
+      return;
+    }
+
+    // All binary operators are left-associative.
+    int precedence = GetBinaryPrecedence(node->op());
+    std::string lhs = Print(node->lhs(), precedence);
+    std::string rhs = Print(node->rhs(), precedence + 1);
+    SetText(lhs + " " + GetSpelling(node->op()) + " " + rhs, precedence);
+  }
+
+  void Visit(const lldb_eval::ArraySliceNode* node) override {
+    std::string base = Print(node->base(), kPostfix);
+    std::string begin = Print(node->begin());
+    std::string end = Print(node->end());
+    SetText(base + "[" + begin + ":" + end + "]", kPostfix);
+  }
+
+  void Visit(const lldb_eval::CallNode* node) override {
+    std::string text = node->name() + "(";
+    for (size_t i = 0; i < node->num_args(); ++i) {
+      if (i > 0) {
+        text += ", ";
+      }
+      text += Print(node->arg(i));
+    }
+    SetText(text + ")", kPrimary);
+  }
+
+  void Visit(const lldb_eval::MethodCallNode* node) override {
+    std::string object = Print(node->object(), kPostfix);
+    const char* op =
+        node->type() == lldb_eval::MemberOfNode::Type::OF_POINTER ? "->" : ".";
+    std::string text = object + op + node->name() + "(";
+    for (size_t i = 0; i < node->num_args(); ++i) {
+      if (i > 0) {
+        text += ", ";
+      }
+      text += Print(node->arg(i));
+    }
+    SetText(text + ")", kPostfix);
+  }
+
+  void Visit(const lldb_eval::UnaryOpNode* node) override {
+    std::string op = GetSpelling(node->op());
+    std::string rhs = Print(node->rhs(), kUnary);
+    // Keep e.g. "- -a" from turning into "--a".
+    if (!rhs.empty() && rhs[0] == op.back() &&
+        llvm::StringRef("+-&").contains(rhs[0])) {
+      op += " ";
+    }
+    SetText(op + rhs, kUnary);
+  }
+
+  void Visit(const lldb_eval::TernaryOpNode* node) override {
+    std::string cond = Print(node->cond(), kConditional + 1);
+    std::string lhs = Print(node->lhs());
+    std::string rhs = Print(node->rhs(), kConditional);
+    SetText(cond + " ? " + lhs + " : " + rhs, kConditional);
+  }
+
+ private:
+  std::string text_;
+  int precedence_ = kPrimary;
+};
+
+}  // namespace
+
+namespace lldb_eval {
+
+std::string PrintCanonical(const AstNode* tree) {
+  CanonicalPrinter printer;
+  return printer.Print(tree);
+}
+
+ExpressionKey GetExpressionKey(const AstNode* tree) {
+  return GetExpressionKey(PrintCanonical(tree));
+}
+
+ExpressionKey GetExpressionKey(std::string canonical) {
+  ExpressionKey key;
+  key.canonical = std::move(canonical);
+  key.hash_low = llvm::xxHash64(key.canonical);
+
+  // The high half hashes the canonical form salted with the low half, so the
+  // two halves are computed from different inputs.
+  std::string salted(sizeof(uint64_t), '\0');
+  llvm::support::endian::write64le(&salted[0], key.hash_low);
+  salted += key.canonical;
+  key.hash_high = llvm::xxHash64(salted);
+
+  return key;
+}
+
+}  // namespace lldb_eval
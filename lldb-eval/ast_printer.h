@@ -0,0 +1,44 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_AST_PRINTER_H_
+#define LLDB_EVAL_AST_PRINTER_H_
+
+#include <string>
+
+#include "lldb-eval/api.h"
+#include "lldb-eval/ast.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace lldb_eval {
+
+// Prints the AST in the canonical form: operators are separated by single
+// spaces, only the parentheses required by the operator precedence are
+// printed, type names are spelled as TypeDeclaration::GetName() and numeric
+// literals are printed in the shortest form giving the same value and type.
+// Expressions with the same AST have the same canonical form, e.g. "a+b",
+// "a + b" and "(a)+b" are all printed as "a + b".
+std::string PrintCanonical(const AstNode* tree);
+
+// Computes the canonical form and the structural hash of the AST. The hash is
+// computed from the canonical form and doesn't depend on the process, so it
+// can be persisted.
+ExpressionKey GetExpressionKey(const AstNode* tree);
+ExpressionKey GetExpressionKey(std::string canonical);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_AST_PRINTER_H_
@@ -0,0 +1,716 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/ast_serialization.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "clang/Basic/TokenKinds.h"
+#include "lldb-eval/ast.h"
+#include "lldb-eval/scalar.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace {
+
+using lldb_eval::AstNode;
+using lldb_eval::ExprResult;
+
+// The layout of an encoded AST (all integers are little-endian):
+//
+//   char magic[8]
+//   uint32_t version
+//   Node root
+//
+// Nodes are encoded in pre-order as a kind byte followed by the node fields
+// and the child nodes. Strings and counts are encoded as LEB128 varints,
+// strings are followed by their contents.
+const char kAstMagic[8] = {'L', 'L', 'E', 'V', 'A', 'L', 'A', 'S'};
+
+// The layout of a library:
+//
+//   char magic[8]
+//   uint32_t version
+//   uint32_t num_entries
+//   uint32_t offsets[num_entries + 1]  -- relative to the end of the table
+//   char entries[]                     -- encoded ASTs
+const char kLibraryMagic[8] = {'L', 'L', 'E', 'V', 'A', 'L', 'A', 'L'};
+
+const size_t kHeaderSize = sizeof(kAstMagic) + sizeof(uint32_t);
+
+// Deeper trees are rejected, so that malformed data can't exhaust the stack.
+const int kMaxDepth = 1000;
+
+enum class NodeKind : uint8_t {
+  kError = 0,
+  kBooleanLiteral,
+  kNumericLiteral,
+  kIdentifier,
+  kCStyleCast,
+  kMemberOf,
+  kBinaryOp,
+  kUnaryOp,
+  kTernaryOp,
+  kArraySlice,
+  kCall,
+  kStringLiteral,
+  kMethodCall,
+};
+
+// Stable numbering of the operators, the index in this table is encoded.
+// Only append to it, reordering the entries breaks the existing encodings.
+const clang::tok::TokenKind kOperators[] = {
+    clang::tok::plus,           clang::tok::minus,
+    clang::tok::star,           clang::tok::slash,
+    clang::tok::percent,        clang::tok::lessless,
+    clang::tok::greatergreater, clang::tok::less,
+    clang::tok::greater,        clang::tok::lessequal,
+    clang::tok::greaterequal,   clang::tok::equalequal,
+    clang::tok::exclaimequal,   clang::tok::amp,
+    clang::tok::caret,          clang::tok::pipe,
+    clang::tok::ampamp,         clang::tok::pipepipe,
+    clang::tok::l_square,       clang::tok::exclaim,
+    clang::tok::tilde,          clang::tok::plusplus,
+    clang::tok::minusminus,     clang::tok::at,
+};
+
+const uint8_t kNumOperators = sizeof(kOperators) / sizeof(kOperators[0]);
+
+uint8_t EncodeOperator(clang::tok::TokenKind op) {
+  for (uint8_t i = 0; i < kNumOperators; ++i) {
+    if (kOperators[i] == op) {
+      return i;
+    }
+  }
+  // Decodes as an invalid operator.
+  return kNumOperators;
+}
+
+// Only the bits of the active member are encoded, the rest of the union is
+// not initialized.
+uint64_t EncodeScalarBits(const lldb_eval::Scalar& value) {
+  using Type = lldb_eval::Scalar::Type;
+  switch (value.type_) {
+    case Type::FLOAT: {
+      uint32_t bits;
+      memcpy(&bits, &value.value_.float_, sizeof(bits));
+      return bits;
+    }
+    case Type::DOUBLE: {
+      uint64_t bits;
+      memcpy(&bits, &value.value_.double_, sizeof(bits));
+      return bits;
+    }
+    case Type::INVALID:
+      return 0;
+    default:
+      return value.GetAs<uint64_t>();
+  }
+}
+
+lldb_eval::Scalar DecodeScalar(lldb_eval::Scalar::Type type, uint64_t bits) {
+  using Type = lldb_eval::Scalar::Type;
+  lldb_eval::Scalar value;
+  switch (type) {
+    case Type::INT32:
+      value.SetValueInt32(static_cast<int32_t>(bits));
+      break;
+    case Type::UINT32:
+      value.SetValueUInt32(static_cast<uint32_t>(bits));
+      break;
+    case Type::INT64:
+      value.SetValueInt64(static_cast<int64_t>(bits));
+      break;
+    case Type::UINT64:
+      value.SetValueUInt64(bits);
+      break;
+    case Type::FLOAT: {
+      uint32_t float_bits = static_cast<uint32_t>(bits);
+      float f;
+      memcpy(&f, &float_bits, sizeof(f));
+      value.SetValueFloat(f);
+      break;
+    }
+    case Type::DOUBLE: {
+      double d;
+      memcpy(&d, &bits, sizeof(d));
+      value.SetValueDouble(d);
+      break;
+    }
+    case Type::INT128:
+    case Type::UINT128:
+    case Type::LONG_DOUBLE:
+      // Not produced by the parser, rejected by the reader.
+    case Type::INVALID:
+      break;
+  }
+  return value;
+}
+
+void AppendU32(std::string& data, uint32_t value) {
+  char buf[4];
+  llvm::support::endian::write32le(buf, value);
+  data.append(buf, sizeof(buf));
+}
+
+void AppendHeader(std::string& data, const char (&magic)[8]) {
+  data.append(magic, sizeof(magic));
+  AppendU32(data, lldb_eval::kAstFormatVersion);
+}
+
+bool CheckHeader(llvm::StringRef data, const char (&magic)[8],
+                 std::string* error) {
+  if (data.size() < kHeaderSize ||
+      memcmp(data.data(), magic, sizeof(magic)) != 0) {
+    *error = "not an encoded expression";
+    return false;
+  }
+  uint32_t version =
+      llvm::support::endian::read32le(data.data() + sizeof(magic));
+  if (version != lldb_eval::kAstFormatVersion) {
+    *error = "unsupported encoding version " + std::to_string(version);
+    return false;
+  }
+  return true;
+}
+
+class AstWriter : lldb_eval::Visitor {
+ public:
+  std::string Write(const AstNode* tree) {
+    data_.clear();
+    AppendHeader(data_, kAstMagic);
+    tree->Accept(this);
+    return std::move(data_);
+  }
+
+ private:
+  void AppendKind(NodeKind kind) { data_.push_back(static_cast<char>(kind)); }
+
+  void AppendVarint(uint64_t value) {
+    do {
+      uint8_t byte = value & 0x7f;
+      value >>= 7;
+      if (value) {
+        byte |= 0x80;
+      }
+      data_.push_back(static_cast<char>(byte));
+    } while (value);
+  }
+
+  void AppendString(const std::string& str) {
+    AppendVarint(str.size());
+    data_.append(str);
+  }
+
+  void Visit(const lldb_eval::ErrorNode*) override {
+    AppendKind(NodeKind::kError);
+  }
+
+  void Visit(const lldb_eval::BooleanLiteralNode* node) override {
+    AppendKind(NodeKind::kBooleanLiteral);
+    data_.push_back(node->value() ? 1 : 0);
+  }
+
+  void Visit(const lldb_eval::NumericLiteralNode* node) override {
+    AppendKind(NodeKind::kNumericLiteral);
+    lldb_eval::Scalar value = node->value();
+    data_.push_back(static_cast<char>(value.type_));
+    char buf[8];
+    llvm::support::endian::write64le(buf, EncodeScalarBits(value));
+    data_.append(buf, sizeof(buf));
+  }
+
+  void Visit(const lldb_eval::StringLiteralNode* node) override {
+    AppendKind(NodeKind::kStringLiteral);
+    AppendString(node->value());
+  }
+
+  void Visit(const lldb_eval::IdentifierNode* node) override {
+    AppendKind(NodeKind::kIdentifier);
+    AppendString(node->name());
+  }
+
+  void Visit(const lldb_eval::CStyleCastNode* node) override {
+    AppendKind(NodeKind::kCStyleCast);
+    lldb_eval::TypeDeclaration type_decl = node->type_decl();
+    data_.push_back(type_decl.is_builtin_ ? 1 : 0);
+    AppendVarint(type_decl.typenames_.size());
+    for (const auto& name : type_decl.typenames_) {
+      AppendString(name);
+    }
+    AppendVarint(type_decl.ptr_operators_.size());
+    for (auto op : type_decl.ptr_operators_) {
+      data_.push_back(static_cast<char>(EncodeOperator(op)));
+    }
+    node->rhs()->Accept(this);
+  }
+
+  void Visit(const lldb_eval::MemberOfNode* node) override {
+    AppendKind(NodeKind::kMemberOf);
+    data_.push_back(
+        node->type() == lldb_eval::MemberOfNode::Type::OF_POINTER ? 1 : 0);
+    AppendString(node->member_id()->name());
+    node->lhs()->Accept(this);
+  }
+
+  void Visit(const lldb_eval::BinaryOpNode* node) override {
+    AppendKind(NodeKind::kBinaryOp);
+    data_.push_back(static_cast<char>(EncodeOperator(node->op())));
+    node->lhs()->Accept(this);
+    node->rhs()->Accept(this);
+  }
+
+  void Visit(const lldb_eval::ArraySliceNode* node) override {
+    AppendKind(NodeKind::kArraySlice);
+    node->base()->Accept(this);
+    node->begin()->Accept(this);
+    node->end()->Accept(this);
+  }
+
+  void Visit(const lldb_eval::CallNode* node) override {
+    AppendKind(NodeKind::kCall);
+    AppendString(node->name());
+    AppendVarint(node->num_args());
+    for (size_t i = 0; i < node->num_args(); ++i) {
+      node->arg(i)->Accept(this);
+    }
+  }
+
+  void Visit(const lldb_eval::MethodCallNode* node) override {
+    AppendKind(NodeKind::kMethodCall);
+    data_.push_back(
+        node->type() == lldb_eval::MemberOfNode::Type::OF_POINTER ? 1 : 0);
+    AppendString(node->name());
+    node->object()->Accept(this);
+    AppendVarint(node->num_args());
+    for (size_t i = 0; i < node->num_args(); ++i) {
+      node->arg(i)->Accept(this);
+    }
+  }
+
+  void Visit(const lldb_eval::UnaryOpNode* node) override {
+    AppendKind(NodeKind::kUnaryOp);
+    data_.push_back(static_cast<char>(EncodeOperator(node->op())));
+    node->rhs()->Accept(this);
+  }
+
+  void Visit(const lldb_eval::TernaryOpNode* node) override {
+    AppendKind(NodeKind::kTernaryOp);
+    node->cond()->Accept(this);
+    node->lhs()->Accept(this);
+    node->rhs()->Accept(this);
+  }
+
+ private:
+  std::string data_;
+};
+
+class AstReader {
+ public:
+  explicit AstReader(llvm::StringRef data) : data_(data), pos_(0) {}
+
+  ExprResult Read(std::string* error) {
+    pos_ = kHeaderSize;
+    ExprResult tree = ReadNode(0);
+    if (tree && pos_ != data_.size()) {
+      Fail("unexpected data after the expression");
+    }
+    if (!error_.empty()) {
+      *error = error_;
+      return nullptr;
+    }
+    return tree;
+  }
+
+ private:
+  ExprResult Fail(const std::string& message) {
+    if (error_.empty()) {
+      error_ = message + " at offset " + std::to_string(pos_);
+    }
+    return nullptr;
+  }
+
+  bool ReadU8(uint8_t* value) {
+    if (pos_ >= data_.size()) {
+      Fail("unexpected end of data");
+      return false;
+    }
+    *value = static_cast<uint8_t>(data_[pos_++]);
+    return true;
+  }
+
+  bool ReadVarint(uint64_t* value) {
+    *value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if (!ReadU8(&byte)) {
+        return false;
+      }
+      *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    Fail("malformed varint");
+    return false;
+  }
+
+  bool ReadString(std::string* str) {
+    uint64_t size;
+    if (!ReadVarint(&size)) {
+      return false;
+    }
+    if (size > data_.size() - pos_) {
+      Fail("unexpected end of data");
+      return false;
+    }
+    *str = data_.substr(pos_, size).str();
+    pos_ += size;
+    return true;
+  }
+
+  bool ReadOperator(clang::tok::TokenKind* op) {
+    uint8_t index;
+    if (!ReadU8(&index)) {
+      return false;
+    }
+    if (index >= kNumOperators) {
+      Fail("invalid operator");
+      return false;
+    }
+    *op = kOperators[index];
+    return true;
+  }
+
+  ExprResult ReadNode(int depth) {
+    if (depth > kMaxDepth) {
+      return Fail("expression is nested too deeply");
+    }
+
+    uint8_t kind;
+    if (!ReadU8(&kind)) {
+      return nullptr;
+    }
+
+    switch (static_cast<NodeKind>(kind)) {
+      case NodeKind::kError:
+        return std::make_unique<lldb_eval::ErrorNode>();
+
+      case NodeKind::kBooleanLiteral: {
+        uint8_t value;
+        if (!ReadU8(&value)) {
+          return nullptr;
+        }
+        return std::make_unique<lldb_eval::BooleanLiteralNode>(value != 0);
+      }
+
+      case NodeKind::kNumericLiteral: {
+        uint8_t type;
+        if (!ReadU8(&type)) {
+          return nullptr;
+        }
+        if (type > static_cast<uint8_t>(lldb_eval::Scalar::Type::DOUBLE)) {
+          return Fail("invalid literal type");
+        }
+        if (data_.size() - pos_ < sizeof(uint64_t)) {
+          return Fail("unexpected end of data");
+        }
+        lldb_eval::Scalar value = DecodeScalar(
+            static_cast<lldb_eval::Scalar::Type>(type),
+            llvm::support::endian::read64le(data_.data() + pos_));
+        pos_ += sizeof(uint64_t);
+        return std::make_unique<lldb_eval::NumericLiteralNode>(value);
+      }
+
+      case NodeKind::kStringLiteral: {
+        std::string value;
+        if (!ReadString(&value)) {
+          return nullptr;
+        }
+        return std::make_unique<lldb_eval::StringLiteralNode>(value);
+      }
+
+      case NodeKind::kIdentifier: {
+        std::string name;
+        if (!ReadString(&name)) {
+          return nullptr;
+        }
+        return std::make_unique<lldb_eval::IdentifierNode>(name);
+      }
+
+      case NodeKind::kCStyleCast: {
+        lldb_eval::TypeDeclaration type_decl;
+        uint8_t is_builtin;
+        uint64_t num_typenames;
+        if (!ReadU8(&is_builtin) || !ReadVarint(&num_typenames)) {
+          return nullptr;
+        }
+        type_decl.is_builtin_ = is_builtin != 0;
+        for (uint64_t i = 0; i < num_typenames; ++i) {
+          std::string name;
+          if (!ReadString(&name)) {
+            return nullptr;
+          }
+          type_decl.typenames_.push_back(std::move(name));
+        }
+        uint64_t num_ptr_operators;
+        if (!ReadVarint(&num_ptr_operators)) {
+          return nullptr;
+        }
+        for (uint64_t i = 0; i < num_ptr_operators; ++i) {
+          clang::tok::TokenKind op;
+          if (!ReadOperator(&op)) {
+            return nullptr;
+          }
+          type_decl.ptr_operators_.push_back(op);
+        }
+        ExprResult rhs = ReadNode(depth + 1);
+        if (!rhs) {
+          return nullptr;
+        }
+        return std::make_unique<lldb_eval::CStyleCastNode>(type_decl,
+                                                           std::move(rhs));
+      }
+
+      case NodeKind::kMemberOf: {
+        uint8_t of_pointer;
+        std::string member;
+        if (!ReadU8(&of_pointer) || !ReadString(&member)) {
+          return nullptr;
+        }
+        ExprResult lhs = ReadNode(depth + 1);
+        if (!lhs) {
+          return nullptr;
+        }
+        auto type = of_pointer ? lldb_eval::MemberOfNode::Type::OF_POINTER
+                               : lldb_eval::MemberOfNode::Type::OF_OBJECT;
+        return std::make_unique<lldb_eval::MemberOfNode>(
+            type, std::move(lhs),
+            std::make_unique<lldb_eval::IdentifierNode>(member));
+      }
+
+      case NodeKind::kBinaryOp: {
+        clang::tok::TokenKind op;
+        if (!ReadOperator(&op)) {
+          return nullptr;
+        }
+        ExprResult lhs = ReadNode(depth + 1);
+        ExprResult rhs = lhs ? ReadNode(depth + 1) : nullptr;
+        if (!rhs) {
+          return nullptr;
+        }
+        return std::make_unique<lldb_eval::BinaryOpNode>(op, std::move(lhs),
+                                                         std::move(rhs));
+      }
+
+      case NodeKind::kUnaryOp: {
+        clang::tok::TokenKind op;
+        if (!ReadOperator(&op)) {
+          return nullptr;
+        }
+        ExprResult rhs = ReadNode(depth + 1);
+        if (!rhs) {
+          return nullptr;
+        }
+        return std::make_unique<lldb_eval::UnaryOpNode>(op, std::move(rhs));
+      }
+
+      case NodeKind::kTernaryOp: {
+        ExprResult cond = ReadNode(depth + 1);
+        ExprResult lhs = cond ? ReadNode(depth + 1) : nullptr;
+        ExprResult rhs = lhs ? ReadNode(depth + 1) : nullptr;
+        if (!rhs) {
+          return nullptr;
+        }
+        return std::make_unique<lldb_eval::TernaryOpNode>(
+            std::move(cond), std::move(lhs), std::move(rhs));
+      }
+
+      case NodeKind::kArraySlice: {
+        ExprResult base = ReadNode(depth + 1);
+        ExprResult begin = base ? ReadNode(depth + 1) : nullptr;
+        ExprResult end = begin ? ReadNode(depth + 1) : nullptr;
+        if (!end) {
+          return nullptr;
+        }
+        return std::make_unique<lldb_eval::ArraySliceNode>(
+            std::move(base), std::move(begin), std::move(end));
+      }
+
+      case NodeKind::kCall: {
+        std::string name;
+        uint64_t num_args;
+        if (!ReadString(&name) || !ReadVarint(&num_args)) {
+          return nullptr;
+        }
+        std::vector<ExprResult> args;
+        for (uint64_t i = 0; i < num_args; ++i) {
+          ExprResult arg = ReadNode(depth + 1);
+          if (!arg) {
+            return nullptr;
+          }
+          args.push_back(std::move(arg));
+        }
+        return std::make_unique<lldb_eval::CallNode>(name, std::move(args));
+      }
+
+      case NodeKind::kMethodCall: {
+        uint8_t of_pointer;
+        std::string name;
+        if (!ReadU8(&of_pointer) || !ReadString(&name)) {
+          return nullptr;
+        }
+        ExprResult object = ReadNode(depth + 1);
+        uint64_t num_args;
+        if (!object || !ReadVarint(&num_args)) {
+          return nullptr;
+        }
+        std::vector<ExprResult> args;
+        for (uint64_t i = 0; i < num_args; ++i) {
+          ExprResult arg = ReadNode(depth + 1);
+          if (!arg) {
+            return nullptr;
+          }
+          args.push_back(std::move(arg));
+        }
+        auto type = of_pointer ? lldb_eval::MemberOfNode::Type::OF_POINTER
+                               : lldb_eval::MemberOfNode::Type::OF_OBJECT;
+        return std::make_unique<lldb_eval::MethodCallNode>(
+            type, std::move(object), name, std::move(args));
+      }
+    }
+
+    --pos_;
+    return Fail("invalid node kind " + std::to_string(kind));
+  }
+
+ private:
+  llvm::StringRef data_;
+  size_t pos_;
+  std::string error_;
+};
+
+}  // namespace
+
+namespace lldb_eval {
+
+std::string SerializeAst(const AstNode* tree) {
+  AstWriter writer;
+  return writer.Write(tree);
+}
+
+ExprResult DeserializeAst(llvm::StringRef data, std::string* error) {
+  if (!CheckHeader(data, kAstMagic, error)) {
+    return nullptr;
+  }
+  AstReader reader(data);
+  return reader.Read(error);
+}
+
+std::string AstLibrary::Build(const std::vector<const AstNode*>& trees) {
+  std::string entries;
+  std::vector<uint32_t> offsets;
+  for (const AstNode* tree : trees) {
+    offsets.push_back(static_cast<uint32_t>(entries.size()));
+    entries.append(SerializeAst(tree));
+  }
+  offsets.push_back(static_cast<uint32_t>(entries.size()));
+
+  std::string data;
+  AppendHeader(data, kLibraryMagic);
+  AppendU32(data, static_cast<uint32_t>(trees.size()));
+  for (uint32_t offset : offsets) {
+    AppendU32(data, offset);
+  }
+  data.append(entries);
+  return data;
+}
+
+std::unique_ptr<AstLibrary> AstLibrary::Open(llvm::StringRef path,
+                                             std::string* error) {
+  // Large files are memory mapped.
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    *error = "can't open " + path.str() + ": " + buffer.getError().message();
+    return nullptr;
+  }
+  return Create(std::move(*buffer), error);
+}
+
+std::unique_ptr<AstLibrary> AstLibrary::Create(
+    std::unique_ptr<llvm::MemoryBuffer> buffer, std::string* error) {
+  llvm::StringRef data = buffer->getBuffer();
+  if (!CheckHeader(data, kLibraryMagic, error)) {
+    return nullptr;
+  }
+
+  // Validate the offsets table once, so that the entries can be accessed
+  // without checks.
+  uint64_t table_offset = kHeaderSize + sizeof(uint32_t);
+  if (data.size() < table_offset) {
+    *error = "truncated library";
+    return nullptr;
+  }
+  uint32_t size = llvm::support::endian::read32le(data.data() + kHeaderSize);
+  uint64_t entries_offset =
+      table_offset + (static_cast<uint64_t>(size) + 1) * sizeof(uint32_t);
+  if (data.size() < entries_offset) {
+    *error = "truncated library";
+    return nullptr;
+  }
+  uint64_t prev = 0;
+  for (uint64_t i = 0; i <= size; ++i) {
+    uint32_t offset = llvm::support::endian::read32le(
+        data.data() + table_offset + i * sizeof(uint32_t));
+    if (offset < prev || entries_offset + offset > data.size()) {
+      *error = "invalid library entry " + std::to_string(i);
+      return nullptr;
+    }
+    prev = offset;
+  }
+
+  return std::unique_ptr<AstLibrary>(new AstLibrary(std::move(buffer), size));
+}
+
+AstLibrary::AstLibrary(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                       uint32_t size)
+    : buffer_(std::move(buffer)), size_(size) {}
+
+llvm::StringRef AstLibrary::GetEncodedAst(uint32_t index) const {
+  if (index >= size_) {
+    return llvm::StringRef();
+  }
+  const char* table =
+      buffer_->getBufferStart() + kHeaderSize + sizeof(uint32_t);
+  const char* entries = table + (static_cast<uint64_t>(size_) + 1) * 4;
+  uint32_t begin = llvm::support::endian::read32le(table + index * 4);
+  uint32_t end = llvm::support::endian::read32le(table + (index + 1) * 4);
+  return llvm::StringRef(entries + begin, end - begin);
+}
+
+ExprResult AstLibrary::Load(uint32_t index, std::string* error) const {
+  if (index >= size_) {
+    *error = "no entry " + std::to_string(index);
+    return nullptr;
+  }
+  return DeserializeAst(GetEncodedAst(index), error);
+}
+
+}  // namespace lldb_eval
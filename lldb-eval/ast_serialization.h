@@ -0,0 +1,76 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_AST_SERIALIZATION_H_
+#define LLDB_EVAL_AST_SERIALIZATION_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lldb-eval/ast.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace lldb_eval {
+
+// Version of the binary AST encoding. Encoded ASTs of other versions are
+// rejected.
+const uint32_t kAstFormatVersion = 1;
+
+// Encodes the AST in a compact binary form: a header followed by the nodes in
+// pre-order. Operators are encoded with a stable numbering, independent of the
+// clang version. Type names are kept as text and are resolved when the
+// expression is evaluated, so the encoding doesn't depend on the target.
+std::string SerializeAst(const AstNode* tree);
+
+// Decodes the AST directly from the given memory, e.g. a memory mapped file.
+// Only the names are copied out of it. Returns nullptr and sets |error| if the
+// data is malformed or has a different version.
+ExprResult DeserializeAst(llvm::StringRef data, std::string* error);
+
+// AstLibrary is a collection of encoded ASTs stored in a single file. The file
+// is memory mapped and the ASTs are decoded on demand, so opening a large
+// library is cheap.
+class AstLibrary {
+ public:
+  // Encodes the ASTs into the library format.
+  static std::string Build(const std::vector<const AstNode*>& trees);
+
+  static std::unique_ptr<AstLibrary> Open(llvm::StringRef path,
+                                          std::string* error);
+  static std::unique_ptr<AstLibrary> Create(
+      std::unique_ptr<llvm::MemoryBuffer> buffer, std::string* error);
+
+  uint32_t size() const { return size_; }
+
+  // Returns the encoded AST, suitable for DeserializeAst().
+  llvm::StringRef GetEncodedAst(uint32_t index) const;
+
+  ExprResult Load(uint32_t index, std::string* error) const;
+
+ private:
+  AstLibrary(std::unique_ptr<llvm::MemoryBuffer> buffer, uint32_t size);
+
+ private:
+  std::unique_ptr<llvm::MemoryBuffer> buffer_;
+  uint32_t size_;
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_AST_SERIALIZATION_H_
@@ -0,0 +1,233 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/batch_planner.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "clang/Basic/TokenKinds.h"
+#include "lldb-eval/api.h"
+#include "lldb-eval/ast.h"
+#include "lldb-eval/ast_printer.h"
+#include "lldb-eval/builtins.h"
+#include "lldb-eval/eval.h"
+#include "lldb-eval/expression_context.h"
+#include "lldb-eval/parser.h"
+#include "lldb-eval/value.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBExecutionContext.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBValue.h"
+
+namespace {
+
+using lldb_eval::AstNode;
+
+// Collects the subexpressions of an AST which could be shared, i.e. the ones
+// without side effects, except the literals.
+class SubexpressionCollector : lldb_eval::Visitor {
+ public:
+  std::vector<const AstNode*> Collect(const AstNode* tree) {
+    nodes_.clear();
+    IsPure(tree);
+    return std::move(nodes_);
+  }
+
+ private:
+  bool IsPure(const AstNode* node) {
+    node->Accept(this);
+    return pure_;
+  }
+
+  void SetPure(const AstNode* node, bool pure) {
+    if (pure) {
+      nodes_.push_back(node);
+    }
+    pure_ = pure;
+  }
+
+  void Visit(const lldb_eval::ErrorNode*) override { pure_ = false; }
+
+  void Visit(const lldb_eval::BooleanLiteralNode*) override { pure_ = true; }
+
+  void Visit(const lldb_eval::NumericLiteralNode*) override { pure_ = true; }
+
+  void Visit(const lldb_eval::StringLiteralNode*) override { pure_ = true; }
+
+  void Visit(const lldb_eval::IdentifierNode* node) override {
+    SetPure(node, true);
+  }
+
+  void Visit(const lldb_eval::CStyleCastNode* node) override {
+    SetPure(node, IsPure(node->rhs()));
+  }
+
+  void Visit(const lldb_eval::MemberOfNode* node) override {
+    SetPure(node, IsPure(node->lhs()));
+  }
+
+  void Visit(const lldb_eval::BinaryOpNode* node) override {
+    bool lhs = IsPure(node->lhs());
+    bool rhs = IsPure(node->rhs());
+    SetPure(node, lhs && rhs);
+  }
+
+  void Visit(const lldb_eval::ArraySliceNode* node) override {
+    bool base = IsPure(node->base());
+    bool begin = IsPure(node->begin());
+    bool end = IsPure(node->end());
+    SetPure(node, base && begin && end);
+  }
+
+  void Visit(const lldb_eval::CallNode* node) override {
+    // The lambdas depend on the element they are evaluated for, they are not
+    // shared.
+    const lldb_eval::Builtin* builtin = lldb_eval::FindBuiltin(node->name());
+    bool pure = builtin != nullptr;
+    for (size_t i = 0; i < node->num_args(); ++i) {
+      if (!builtin || !builtin->IsLambda(i)) {
+        pure = IsPure(node->arg(i)) && pure;
+      }
+    }
+    SetPure(node, pure);
+  }
+
+  void Visit(const lldb_eval::MethodCallNode* node) override {
+    // The supported member functions don't modify the object.
+    bool pure = IsPure(node->object());
+    for (size_t i = 0; i < node->num_args(); ++i) {
+      pure = IsPure(node->arg(i)) && pure;
+    }
+    SetPure(node, pure);
+  }
+
+  void Visit(const lldb_eval::UnaryOpNode* node) override {
+    bool rhs = IsPure(node->rhs());
+    bool modifies = node->op() == clang::tok::plusplus ||
+                    node->op() == clang::tok::minusminus;
+    SetPure(node, rhs && !modifies);
+  }
+
+  void Visit(const lldb_eval::TernaryOpNode* node) override {
+    bool cond = IsPure(node->cond());
+    bool lhs = IsPure(node->lhs());
+    bool rhs = IsPure(node->rhs());
+    SetPure(node, cond && lhs && rhs);
+  }
+
+ private:
+  bool pure_ = true;
+  std::vector<const AstNode*> nodes_;
+};
+
+}  // namespace
+
+namespace lldb_eval {
+
+SharedSubexpressions::Slot* SharedSubexpressions::Find(const AstNode* node) {
+  auto it = slot_indexes_.find(node);
+  return it != slot_indexes_.end() ? &slots_[it->second] : nullptr;
+}
+
+BatchPlanner::BatchPlanner() : num_subexpressions_(0) {}
+
+void BatchPlanner::AddExpression(const AstNode* tree) {
+  SubexpressionCollector collector;
+  for (const AstNode* node : collector.Collect(tree)) {
+    nodes_by_key_[PrintCanonical(node)].push_back(node);
+    ++num_subexpressions_;
+  }
+}
+
+SharedSubexpressions BatchPlanner::Plan() const {
+  SharedSubexpressions shared;
+  for (const auto& it : nodes_by_key_) {
+    const std::vector<const AstNode*>& nodes = it.second;
+    if (nodes.size() < 2) {
+      continue;
+    }
+    size_t index = shared.slots_.size();
+    shared.slots_.push_back({false, Value(), EvalError()});
+    for (const AstNode* node : nodes) {
+      shared.slot_indexes_[node] = index;
+    }
+  }
+  return shared;
+}
+
+std::vector<EvaluationResult> EvaluateBatch(
+    lldb::SBFrame frame, const std::vector<std::string>& expressions) {
+  struct ParsedExpression {
+    std::unique_ptr<ExpressionContext> expr_ctx;
+    ExprResult ast;
+    std::string error;
+  };
+
+  std::vector<ParsedExpression> parsed(expressions.size());
+  BatchPlanner planner;
+
+  for (size_t i = 0; i < expressions.size(); ++i) {
+    ParsedExpression& expr = parsed[i];
+    expr.expr_ctx = std::make_unique<ExpressionContext>(
+        expressions[i], lldb::SBExecutionContext(frame));
+
+    Parser p(*expr.expr_ctx);
+    expr.ast = p.Run();
+    if (p.HasError()) {
+      expr.error = p.GetError();
+    } else {
+      planner.AddExpression(expr.ast.get());
+    }
+  }
+
+  SharedSubexpressions shared = planner.Plan();
+  std::vector<EvaluationResult> results(expressions.size());
+
+  for (size_t i = 0; i < expressions.size(); ++i) {
+    ParsedExpression& expr = parsed[i];
+    lldb::SBError& error = results[i].error;
+    error.Clear();
+
+    if (!expr.error.empty()) {
+      error.SetError(
+          static_cast<uint32_t>(EvalErrorCode::INVALID_EXPRESSION_SYNTAX),
+          lldb::eErrorTypeGeneric);
+      error.SetErrorString(expr.error.c_str());
+      continue;
+    }
+
+    Interpreter interpreter(*expr.expr_ctx);
+    interpreter.SetSharedSubexpressions(&shared);
+
+    EvalError err;
+    Value result = interpreter.Eval(expr.ast.get(), err);
+    if (err) {
+      error.SetError(static_cast<uint32_t>(err.code()),
+                     lldb::eErrorTypeGeneric);
+      error.SetErrorString(err.message().c_str());
+      continue;
+    }
+
+    results[i].value =
+        result.AsSbValue(expr.expr_ctx->GetExecutionContext().GetTarget());
+  }
+
+  return results;
+}
+
+}  // namespace lldb_eval
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_BATCH_PLANNER_H_
+#define LLDB_EVAL_BATCH_PLANNER_H_
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lldb-eval/api.h"
+#include "lldb-eval/ast.h"
+#include "lldb-eval/eval.h"
+#include "lldb-eval/value.h"
+#include "lldb/API/SBFrame.h"
+
+namespace lldb_eval {
+
+// Results of the subexpressions shared by the expressions of a batch. The
+// interpreter evaluates each of them once and reuses the result for all other
+// occurrences (see Interpreter::SetSharedSubexpressions()).
+class SharedSubexpressions {
+ public:
+  struct Slot {
+    bool evaluated;
+    Value value;
+    EvalError error;
+  };
+
+  // Returns the slot of the node, or nullptr if the node is not shared.
+  Slot* Find(const AstNode* node);
+
+  // Number of the distinct shared subexpressions.
+  size_t size() const { return slots_.size(); }
+
+ private:
+  friend class BatchPlanner;
+
+  std::unordered_map<const AstNode*, size_t> slot_indexes_;
+  std::vector<Slot> slots_;
+};
+
+// BatchPlanner finds the subexpressions occurring more than once in a batch of
+// expressions, e.g. "obj->a" in "obj->a->b" and "obj->a->c". Subexpressions
+// are compared by their canonical form (see PrintCanonical()), so the
+// whitespace and the parentheses don't matter. Only the subexpressions without
+// side effects are shared. Literals are cheap to evaluate and are never shared
+// on their own.
+//
+// All expressions of the batch must be evaluated in the same frame.
+class BatchPlanner {
+ public:
+  BatchPlanner();
+
+  // Adds the AST to the batch. The AST must outlive the plan.
+  void AddExpression(const AstNode* tree);
+
+  // Creates a slot for every subexpression occurring more than once.
+  SharedSubexpressions Plan() const;
+
+  // Number of the subexpressions which could be shared, in total and without
+  // the duplicates.
+  size_t num_subexpressions() const { return num_subexpressions_; }
+  size_t num_unique_subexpressions() const { return nodes_by_key_.size(); }
+
+ private:
+  size_t num_subexpressions_;
+  // Canonical form -> nodes with this form.
+  std::unordered_map<std::string, std::vector<const AstNode*>> nodes_by_key_;
+};
+
+// Evaluates the expressions in the given frame, the subexpressions shared by
+// several expressions are evaluated once.
+std::vector<EvaluationResult> EvaluateBatch(
+    lldb::SBFrame frame, const std::vector<std::string>& expressions);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_BATCH_PLANNER_H_
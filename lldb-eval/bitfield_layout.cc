@@ -0,0 +1,217 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/bitfield_layout.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lldb-eval/enum_table.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace {
+
+using lldb_eval::BitfieldLayout;
+
+// Anonymous structs and unions nested deeper are not searched.
+const int kMaxNestingDepth = 8;
+
+enum class MemberKind {
+  kNotFound,
+  kRegular,
+  kBitfield,
+};
+
+// Looks for the member the same way as C++ name lookup: the members of the
+// anonymous structs and unions are members of the enclosing type, the base
+// classes are searched after the type itself. "base_bits" is the offset of the
+// type within the object.
+MemberKind FindMember(lldb::SBType type, llvm::StringRef name,
+                      uint64_t base_bits, BitfieldLayout* layout,
+                      int depth = 0) {
+  if (depth > kMaxNestingDepth) {
+    return MemberKind::kNotFound;
+  }
+  type = type.GetCanonicalType();
+
+  uint32_t num_fields = type.GetNumberOfFields();
+  for (uint32_t i = 0; i < num_fields; ++i) {
+    lldb::SBTypeMember field = type.GetFieldAtIndex(i);
+    const char* field_name = field.GetName();
+    if (!field_name || name != field_name) {
+      continue;
+    }
+    if (!field.IsBitfield()) {
+      return MemberKind::kRegular;
+    }
+    layout->bit_offset = base_bits + field.GetOffsetInBits();
+    layout->bit_size = field.GetBitfieldSizeInBits();
+    layout->type = field.GetType();
+    // LLDB doesn't report the signedness of the enumerations, it's inferred
+    // from the enumerators.
+    lldb::SBType field_type = layout->type.GetCanonicalType();
+    std::shared_ptr<const lldb_eval::EnumTable> table =
+        lldb_eval::EnumTable::Get(field_type);
+    layout->is_signed = table ? table->has_negative_values()
+                              : (field_type.GetTypeFlags() &
+                                 lldb::eTypeIsSigned) != 0;
+    return MemberKind::kBitfield;
+  }
+
+  for (uint32_t i = 0; i < num_fields; ++i) {
+    lldb::SBTypeMember field = type.GetFieldAtIndex(i);
+    const char* field_name = field.GetName();
+    if (field_name && field_name[0] != '\0') {
+      continue;
+    }
+    MemberKind kind =
+        FindMember(field.GetType(), name,
+                   base_bits + field.GetOffsetInBits(), layout, depth + 1);
+    if (kind != MemberKind::kNotFound) {
+      return kind;
+    }
+  }
+
+  uint32_t num_bases = type.GetNumberOfDirectBaseClasses();
+  for (uint32_t i = 0; i < num_bases; ++i) {
+    lldb::SBTypeMember base = type.GetDirectBaseClassAtIndex(i);
+    MemberKind kind =
+        FindMember(base.GetType(), name, base_bits + base.GetOffsetInBits(),
+                   layout, depth + 1);
+    if (kind != MemberKind::kNotFound) {
+      return kind;
+    }
+  }
+  return MemberKind::kNotFound;
+}
+
+// The layouts are cached by the types and the names of the members, the
+// regular members are cached too (as not being bit fields). SBType doesn't
+// expose its module in LLDB 10, so the types with the same name (e.g. the local
+// classes of different functions) are told apart by comparing them.
+class BitfieldRegistry {
+ public:
+  bool Get(lldb::SBType type, const std::string& name,
+           BitfieldLayout* layout) {
+    std::string key = std::string(type.GetName()) + "::" + name;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (const Entry* entry = Find(key, type)) {
+        *layout = entry->layout;
+        return entry->is_bitfield;
+      }
+    }
+    Entry entry;
+    entry.type = type;
+    entry.is_bitfield =
+        FindMember(type, name, 0, &entry.layout) == MemberKind::kBitfield;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!Find(key, type)) {
+      layouts_[key].push_back(entry);
+    }
+    *layout = entry.layout;
+    return entry.is_bitfield;
+  }
+
+ private:
+  struct Entry {
+    lldb::SBType type;
+    bool is_bitfield = false;
+    BitfieldLayout layout;
+  };
+
+  // Must be called with the lock held.
+  const Entry* Find(const std::string& key, lldb::SBType type) {
+    auto it = layouts_.find(key);
+    if (it == layouts_.end()) {
+      return nullptr;
+    }
+    for (Entry& entry : it->second) {
+      if (entry.type == type) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  std::mutex mutex_;
+  // Type and member name -> the types with that name and their members.
+  std::unordered_map<std::string, std::vector<Entry>> layouts_;
+};
+
+BitfieldRegistry& GetBitfieldRegistry() {
+  static BitfieldRegistry* registry = new BitfieldRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+bool GetBitfieldLayout(lldb::SBType type, const std::string& name,
+                       BitfieldLayout* layout) {
+  return GetBitfieldRegistry().Get(type.GetCanonicalType(), name, layout);
+}
+
+bool ExtractBitfield(const BitfieldLayout& layout, const std::string& bytes,
+                     lldb::ByteOrder byte_order, uint64_t* value) {
+  uint64_t size = layout.byte_size();
+  uint64_t shift = layout.bit_offset % 8;
+  if (layout.bit_size == 0 || layout.bit_size > 64 || bytes.size() < size) {
+    return false;
+  }
+  auto byte = [&bytes](uint64_t i) {
+    return static_cast<uint64_t>(static_cast<uint8_t>(bytes[i]));
+  };
+
+  uint64_t bits = 0;
+  if (byte_order == lldb::eByteOrderBig) {
+    // The bits are numbered from the most significant bit of the first byte.
+    if (size > 8) {
+      return false;
+    }
+    for (uint64_t i = 0; i < size; ++i) {
+      bits = (bits << 8) | byte(i);
+    }
+    bits >>= size * 8 - shift - layout.bit_size;
+  } else {
+    // The bits are numbered from the least significant bit of the first byte.
+    // An unaligned 64-bit field spans 9 bytes.
+    for (uint64_t i = std::min<uint64_t>(size, 8); i-- > 0;) {
+      bits = (bits << 8) | byte(i);
+    }
+    bits >>= shift;
+    if (size > 8) {
+      bits |= byte(8) << (64 - shift);
+    }
+  }
+
+  if (layout.bit_size < 64) {
+    uint64_t mask = (uint64_t{1} << layout.bit_size) - 1;
+    bits &= mask;
+    if (layout.is_signed && (bits >> (layout.bit_size - 1)) & 1) {
+      bits |= ~mask;
+    }
+  }
+  *value = bits;
+  return true;
+}
+
+}  // namespace lldb_eval
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_BITFIELD_LAYOUT_H_
+#define LLDB_EVAL_BITFIELD_LAYOUT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "lldb/API/SBType.h"
+#include "lldb/lldb-enumerations.h"
+
+namespace lldb_eval {
+
+// Position of a bit field member within the object.
+struct BitfieldLayout {
+  // Offset of the first bit from the start of the object, in bits.
+  uint64_t bit_offset = 0;
+  uint32_t bit_size = 0;
+  // Declared type of the member, e.g. "unsigned int" or an enum.
+  lldb::SBType type;
+  bool is_signed = false;
+
+  // The bytes of the object containing the bits.
+  uint64_t first_byte() const { return bit_offset / 8; }
+  uint64_t byte_size() const { return (bit_offset % 8 + bit_size + 7) / 8; }
+};
+
+// Looks up the member with the given name in the record type, including the
+// members of the anonymous structs and unions and of the base classes. Returns
+// false if there is no such member or the member isn't a bit field. The
+// layouts are cached per type and member.
+bool GetBitfieldLayout(lldb::SBType type, const std::string& name,
+                       BitfieldLayout* layout);
+
+// Extracts the bit field from the bytes of the object starting at
+// layout.first_byte() (layout.byte_size() of them): shifts and masks the bits
+// and sign-extends the signed fields. Returns false if the layout isn't
+// supported (the fields larger than 64 bits).
+bool ExtractBitfield(const BitfieldLayout& layout, const std::string& bytes,
+                     lldb::ByteOrder byte_order, uint64_t* value);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_BITFIELD_LAYOUT_H_
@@ -0,0 +1,1113 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/builtins.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+#include "lldb-eval/api.h"
+#include "lldb-eval/ast.h"
+#include "lldb-eval/eval.h"
+#include "lldb-eval/memory_reader.h"
+#include "lldb-eval/pointer.h"
+#include "lldb-eval/range_evaluator.h"
+#include "lldb-eval/scalar.h"
+#include "lldb-eval/scalar_dispatch.h"
+#include "lldb-eval/value.h"
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/API/SBTarget.h"
+#include "lldb/API/SBType.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-enumerations.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FormatVariadic.h"
+
+namespace {
+
+using lldb_eval::BuiltinCall;
+using lldb_eval::DispatchType;
+using lldb_eval::EvalError;
+using lldb_eval::EvalErrorCode;
+using lldb_eval::GetScalarType;
+using lldb_eval::RangeResult;
+using lldb_eval::Scalar;
+using lldb_eval::Value;
+
+// Longer strings are not read.
+const size_t kMaxStringLength = 1024 * 1024;
+
+// Larger memory blocks are not read.
+const uint64_t kMaxBlockSize = 64 * 1024 * 1024;
+
+// Scalar type of the elements of the result. The bools are promoted to int,
+// same as in C++.
+Scalar::Type GetElementScalarType(const RangeResult& result) {
+  return result.type == lldb::eBasicTypeBool
+             ? Scalar::Type::INT32
+             : GetScalarType(result.type, result.element_size);
+}
+
+// Calls f(values), where values is a vector of the native scalars of the
+// result. The bools are decoded as ints.
+template <typename F>
+void DispatchValues(const RangeResult& result, F f) {
+  DispatchType(GetElementScalarType(result), [&](auto tag) {
+    using T = decltype(tag);
+    std::vector<T> values(result.size());
+    if (result.type == lldb::eBasicTypeBool) {
+      for (size_t k = 0; k < values.size(); ++k) {
+        values[k] = static_cast<T>(result.data[k] != 0);
+      }
+    } else if (!values.empty()) {
+      memcpy(values.data(), result.data.data(), values.size() * sizeof(T));
+    }
+    f(values);
+  });
+}
+
+template <typename T>
+T SumValues(const std::vector<T>& values) {
+  if constexpr (std::is_integral<T>::value) {
+    // The sum wraps around, same as the Scalar arithmetic.
+    using U = typename std::make_unsigned<T>::type;
+    U sum = 0;
+    for (T value : values) {
+      sum += static_cast<U>(value);
+    }
+    return static_cast<T>(sum);
+  } else {
+    T sum = 0;
+    for (T value : values) {
+      sum += value;
+    }
+    return sum;
+  }
+}
+
+template <typename T>
+int64_t CountNonZero(const std::vector<T>& values) {
+  int64_t count = 0;
+  for (T value : values) {
+    count += value != T(0) ? 1 : 0;
+  }
+  return count;
+}
+
+template <typename T, typename Predicate>
+int64_t FindFirst(const std::vector<T>& values, Predicate predicate) {
+  for (size_t k = 0; k < values.size(); ++k) {
+    if (predicate(values[k])) {
+      return static_cast<int64_t>(k);
+    }
+  }
+  return -1;
+}
+
+// Element type of the array, keeping the typedefs (e.g. "uint8_t").
+lldb::SBType GetElementType(lldb::SBValue array) {
+  lldb::SBType type = array.GetType();
+  if (!type.IsArrayType()) {
+    type = type.GetCanonicalType();
+  }
+  return type.GetArrayElementType();
+}
+
+bool GetArray(BuiltinCall& call, const char* name, lldb::SBValue* array,
+              EvalError& error) {
+  lldb::SBValue value = call.args[0].AsSbValue(call.target);
+  if (value.GetType().IsReferenceType()) {
+    value = value.Dereference();
+  }
+  if (!value.GetType().GetCanonicalType().IsArrayType()) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'{0}' expects an array, got '{1}'", name,
+                            value.GetTypeName()));
+    return false;
+  }
+  *array = value;
+  return true;
+}
+
+// Evaluates the lambda argument at the given index for every element, or
+// reads the elements themselves if the lambda is omitted. The optional
+// "contents" are the contents of the array, if they are already read.
+bool EvaluateElements(BuiltinCall& call, lldb::SBValue array,
+                      size_t lambda_index, const std::string* contents,
+                      RangeResult* result, EvalError& error) {
+  lldb_eval::IdentifierNode element(lldb_eval::kElementName);
+  const lldb_eval::AstNode* tree = &element;
+  if (lambda_index < call.lambdas.size() && call.lambdas[lambda_index]) {
+    tree = call.lambdas[lambda_index];
+  }
+  return EvaluateOverElements(*call.expr_ctx, tree, lldb_eval::kElementName,
+                              array, contents, call.bound_variables,
+                              call.read_set, result, error);
+}
+
+// sum(arr), min(arr), max(arr) and the variants with a projection.
+template <typename Reduce>
+Value ReduceElements(BuiltinCall& call, const char* name, Reduce reduce,
+                     EvalError& error) {
+  lldb::SBValue array;
+  RangeResult elements;
+  if (!GetArray(call, name, &array, error) ||
+      !EvaluateElements(call, array, 1, nullptr, &elements, error)) {
+    return Value();
+  }
+
+  Value result;
+  DispatchValues(elements, [&](const auto& values) {
+    result = reduce(values, error);
+  });
+  if (!result && !error) {
+    // Empty arrays have no element type.
+    result = reduce(std::vector<int32_t>(), error);
+  }
+  return result;
+}
+
+Value Sum(BuiltinCall& call, EvalError& error) {
+  return ReduceElements(
+      call, "sum",
+      [](const auto& values, EvalError&) {
+        return Value(Scalar(SumValues(values)));
+      },
+      error);
+}
+
+Value Min(BuiltinCall& call, EvalError& error) {
+  return ReduceElements(
+      call, "min",
+      [](const auto& values, EvalError& error) {
+        if (values.empty()) {
+          error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                    "'min' of an empty array");
+          return Value();
+        }
+        return Value(Scalar(*std::min_element(values.begin(), values.end())));
+      },
+      error);
+}
+
+Value Max(BuiltinCall& call, EvalError& error) {
+  return ReduceElements(
+      call, "max",
+      [](const auto& values, EvalError& error) {
+        if (values.empty()) {
+          error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                    "'max' of an empty array");
+          return Value();
+        }
+        return Value(Scalar(*std::max_element(values.begin(), values.end())));
+      },
+      error);
+}
+
+// Number of the elements satisfying the predicate (or non-zero), -1 on error.
+int64_t CountElements(BuiltinCall& call, const char* name, int64_t* size,
+                      EvalError& error) {
+  lldb::SBValue array;
+  RangeResult elements;
+  if (!GetArray(call, name, &array, error) ||
+      !EvaluateElements(call, array, 1, nullptr, &elements, error)) {
+    return -1;
+  }
+
+  int64_t count = 0;
+  DispatchValues(elements,
+                 [&](const auto& values) { count = CountNonZero(values); });
+  *size = static_cast<int64_t>(elements.size());
+  return count;
+}
+
+Value Count(BuiltinCall& call, EvalError& error) {
+  int64_t size;
+  int64_t count = CountElements(call, "count", &size, error);
+  return count < 0 ? Value() : Value(Scalar(count));
+}
+
+Value Any(BuiltinCall& call, EvalError& error) {
+  int64_t size;
+  int64_t count = CountElements(call, "any", &size, error);
+  return count < 0 ? Value() : Value(count > 0);
+}
+
+Value All(BuiltinCall& call, EvalError& error) {
+  int64_t size;
+  int64_t count = CountElements(call, "all", &size, error);
+  return count < 0 ? Value() : Value(count == size);
+}
+
+Value Find(BuiltinCall& call, EvalError& error) {
+  lldb::SBValue array;
+  RangeResult elements;
+  if (!GetArray(call, "find", &array, error) ||
+      !EvaluateElements(call, array, 1, nullptr, &elements, error)) {
+    return Value();
+  }
+
+  Value& needle = call.args[1];
+  Scalar scalar = needle.IsScalar() ? needle.AsScalar() : Scalar();
+  // The elements are never wider than 64 bits, see GetScalarType().
+  if (scalar.type_ == Scalar::Type::INVALID ||
+      scalar.type_ == Scalar::Type::INT128 ||
+      scalar.type_ == Scalar::Type::UINT128 ||
+      scalar.type_ == Scalar::Type::LONG_DOUBLE) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("can't search for a value of type '{0}'",
+                            needle.AsSbValue(call.target).GetTypeName()));
+    return Value();
+  }
+
+  // The elements and the value are compared in their common type.
+  int64_t index = -1;
+  Scalar::Type common =
+      std::max(GetElementScalarType(elements), scalar.type_);
+  DispatchValues(elements, [&](const auto& values) {
+    DispatchType(common, [&](auto tag) {
+      using C = decltype(tag);
+      C target = scalar.GetAs<C>();
+      index = FindFirst(values,
+                        [&](auto value) { return C(value) == target; });
+    });
+  });
+  return Value(Scalar(index));
+}
+
+Value FindIf(BuiltinCall& call, EvalError& error) {
+  lldb::SBValue array;
+  RangeResult elements;
+  if (!GetArray(call, "find_if", &array, error) ||
+      !EvaluateElements(call, array, 1, nullptr, &elements, error)) {
+    return Value();
+  }
+
+  int64_t index = -1;
+  DispatchValues(elements, [&](const auto& values) {
+    index = FindFirst(values, [](auto value) { return value != 0; });
+  });
+  return Value(Scalar(index));
+}
+
+Value Filter(BuiltinCall& call, EvalError& error) {
+  lldb::SBValue array;
+  if (!GetArray(call, "filter", &array, error)) {
+    return Value();
+  }
+
+  // The array is read once, both for the predicate and for the copies of the
+  // matching elements.
+  lldb::SBData data = array.GetData();
+  lldb::SBError read_error;
+  std::string contents(data.GetByteSize(), '\0');
+  if (!contents.empty()) {
+    data.ReadRawData(read_error, 0, &contents[0], contents.size());
+  }
+  if (read_error.Fail()) {
+    error.Set(EvalErrorCode::UNKNOWN, read_error.GetCString());
+    return Value();
+  }
+
+  RangeResult matches;
+  if (!EvaluateElements(call, array, 1, &contents, &matches, error)) {
+    return Value();
+  }
+
+  std::vector<size_t> indexes;
+  DispatchValues(matches, [&](const auto& values) {
+    for (size_t k = 0; k < values.size(); ++k) {
+      if (values[k] != 0) {
+        indexes.push_back(k);
+      }
+    }
+  });
+
+  // Copy the matching elements into a new array.
+  lldb::SBType element_type = GetElementType(array);
+  size_t element_size = static_cast<size_t>(element_type.GetByteSize());
+  std::string result_contents(indexes.size() * element_size, '\0');
+  for (size_t i = 0; i < indexes.size(); ++i) {
+    memcpy(&result_contents[i * element_size],
+           contents.data() + indexes[i] * element_size, element_size);
+  }
+
+  // lldb::SBData::SetData() copies the contents and doesn't use "error".
+  lldb::SBData result_data;
+  result_data.SetData(read_error, result_contents.data(),
+                      result_contents.size(), call.target.GetByteOrder(),
+                      static_cast<uint8_t>(call.target.GetAddressByteSize()));
+  return Value(call.target.CreateValueFromData(
+                   "result", result_data,
+                   element_type.GetArrayType(indexes.size())),
+               /* is_rvalue */ true);
+}
+
+bool IsCharType(lldb::SBType type) {
+  lldb::BasicType basic_type = type.GetCanonicalType().GetBasicType();
+  return basic_type == lldb::eBasicTypeChar ||
+         basic_type == lldb::eBasicTypeSignedChar ||
+         basic_type == lldb::eBasicTypeUnsignedChar;
+}
+
+lldb::SBValue GetArg(BuiltinCall& call, size_t index) {
+  lldb::SBValue value = call.args[index].AsSbValue(call.target);
+  if (value.GetType().IsReferenceType()) {
+    value = value.Dereference();
+  }
+  return value;
+}
+
+bool IsArrayArg(BuiltinCall& call, size_t index) {
+  return GetArg(call, index).GetType().GetCanonicalType().IsArrayType();
+}
+
+// Reads the string argument -- a pointer to chars or an array of chars (e.g. a
+// literal). At most "max_length" bytes are read, the end of an array ends the
+// string too.
+bool ReadStringArg(BuiltinCall& call, const char* name, size_t index,
+                   size_t max_length, std::string* str, bool* terminated,
+                   EvalError& error) {
+  lldb::SBValue value = GetArg(call, index);
+  lldb::SBType type = value.GetType().GetCanonicalType();
+
+  lldb::addr_t address;
+  if (type.IsArrayType() && IsCharType(type.GetArrayElementType())) {
+    size_t size = static_cast<size_t>(type.GetByteSize());
+    address = value.GetLoadAddress();
+    if (address == LLDB_INVALID_ADDRESS) {
+      // E.g. a string literal, the contents are in the host memory.
+      lldb::SBData data = value.GetData();
+      lldb::SBError read_error;
+      str->assign(std::min(size, max_length), '\0');
+      if (!str->empty()) {
+        data.ReadRawData(read_error, 0, &(*str)[0], str->size());
+      }
+      const char* end =
+          static_cast<const char*>(memchr(str->data(), 0, str->size()));
+      size_t length =
+          end ? static_cast<size_t>(end - str->data()) : str->size();
+      *terminated = length < str->size() || str->size() == size;
+      str->resize(length);
+      return true;
+    }
+    max_length = std::min(max_length, size);
+    if (!lldb_eval::MemoryReader(call.target.GetProcess(), call.read_set)
+             .ReadCString(address, max_length, str, terminated)) {
+      error.Set(EvalErrorCode::UNKNOWN,
+                llvm::formatv("can't read memory at 0x{0:x}", address));
+      return false;
+    }
+    *terminated = *terminated || str->size() == size;
+    return true;
+  }
+
+  if (!type.IsPointerType() || !IsCharType(type.GetPointeeType())) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'{0}' expects a string, got '{1}'", name,
+                            value.GetTypeName()));
+    return false;
+  }
+  address = static_cast<lldb::addr_t>(value.GetValueAsUnsigned());
+  if (address == 0) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'{0}' argument is a null pointer", name));
+    return false;
+  }
+  if (!lldb_eval::MemoryReader(call.target.GetProcess(), call.read_set)
+           .ReadCString(address, max_length, str, terminated)) {
+    error.Set(EvalErrorCode::UNKNOWN,
+              llvm::formatv("can't read memory at 0x{0:x}", address));
+    return false;
+  }
+  return true;
+}
+
+// Reads the whole string, up to kMaxStringLength.
+bool ReadFullStringArg(BuiltinCall& call, const char* name, size_t index,
+                       std::string* str, EvalError& error) {
+  bool terminated;
+  if (!ReadStringArg(call, name, index, kMaxStringLength, str, &terminated,
+                     error)) {
+    return false;
+  }
+  if (!terminated) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'{0}' argument is longer than {1} bytes", name,
+                            kMaxStringLength));
+    return false;
+  }
+  return true;
+}
+
+// Reads the non-negative integer argument, "what" names it in the errors.
+bool GetNonNegativeArg(BuiltinCall& call, const char* name, size_t index,
+                       const char* what, uint64_t* result, EvalError& error) {
+  Value& value = call.args[index];
+  Scalar scalar = value.IsScalar() ? value.AsScalar() : Scalar();
+  if (scalar.type_ == Scalar::Type::INVALID ||
+      scalar.type_ == Scalar::Type::FLOAT ||
+      scalar.type_ == Scalar::Type::DOUBLE ||
+      scalar.type_ == Scalar::Type::LONG_DOUBLE || scalar < Scalar(0)) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'{0}' expects a non-negative {1}", name, what));
+    return false;
+  }
+  *result = scalar.GetAs<uint64_t>();
+  return true;
+}
+
+bool GetLengthArg(BuiltinCall& call, const char* name, size_t index,
+                  uint64_t* length, EvalError& error) {
+  return GetNonNegativeArg(call, name, index, "length", length, error);
+}
+
+Value StrLen(BuiltinCall& call, EvalError& error) {
+  std::string str;
+  if (!ReadFullStringArg(call, "strlen", 0, &str, error)) {
+    return Value();
+  }
+  return Value(Scalar(static_cast<uint64_t>(str.size())));
+}
+
+Value StrEq(BuiltinCall& call, EvalError& error) {
+  // Only the length of the other string plus one bytes of a string can be
+  // equal to it. The arrays (e.g. the literals) are cheaper to read first.
+  size_t first = IsArrayArg(call, 1) && !IsArrayArg(call, 0) ? 1 : 0;
+  std::string known, other;
+  bool terminated;
+  if (!ReadFullStringArg(call, "streq", first, &known, error) ||
+      !ReadStringArg(call, "streq", 1 - first, known.size() + 1, &other,
+                     &terminated, error)) {
+    return Value();
+  }
+  return Value(other == known);
+}
+
+Value StrNEq(BuiltinCall& call, EvalError& error) {
+  uint64_t length;
+  if (!GetLengthArg(call, "strneq", 2, &length, error)) {
+    return Value();
+  }
+  // Reported instead of comparing a shorter prefix, same as in memeq().
+  if (length > kMaxStringLength) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'strneq' length {0} is larger than the limit of "
+                            "{1} bytes",
+                            length, kMaxStringLength));
+    return Value();
+  }
+  size_t max_length = static_cast<size_t>(length);
+
+  // Same as strncmp() == 0.
+  std::string lhs, rhs;
+  bool terminated;
+  if (!ReadStringArg(call, "strneq", 0, max_length, &lhs, &terminated,
+                     error) ||
+      !ReadStringArg(call, "strneq", 1, max_length, &rhs, &terminated,
+                     error)) {
+    return Value();
+  }
+  return Value(lhs == rhs);
+}
+
+Value StartsWith(BuiltinCall& call, EvalError& error) {
+  std::string prefix, str;
+  bool terminated;
+  if (!ReadFullStringArg(call, "startswith", 1, &prefix, error) ||
+      !ReadStringArg(call, "startswith", 0, prefix.size(), &str, &terminated,
+                     error)) {
+    return Value();
+  }
+  return Value(str == prefix);
+}
+
+Value Contains(BuiltinCall& call, EvalError& error) {
+  std::string str, needle;
+  if (!ReadFullStringArg(call, "contains", 1, &needle, error) ||
+      !ReadFullStringArg(call, "contains", 0, &str, error)) {
+    return Value();
+  }
+  // std::string::find() looks for the first byte with memchr(), which is
+  // vectorized by the C library.
+  return Value(str.find(needle) != std::string::npos);
+}
+
+// Memory block argument -- a pointer or an array. The contents of the arrays
+// which aren't in the target memory (e.g. the string literals) are on the host.
+struct Block {
+  lldb::addr_t address = LLDB_INVALID_ADDRESS;
+  std::string contents;
+  // Type of the pointer to the block, e.g. "int*" for an array of ints.
+  lldb::SBType pointer_type;
+
+  bool InMemory() const { return address != LLDB_INVALID_ADDRESS; }
+};
+
+bool GetBlockArg(BuiltinCall& call, const char* name, size_t index,
+                 Block* block, EvalError& error) {
+  lldb::SBValue value = GetArg(call, index);
+  lldb::SBType type = value.GetType().GetCanonicalType();
+
+  if (type.IsPointerType()) {
+    block->pointer_type = value.GetType();
+    block->address = static_cast<lldb::addr_t>(value.GetValueAsUnsigned());
+    if (block->address == 0) {
+      error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                llvm::formatv("'{0}' argument is a null pointer", name));
+      return false;
+    }
+    return true;
+  }
+
+  if (type.IsArrayType()) {
+    block->pointer_type = type.GetArrayElementType().GetPointerType();
+    block->address = value.GetLoadAddress();
+    if (!block->InMemory()) {
+      lldb::SBData data = value.GetData();
+      lldb::SBError read_error;
+      block->contents.assign(data.GetByteSize(), '\0');
+      if (!block->contents.empty()) {
+        data.ReadRawData(read_error, 0, &block->contents[0],
+                         block->contents.size());
+      }
+    }
+    return true;
+  }
+
+  error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+            llvm::formatv("'{0}' expects a pointer, got '{1}'", name,
+                          value.GetTypeName()));
+  return false;
+}
+
+bool GetBlockSizeArg(BuiltinCall& call, const char* name, size_t index,
+                     const std::vector<const Block*>& blocks, uint64_t* size,
+                     EvalError& error) {
+  if (!GetLengthArg(call, name, index, size, error)) {
+    return false;
+  }
+  if (*size > kMaxBlockSize) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'{0}' length {1} is larger than the limit of {2} "
+                            "bytes",
+                            name, *size, kMaxBlockSize));
+    return false;
+  }
+  for (const Block* block : blocks) {
+    if (!block->InMemory() && *size > block->contents.size()) {
+      error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                llvm::formatv("'{0}' length {1} is larger than the array of "
+                              "{2} bytes",
+                              name, *size, block->contents.size()));
+      return false;
+    }
+  }
+  return true;
+}
+
+void SetReadError(const lldb_eval::MemoryReader& reader, EvalError& error) {
+  error.Set(EvalErrorCode::UNKNOWN,
+            llvm::formatv("can't read memory at 0x{0:x}",
+                          reader.failed_address()));
+}
+
+Value MemEq(BuiltinCall& call, EvalError& error) {
+  Block lhs, rhs;
+  uint64_t size;
+  if (!GetBlockArg(call, "memeq", 0, &lhs, error) ||
+      !GetBlockArg(call, "memeq", 1, &rhs, error) ||
+      !GetBlockSizeArg(call, "memeq", 2, {&lhs, &rhs}, &size, error)) {
+    return Value();
+  }
+
+  if (!lhs.InMemory() && !rhs.InMemory()) {
+    return Value(lhs.contents.compare(0, size, rhs.contents, 0, size) == 0);
+  }
+
+  lldb_eval::MemoryReader reader(call.target.GetProcess(), call.read_set);
+  bool equal;
+  bool ok;
+  if (lhs.InMemory() && rhs.InMemory()) {
+    ok = reader.Compare(lhs.address, rhs.address, size, &equal);
+  } else {
+    const Block& memory = lhs.InMemory() ? lhs : rhs;
+    const Block& host = lhs.InMemory() ? rhs : lhs;
+    ok = reader.Compare(memory.address,
+                        host.contents.substr(0, static_cast<size_t>(size)),
+                        &equal);
+  }
+  if (!ok) {
+    SetReadError(reader, error);
+    return Value();
+  }
+  return Value(equal);
+}
+
+// Returns the pointer to the "offset" byte of the block, or the null pointer
+// if the pattern wasn't found. The type of the pointer is the type of the
+// block, same as the pointer returned by memchr() in C++.
+Value FindInBlock(BuiltinCall& call, const char* name, const Block& block,
+                  uint64_t size, const std::string& pattern, EvalError& error) {
+  if (!block.InMemory()) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'{0}' argument isn't in the memory", name));
+    return Value();
+  }
+
+  lldb_eval::MemoryReader reader(call.target.GetProcess(), call.read_set);
+  uint64_t offset;
+  bool found;
+  if (!reader.Find(block.address, size, pattern, &offset, &found)) {
+    SetReadError(reader, error);
+    return Value();
+  }
+  return Value(lldb_eval::Pointer(found ? block.address + offset : 0,
+                                  block.pointer_type));
+}
+
+Value MemChr(BuiltinCall& call, EvalError& error) {
+  Block block;
+  uint64_t size;
+  if (!GetBlockArg(call, "memchr", 0, &block, error) ||
+      !GetBlockSizeArg(call, "memchr", 2, {&block}, &size, error)) {
+    return Value();
+  }
+
+  Value& byte = call.args[1];
+  Scalar scalar = byte.IsScalar() ? byte.AsScalar() : Scalar();
+  if (scalar.type_ == Scalar::Type::INVALID ||
+      scalar.type_ == Scalar::Type::FLOAT ||
+      scalar.type_ == Scalar::Type::DOUBLE ||
+      scalar.type_ == Scalar::Type::LONG_DOUBLE) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              "'memchr' expects an integer byte");
+    return Value();
+  }
+  // Same as memchr(), the byte is converted to "unsigned char".
+  std::string pattern(1, static_cast<char>(scalar.GetAs<uint64_t>() & 0xff));
+  return FindInBlock(call, "memchr", block, size, pattern, error);
+}
+
+Value MemFind(BuiltinCall& call, EvalError& error) {
+  Block block;
+  uint64_t size;
+  if (!GetBlockArg(call, "memfind", 0, &block, error) ||
+      !GetBlockSizeArg(call, "memfind", 1, {&block}, &size, error)) {
+    return Value();
+  }
+
+  // The pattern is a string (e.g. a literal) without the terminator, or all
+  // bytes of another array (e.g. "unsigned char magic[4]").
+  lldb::SBType type = GetArg(call, 2).GetType().GetCanonicalType();
+  lldb::SBType element_type = type.IsPointerType()
+                                  ? type.GetPointeeType()
+                                  : type.GetArrayElementType();
+  bool is_string = (type.IsPointerType() || type.IsArrayType()) &&
+                   element_type.GetCanonicalType().GetBasicType() ==
+                       lldb::eBasicTypeChar;
+  std::string pattern;
+  if (is_string) {
+    if (!ReadFullStringArg(call, "memfind", 2, &pattern, error)) {
+      return Value();
+    }
+  } else if (type.IsArrayType()) {
+    lldb::SBValue array = GetArg(call, 2);
+    lldb::SBData data = array.GetData();
+    lldb::SBError read_error;
+    pattern.assign(data.GetByteSize(), '\0');
+    if (!pattern.empty()) {
+      data.ReadRawData(read_error, 0, &pattern[0], pattern.size());
+    }
+    if (call.read_set && array.GetLoadAddress() != LLDB_INVALID_ADDRESS) {
+      call.read_set->AddMemory(array.GetLoadAddress(), pattern.size());
+    }
+  } else {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'memfind' expects an array or a string pattern, "
+                            "got '{0}'",
+                            GetArg(call, 2).GetTypeName()));
+    return Value();
+  }
+  return FindInBlock(call, "memfind", block, size, pattern, error);
+}
+
+// Longer lists are not walked.
+const uint64_t kMaxListLength = 1024 * 1024;
+
+// The predicates are evaluated over the batches of the nodes. The batches grow,
+// so that the searches which end early walk only a few nodes past the match.
+const size_t kFirstListBatch = 16;
+const size_t kMaxListBatch = 4096;
+
+// The nodes are read whole (and stay cached for the rest of the stop), unless
+// they are larger than this. Then just the links are read.
+const uint64_t kMaxNodeReadSize = 4096;
+
+// Checks if the link is a path of the members of the node, e.g. "_->next" or
+// "_->hook.next". Such links are at the same offset in every node.
+class MemberPathChecker : lldb_eval::Visitor {
+ public:
+  bool IsMemberPath(const lldb_eval::AstNode* link) {
+    link->Accept(this);
+    return kind_ == Kind::kMemberPath;
+  }
+
+ private:
+  enum class Kind {
+    kElement,
+    kMemberPath,
+    kOther,
+  };
+
+  void Visit(const lldb_eval::ErrorNode*) override { kind_ = Kind::kOther; }
+
+  void Visit(const lldb_eval::BooleanLiteralNode*) override {
+    kind_ = Kind::kOther;
+  }
+
+  void Visit(const lldb_eval::NumericLiteralNode*) override {
+    kind_ = Kind::kOther;
+  }
+
+  void Visit(const lldb_eval::StringLiteralNode*) override {
+    kind_ = Kind::kOther;
+  }
+
+  void Visit(const lldb_eval::IdentifierNode* node) override {
+    kind_ = node->name() == lldb_eval::kElementName ? Kind::kElement
+                                                     : Kind::kOther;
+  }
+
+  void Visit(const lldb_eval::CStyleCastNode*) override {
+    kind_ = Kind::kOther;
+  }
+
+  void Visit(const lldb_eval::MemberOfNode* node) override {
+    node->lhs()->Accept(this);
+    bool is_pointer =
+        node->type() == lldb_eval::MemberOfNode::Type::OF_POINTER;
+    // "_->member" starts the path, "path.member" continues it.
+    if ((is_pointer && kind_ == Kind::kElement) ||
+        (!is_pointer && kind_ == Kind::kMemberPath)) {
+      kind_ = Kind::kMemberPath;
+    } else {
+      kind_ = Kind::kOther;
+    }
+  }
+
+  void Visit(const lldb_eval::BinaryOpNode*) override { kind_ = Kind::kOther; }
+
+  void Visit(const lldb_eval::ArraySliceNode*) override {
+    kind_ = Kind::kOther;
+  }
+
+  void Visit(const lldb_eval::CallNode*) override { kind_ = Kind::kOther; }
+
+  void Visit(const lldb_eval::MethodCallNode*) override {
+    kind_ = Kind::kOther;
+  }
+
+  void Visit(const lldb_eval::UnaryOpNode*) override { kind_ = Kind::kOther; }
+
+  void Visit(const lldb_eval::TernaryOpNode*) override {
+    kind_ = Kind::kOther;
+  }
+
+ private:
+  Kind kind_ = Kind::kOther;
+};
+
+// Walks the linked list from the head (the first argument) following the link
+// (the second argument, a lambda, e.g. "_->next"). The links which are members
+// of the nodes are read from the nodes directly, other links are evaluated by
+// the Interpreter for every node. The walk stops at the null link or at the
+// first node visited twice.
+class ListWalker {
+ public:
+  ListWalker(BuiltinCall& call, const char* name)
+      : call_(call),
+        name_(name),
+        interpreter_(*call.expr_ctx),
+        reader_(call.target.GetProcess(), call.read_set) {
+    interpreter_.SetReadSet(call.read_set);
+    for (const auto& [bound_name, value] : call.bound_variables) {
+      interpreter_.BindVariable(bound_name, value);
+    }
+  }
+
+  bool Init(EvalError& error) {
+    lldb::SBValue head = GetArg(call_, 0);
+    pointer_type_ = head.GetType();
+    lldb::SBType canonical = pointer_type_.GetCanonicalType();
+    if (!canonical.IsPointerType()) {
+      error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                llvm::formatv("'{0}' expects a pointer to the first node, got "
+                              "'{1}'",
+                              name_, head.GetTypeName()));
+      return false;
+    }
+    node_ = static_cast<lldb::addr_t>(head.GetValueAsUnsigned());
+    node_size_ = canonical.GetPointeeType().GetByteSize();
+    address_size_ = call_.target.GetAddressByteSize();
+    is_member_path_ = MemberPathChecker().IsMemberPath(link());
+    return true;
+  }
+
+  // Appends the next "count" nodes to "nodes" (if set), fewer at the end of
+  // the list.
+  bool Walk(uint64_t count, std::vector<lldb::addr_t>* nodes,
+            EvalError& error) {
+    for (uint64_t i = 0; i < count && !AtEnd(); ++i) {
+      if (!visited_.insert(node_).second) {
+        has_cycle_ = true;
+        break;
+      }
+      if (length_ == kMaxListLength) {
+        error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                  llvm::formatv("'{0}' list is longer than {1} nodes", name_,
+                                kMaxListLength));
+        return false;
+      }
+      if (nodes) {
+        nodes->push_back(node_);
+      }
+      ++length_;
+      if (!Advance(error)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool AtEnd() const { return node_ == 0 || has_cycle_; }
+  bool has_cycle() const { return has_cycle_; }
+
+  Value ReportCycle(EvalError& error) const {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("'{0}' list has a cycle, node {1} links back to "
+                            "the node at 0x{2:x}",
+                            name_, length_ - 1, node_));
+    return Value();
+  }
+
+  // The next node of the walk, null at the end of the list.
+  lldb::addr_t node() const { return has_cycle_ ? 0 : node_; }
+  // Number of the nodes walked.
+  uint64_t length() const { return length_; }
+  lldb::SBType pointer_type() const { return pointer_type_; }
+
+ private:
+  const lldb_eval::AstNode* link() const { return call_.lambdas[1]; }
+
+  bool Advance(EvalError& error) {
+    if (has_link_offset_) {
+      std::string contents;
+      if (!reader_.ReadCached(node_, static_cast<size_t>(node_read_size_),
+                              &contents)) {
+        SetReadError(reader_, error);
+        return false;
+      }
+      node_ = lldb_eval::DecodeUnsigned(contents, link_offset_, address_size_,
+                                        call_.target.GetByteOrder());
+      return true;
+    }
+
+    interpreter_.BindVariable(lldb_eval::kElementName,
+                              Value(lldb_eval::Pointer(node_, pointer_type_)));
+    Value link_value = interpreter_.Eval(link(), error);
+    if (error) {
+      error.Set(error.code(), "node " + std::to_string(length_ - 1) + ": " +
+                                  error.message());
+      return false;
+    }
+    lldb::SBValue link_val = link_value.AsSbValue(call_.target);
+    if (link_val.GetType().IsReferenceType()) {
+      link_val = link_val.Dereference();
+    }
+    if (!link_val.GetType().GetCanonicalType().IsPointerType()) {
+      error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                llvm::formatv("'{0}' link is not a pointer, got '{1}'", name_,
+                              link_val.GetTypeName()));
+      return false;
+    }
+
+    // The first member link gives the offset of the links in all nodes.
+    lldb::addr_t address = link_value.IsSbValue() ? link_val.GetLoadAddress()
+                                                  : LLDB_INVALID_ADDRESS;
+    if (is_member_path_ && address != LLDB_INVALID_ADDRESS &&
+        address >= node_ && address - node_ + address_size_ <= node_size_) {
+      has_link_offset_ = true;
+      link_offset_ = address - node_;
+      node_read_size_ = node_size_ <= kMaxNodeReadSize
+                            ? node_size_
+                            : link_offset_ + address_size_;
+    }
+    is_member_path_ = false;
+    node_ = static_cast<lldb::addr_t>(link_val.GetValueAsUnsigned());
+    return true;
+  }
+
+  BuiltinCall& call_;
+  const char* name_;
+  lldb_eval::Interpreter interpreter_;
+  lldb_eval::MemoryReader reader_;
+
+  lldb::SBType pointer_type_;
+  lldb::addr_t node_ = 0;
+  uint64_t node_size_ = 0;
+  uint64_t address_size_ = 0;
+  uint64_t length_ = 0;
+  std::unordered_set<lldb::addr_t> visited_;
+  bool has_cycle_ = false;
+
+  bool is_member_path_ = false;
+  bool has_link_offset_ = false;
+  uint64_t link_offset_ = 0;
+  uint64_t node_read_size_ = 0;
+};
+
+Value ListLen(BuiltinCall& call, EvalError& error) {
+  ListWalker walker(call, "list_len");
+  if (!walker.Init(error) ||
+      !walker.Walk(kMaxListLength + 1, nullptr, error)) {
+    return Value();
+  }
+  if (walker.has_cycle()) {
+    return walker.ReportCycle(error);
+  }
+  return Value(Scalar(static_cast<int64_t>(walker.length())));
+}
+
+Value ListNth(BuiltinCall& call, EvalError& error) {
+  ListWalker walker(call, "list_nth");
+  uint64_t index;
+  if (!walker.Init(error) ||
+      !GetNonNegativeArg(call, "list_nth", 2, "index", &index, error) ||
+      !walker.Walk(index, nullptr, error)) {
+    return Value();
+  }
+  if (walker.has_cycle()) {
+    return walker.ReportCycle(error);
+  }
+  return Value(lldb_eval::Pointer(walker.node(), walker.pointer_type()));
+}
+
+Value ListFind(BuiltinCall& call, EvalError& error) {
+  ListWalker walker(call, "list_find");
+  if (!walker.Init(error)) {
+    return Value();
+  }
+
+  // Finds the first of the nodes satisfying the predicate, -1 if there is no
+  // such node.
+  auto find_match = [&](const std::vector<lldb::addr_t>& nodes, int64_t first,
+                        int64_t* index) {
+    RangeResult matches;
+    if (!EvaluateOverPointers(*call.expr_ctx, call.lambdas[2],
+                              lldb_eval::kElementName, walker.pointer_type(),
+                              nodes, first, call.bound_variables,
+                              call.read_set, &matches, error)) {
+      return false;
+    }
+    *index = -1;
+    DispatchValues(matches, [&](const auto& values) {
+      *index = FindFirst(values, [](auto value) { return value != 0; });
+    });
+    return true;
+  };
+
+  std::vector<lldb::addr_t> nodes;
+  size_t batch = kFirstListBatch;
+  while (!walker.AtEnd()) {
+    int64_t first = static_cast<int64_t>(walker.length());
+    nodes.clear();
+    if (!walker.Walk(batch, &nodes, error)) {
+      return Value();
+    }
+    int64_t index = -1;
+    if (!nodes.empty() && !find_match(nodes, first, &index)) {
+      // The predicate may fail only past the match, e.g. "_->next->id == 1"
+      // at the last node. The nodes are evaluated one by one then, the first
+      // match before the failing node wins.
+      error.Clear();
+      for (size_t k = 0; k < nodes.size() && index < 0; ++k) {
+        int64_t match;
+        if (!find_match({nodes[k]}, first + static_cast<int64_t>(k), &match)) {
+          return Value();
+        }
+        if (match == 0) {
+          index = static_cast<int64_t>(k);
+        }
+      }
+    }
+    if (index >= 0) {
+      return Value(lldb_eval::Pointer(nodes[static_cast<size_t>(index)],
+                                      walker.pointer_type()));
+    }
+    batch = std::min(batch * 2, kMaxListBatch);
+  }
+  if (walker.has_cycle()) {
+    return walker.ReportCycle(error);
+  }
+  return Value(lldb_eval::Pointer(0, walker.pointer_type()));
+}
+
+const lldb_eval::Builtin kBuiltins[] = {
+    // name, min_args, max_args, lambda_args, function
+    {"all", 1, 2, 0b10, All},
+    {"any", 1, 2, 0b10, Any},
+    {"contains", 2, 2, 0b00, Contains},
+    {"count", 1, 2, 0b10, Count},
+    {"filter", 2, 2, 0b10, Filter},
+    {"find", 2, 2, 0b00, Find},
+    {"find_if", 2, 2, 0b10, FindIf},
+    {"list_find", 3, 3, 0b110, ListFind},
+    {"list_len", 2, 2, 0b010, ListLen},
+    {"list_nth", 3, 3, 0b010, ListNth},
+    {"max", 1, 2, 0b10, Max},
+    {"memchr", 3, 3, 0b00, MemChr},
+    {"memeq", 3, 3, 0b00, MemEq},
+    {"memfind", 3, 3, 0b00, MemFind},
+    {"min", 1, 2, 0b10, Min},
+    {"startswith", 2, 2, 0b00, StartsWith},
+    {"streq", 2, 2, 0b00, StrEq},
+    {"strlen", 1, 1, 0b00, StrLen},
+    {"strneq", 3, 3, 0b00, StrNEq},
+    {"sum", 1, 2, 0b10, Sum},
+};
+
+}  // namespace
+
+namespace lldb_eval {
+
+const Builtin* FindBuiltin(llvm::StringRef name) {
+  for (const Builtin& builtin : kBuiltins) {
+    if (name == builtin.name) {
+      return &builtin;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace lldb_eval
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_BUILTINS_H_
+#define LLDB_EVAL_BUILTINS_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lldb-eval/ast.h"
+#include "lldb-eval/eval.h"
+#include "lldb-eval/expression_context.h"
+#include "lldb-eval/read_set.h"
+#include "lldb-eval/value.h"
+#include "lldb/API/SBTarget.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace lldb_eval {
+
+// Inside the lambda arguments of the builtins (e.g. the predicate of
+// "count(arr, _ > 0)") this identifier refers to the current element.
+const char kElementName[] = "_";
+
+// Call of a builtin function, prepared by the interpreter.
+struct BuiltinCall {
+  ExpressionContext* expr_ctx;
+  lldb::SBTarget target;
+
+  // Optional, collects the memory read by the builtin.
+  ReadSet* read_set;
+
+  // Variables bound in the calling interpreter, visible in the lambdas.
+  std::unordered_map<std::string, Value> bound_variables;
+
+  // Arguments evaluated by the interpreter. Invalid for the lambdas.
+  std::vector<Value> args;
+
+  // Lambda arguments, evaluated by the builtin for every element. Null for the
+  // regular arguments.
+  std::vector<const AstNode*> lambdas;
+};
+
+using BuiltinFunction = Value (*)(BuiltinCall& call, EvalError& error);
+
+struct Builtin {
+  const char* name;
+  uint32_t min_args;
+  uint32_t max_args;
+  // Bitmask of the arguments which are lambdas, e.g. 0b10 if the second
+  // argument is a lambda.
+  uint32_t lambda_args;
+  BuiltinFunction function;
+
+  bool IsLambda(size_t index) const { return (lambda_args >> index) & 1; }
+};
+
+// Returns the builtin function with the given name, or nullptr if there isn't
+// one.
+//
+// Reductions over arrays (the arrays of the target, slices and "p@n"):
+//   sum(arr), sum(arr, f)      -- sum of the elements or of f(_)
+//   min(arr), min(arr, f)      -- minimum of the elements or of f(_)
+//   max(arr), max(arr, f)      -- maximum of the elements or of f(_)
+//   count(arr), count(arr, p)  -- number of the non-zero elements or of the
+//                                 elements satisfying p(_)
+//   any(arr), any(arr, p)      -- true if count() is not zero
+//   all(arr), all(arr, p)      -- true if count() equals the array size
+//   find(arr, value)           -- index of the first element equal to the
+//                                 value, -1 if there isn't one
+//   find_if(arr, p)            -- index of the first element satisfying p(_)
+//   filter(arr, p)             -- array of the elements satisfying p(_)
+//
+// The arithmetic follows the Scalar semantics of the element type, e.g. the sum
+// of an "unsigned int" array wraps around.
+//
+// C strings (pointers to chars and char arrays, e.g. the string literals):
+//   strlen(s)                  -- length of the string
+//   streq(a, b)                -- true if the strings are equal
+//   strneq(a, b, n)            -- true if the first n bytes are equal, same as
+//                                 strncmp(a, b, n) == 0
+//   startswith(s, prefix)      -- true if the string starts with the prefix
+//   contains(s, needle)        -- true if the string contains the needle
+//
+// Memory blocks (pointers and arrays, n is the size in bytes):
+//   memeq(p, q, n)             -- true if the blocks are equal, same as
+//                                 memcmp(p, q, n) == 0
+//   memchr(p, byte, n)         -- pointer to the first byte in the block, null
+//                                 if there isn't one
+//   memfind(p, n, pattern)     -- pointer to the first occurrence of the
+//                                 pattern (a string or an array) in the block
+//
+// The strings and the blocks are read from the target memory in bounded
+// chunks, only as many bytes as the result depends on (e.g. streq() reads at
+// most one byte past the length of the shorter known string, memeq() stops at
+// the first chunk which differs). Strings longer than 1 MiB and blocks larger
+// than 64 MiB are rejected.
+//
+// Linked lists (the head is the pointer to the first node, the link gives the
+// next node of the node "_", e.g. "_->next"):
+//   list_len(head, link)       -- number of the nodes
+//   list_nth(head, link, k)    -- pointer to the k-th node (counting from 0),
+//                                 null if the list is shorter
+//   list_find(head, link, p)   -- pointer to the first node satisfying p(_),
+//                                 null if there isn't one
+//
+// The walks stop at the null links, the lists with cycles and the lists longer
+// than 1M nodes are rejected. The links which are members of the nodes (e.g.
+// "_->next" or "_->hook.next") are read directly, every node is read with a
+// single request and stays cached until the process resumes. The predicates
+// are evaluated over the batches of the nodes at once.
+const Builtin* FindBuiltin(llvm::StringRef name);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_BUILTINS_H_
@@ -0,0 +1,186 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/child_pager.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "lldb-eval/api.h"
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/API/SBTarget.h"
+#include "lldb/API/SBType.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-enumerations.h"
+
+namespace {
+
+bool ReadMemory(lldb::SBProcess process, lldb::addr_t address, size_t size,
+                std::string* contents, lldb::SBError& error) {
+  contents->resize(size);
+  if (size == 0) {
+    return true;
+  }
+  size_t read = process.ReadMemory(address, &(*contents)[0], size, error);
+  if (error.Success() && read != size) {
+    error.SetErrorString("partial memory read");
+  }
+  return error.Success();
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+ChildPagerImpl::ChildPagerImpl(lldb::SBValue value,
+                               const ChildPageOptions& options)
+    : value_(value),
+      options_(options),
+      num_children_(0),
+      is_bulk_(false),
+      element_size_(0),
+      address_(LLDB_INVALID_ADDRESS),
+      has_prefetched_page_(false),
+      prefetched_page_(0),
+      prefetched_stop_id_(0) {
+  if (options_.page_size == 0) {
+    options_.page_size = 1;
+  }
+
+  // Keep the typedefs of the element type if possible.
+  lldb::SBType type = value_.GetType();
+  if (!type.IsArrayType()) {
+    type = type.GetCanonicalType();
+  }
+  if (type.IsArrayType()) {
+    element_type_ = type.GetArrayElementType();
+    element_size_ = element_type_.GetByteSize();
+    address_ = value_.GetLoadAddress();
+    is_bulk_ = element_size_ > 0 && address_ != LLDB_INVALID_ADDRESS &&
+               value_.GetValueType() != lldb::eValueTypeRegister;
+  }
+
+  if (is_bulk_) {
+    // Don't ask LLDB, it would create the children.
+    num_children_ =
+        static_cast<uint32_t>(value_.GetByteSize() / element_size_);
+  } else {
+    num_children_ = value_.GetNumChildren();
+  }
+}
+
+uint32_t ChildPagerImpl::GetNumPages() const {
+  return static_cast<uint32_t>(
+      (uint64_t(num_children_) + options_.page_size - 1) / options_.page_size);
+}
+
+bool ChildPagerImpl::ReadPage(uint32_t page_index, uint32_t num_children,
+                              std::string* contents, lldb::SBError& error) {
+  lldb::SBProcess process = value_.GetProcess();
+  // Expressions run by LLDB (e.g. function calls) can change the memory too.
+  uint32_t stop_id = process.GetStopID(/*include_expression_stops=*/true);
+
+  if (has_prefetched_page_ && prefetched_page_ == page_index &&
+      prefetched_stop_id_ == stop_id) {
+    has_prefetched_page_ = false;
+    *contents = std::move(prefetched_contents_);
+    return true;
+  }
+
+  uint64_t first_index = uint64_t(page_index) * options_.page_size;
+  lldb::addr_t address = address_ + first_index * element_size_;
+  size_t page_bytes = static_cast<size_t>(num_children * element_size_);
+
+  uint32_t num_prefetched = 0;
+  if (options_.prefetch_next_page) {
+    uint64_t next_index = first_index + num_children;
+    num_prefetched = static_cast<uint32_t>(std::min<uint64_t>(
+        options_.page_size, num_children_ - next_index));
+  }
+
+  if (num_prefetched > 0) {
+    size_t prefetched_bytes =
+        static_cast<size_t>(num_prefetched * element_size_);
+    lldb::SBError read_error;
+    if (ReadMemory(process, address, page_bytes + prefetched_bytes, contents,
+                   read_error)) {
+      has_prefetched_page_ = true;
+      prefetched_page_ = page_index + 1;
+      prefetched_stop_id_ = stop_id;
+      prefetched_contents_ = contents->substr(page_bytes);
+      contents->resize(page_bytes);
+      return true;
+    }
+    // The next page may be unreadable, try the requested one alone.
+  }
+
+  return ReadMemory(process, address, page_bytes, contents, error);
+}
+
+ChildPage ChildPagerImpl::GetPage(uint32_t page_index, lldb::SBError& error) {
+  error.Clear();
+
+  ChildPage page;
+  page.first_index = 0;
+  page.element_type = element_type_;
+
+  if (page_index >= GetNumPages()) {
+    error.SetErrorString("page index is out of range");
+    return page;
+  }
+
+  page.first_index = page_index * options_.page_size;
+  uint32_t num_children =
+      std::min(options_.page_size, num_children_ - page.first_index);
+  page.children.reserve(num_children);
+
+  if (!is_bulk_) {
+    for (uint32_t i = 0; i < num_children; ++i) {
+      page.children.push_back(value_.GetChildAtIndex(page.first_index + i));
+    }
+    return page;
+  }
+
+  std::string contents;
+  if (!ReadPage(page_index, num_children, &contents, error)) {
+    return page;
+  }
+
+  lldb::SBTarget target = value_.GetTarget();
+  lldb::ByteOrder byte_order = target.GetByteOrder();
+  uint8_t address_size = static_cast<uint8_t>(target.GetAddressByteSize());
+  size_t element_size = static_cast<size_t>(element_size_);
+
+  for (uint32_t i = 0; i < num_children; ++i) {
+    // lldb::SBData::SetData() doesn't actually use "error".
+    lldb::SBError data_error;
+    lldb::SBData data;
+    data.SetData(data_error, contents.data() + i * element_size, element_size,
+                 byte_order, address_size);
+
+    // Name the elements like LLDB does.
+    std::string name = "[" + std::to_string(page.first_index + i) + "]";
+    page.children.push_back(
+        target.CreateValueFromData(name.c_str(), data, element_type_));
+  }
+
+  return page;
+}
+
+}  // namespace lldb_eval
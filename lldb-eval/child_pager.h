@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_CHILD_PAGER_H_
+#define LLDB_EVAL_CHILD_PAGER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "lldb-eval/api.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBType.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-types.h"
+
+namespace lldb_eval {
+
+// Implementation of the ChildPager API. The arrays in the process memory are
+// read in bulk, other aggregates (e.g. structs, arrays living in registers)
+// fall back to lldb::SBValue::GetChildAtIndex().
+class ChildPagerImpl : public ChildPager {
+ public:
+  ChildPagerImpl(lldb::SBValue value, const ChildPageOptions& options);
+
+  uint32_t GetNumChildren() const override { return num_children_; }
+  uint32_t GetNumPages() const override;
+
+  ChildPage GetPage(uint32_t page_index, lldb::SBError& error) override;
+
+ private:
+  // Reads the contents of the page (and the next one, if it's prefetched).
+  bool ReadPage(uint32_t page_index, uint32_t num_children,
+                std::string* contents, lldb::SBError& error);
+
+ private:
+  lldb::SBValue value_;
+  ChildPageOptions options_;
+  uint32_t num_children_;
+
+  // Set if the children are the elements of an array in memory.
+  bool is_bulk_;
+  lldb::SBType element_type_;
+  uint64_t element_size_;
+  lldb::addr_t address_;
+
+  // Prefetched page, valid until the process resumes.
+  bool has_prefetched_page_;
+  uint32_t prefetched_page_;
+  uint32_t prefetched_stop_id_;
+  std::string prefetched_contents_;
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_CHILD_PAGER_H_
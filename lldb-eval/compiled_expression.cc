@@ -0,0 +1,143 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/compiled_expression.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "lldb-eval/ast_printer.h"
+#include "lldb-eval/eval.h"
+#include "lldb-eval/expression_context.h"
+#include "lldb-eval/memory_reader.h"
+#include "lldb-eval/parser.h"
+#include "lldb-eval/read_set.h"
+#include "lldb-eval/value.h"
+#include "lldb/API/SBAddress.h"
+#include "lldb/API/SBBlock.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBExecutionContext.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/API/SBTarget.h"
+#include "lldb/API/SBThread.h"
+#include "lldb/API/SBValue.h"
+
+namespace lldb_eval {
+
+CompiledExpression::CompiledExpression(std::string expr)
+    : expr_(std::move(expr)),
+      has_result_(false),
+      reused_(false),
+      identity_() {}
+
+bool CompiledExpression::FrameIdentity::operator==(
+    const FrameIdentity& other) const {
+  return process_id == other.process_id && thread_id == other.thread_id &&
+         frame_index == other.frame_index && cfa == other.cfa &&
+         block == other.block;
+}
+
+CompiledExpression::FrameIdentity CompiledExpression::GetFrameIdentity(
+    lldb::SBFrame frame) {
+  lldb::SBThread thread = frame.GetThread();
+  lldb::SBProcess process = thread.GetProcess();
+  lldb::SBTarget target = process.GetTarget();
+
+  // The innermost lexical block determines which variables are visible (and
+  // which of them are shadowed).
+  lldb::SBBlock block = frame.GetBlock();
+  lldb::SBAddress block_start = block.GetRangeStartAddress(0);
+
+  return {process.GetUniqueID(), thread.GetThreadID(), frame.GetFrameID(),
+          frame.GetCFA(), block_start.GetLoadAddress(target)};
+}
+
+void CompiledExpression::Compile(lldb::SBFrame frame) {
+  expr_ctx_ = std::make_unique<ExpressionContext>(
+      expr_, lldb::SBExecutionContext(frame));
+
+  Parser p(*expr_ctx_);
+  ast_ = p.Run();
+  parse_error_ = p.HasError() ? p.GetError() : "";
+  canonical_ = p.HasError() ? expr_ : PrintCanonical(ast_.get());
+}
+
+const std::string& CompiledExpression::Prepare(lldb::SBFrame frame) {
+  FrameIdentity identity = GetFrameIdentity(frame);
+
+  // The parsed expression is bound to the frame, e.g. it depends on the types
+  // visible in it.
+  if (!expr_ctx_ || !(identity == identity_)) {
+    Compile(frame);
+    identity_ = identity;
+    has_result_ = false;
+  }
+  return canonical_;
+}
+
+lldb::SBValue CompiledExpression::Evaluate(lldb::SBFrame frame,
+                                           lldb::SBError& error) {
+  Prepare(frame);
+
+  // Nothing the previous evaluation depends on has changed.
+  if (has_result_ && read_set_.IsUnchanged(frame)) {
+    reused_ = true;
+    error = error_;
+    return value_;
+  }
+  reused_ = false;
+
+  // The inputs have changed, possibly written while the process stayed stopped.
+  // The memory cached during the stop could hold their previous contents.
+  if (has_result_ && read_set_.IsComplete()) {
+    InvalidateStopCache();
+  }
+
+  error.Clear();
+  lldb::SBValue value;
+  ReadSet read_set;
+
+  if (!parse_error_.empty()) {
+    error.SetError(
+        static_cast<uint32_t>(EvalErrorCode::INVALID_EXPRESSION_SYNTAX),
+        lldb::eErrorTypeGeneric);
+    error.SetErrorString(parse_error_.c_str());
+  } else {
+    Interpreter interpreter(*expr_ctx_);
+    interpreter.SetReadSet(&read_set);
+
+    EvalError err;
+    Value result = interpreter.Eval(ast_.get(), err);
+    if (err) {
+      error.SetError(static_cast<uint32_t>(err.code()),
+                     lldb::eErrorTypeGeneric);
+      error.SetErrorString(err.message().c_str());
+    } else {
+      value = result.AsSbValue(expr_ctx_->GetExecutionContext().GetTarget());
+    }
+  }
+
+  read_set.Capture(frame);
+
+  has_result_ = true;
+  read_set_ = std::move(read_set);
+  value_ = value;
+  error_ = error;
+
+  return value;
+}
+
+}  // namespace lldb_eval
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_COMPILED_EXPRESSION_H_
+#define LLDB_EVAL_COMPILED_EXPRESSION_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "lldb-eval/ast.h"
+#include "lldb-eval/expression_context.h"
+#include "lldb-eval/read_set.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-types.h"
+
+namespace lldb_eval {
+
+// CompiledExpression is an expression which is evaluated repeatedly, e.g. in a
+// watch window. It's parsed once per frame and remembers the memory and the
+// registers its last evaluation has read (see ReadSet). If the expression is
+// evaluated in the same frame again and none of them has changed, the previous
+// result is returned without running the interpreter.
+class CompiledExpression {
+ public:
+  explicit CompiledExpression(std::string expr);
+
+  const std::string& expr() const { return expr_; }
+
+  // Parses the expression for the given frame, unless it's already parsed for
+  // it, and returns its canonical form (see PrintCanonical()). Expressions
+  // that fail to parse are keyed by their text.
+  const std::string& Prepare(lldb::SBFrame frame);
+
+  lldb::SBValue Evaluate(lldb::SBFrame frame, lldb::SBError& error);
+
+  // Checks if the last call to Evaluate() has reused the previous result.
+  bool reused() const { return reused_; }
+
+ private:
+  // Identifies the frame and the lexical block the variables are looked up in.
+  struct FrameIdentity {
+    uint32_t process_id;
+    uint64_t thread_id;
+    uint32_t frame_index;
+    lldb::addr_t cfa;
+    lldb::addr_t block;
+
+    bool operator==(const FrameIdentity& other) const;
+  };
+
+  static FrameIdentity GetFrameIdentity(lldb::SBFrame frame);
+
+  void Compile(lldb::SBFrame frame);
+
+ private:
+  std::string expr_;
+
+  // Parsed expression and the context it's bound to, valid while the frame
+  // identity stays the same.
+  std::unique_ptr<ExpressionContext> expr_ctx_;
+  ExprResult ast_;
+  std::string parse_error_;
+  std::string canonical_;
+
+  bool has_result_;
+  bool reused_;
+  FrameIdentity identity_;
+  ReadSet read_set_;
+  lldb::SBValue value_;
+  lldb::SBError error_;
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_COMPILED_EXPRESSION_H_
@@ -0,0 +1,239 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/enum_table.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lldb-eval/module_index.h"
+#include "lldb-eval/scope_resolver.h"
+#include "lldb/API/SBModule.h"
+#include "lldb/API/SBType.h"
+#include "lldb/lldb-enumerations.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace {
+
+using lldb_eval::EnumTable;
+
+// The tables are shared by all evaluations. SBType doesn't expose its module in
+// LLDB 10, so the types with the same name (e.g. the local enumerations of
+// different functions, or of different modules) are told apart by comparing
+// them.
+class EnumTableRegistry {
+ public:
+  std::shared_ptr<const EnumTable> Find(const std::string& name,
+                                        lldb::SBType type) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return FindLocked(name, type);
+  }
+
+  // Returns the table already added by another thread, if there is one.
+  std::shared_ptr<const EnumTable> Add(const std::string& name,
+                                       lldb::SBType type,
+                                       std::shared_ptr<const EnumTable> table) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto existing = FindLocked(name, type)) {
+      return existing;
+    }
+    tables_[name].emplace_back(type, table);
+    return table;
+  }
+
+ private:
+  // Must be called with the lock held.
+  std::shared_ptr<const EnumTable> FindLocked(const std::string& name,
+                                              lldb::SBType type) {
+    auto it = tables_.find(name);
+    if (it == tables_.end()) {
+      return nullptr;
+    }
+    for (auto& [cached_type, table] : it->second) {
+      if (cached_type == type) {
+        return table;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  std::mutex mutex_;
+  // Type name -> the types with that name and their tables.
+  std::unordered_map<
+      std::string,
+      std::vector<std::pair<lldb::SBType, std::shared_ptr<const EnumTable>>>>
+      tables_;
+};
+
+EnumTableRegistry& GetEnumTableRegistry() {
+  static EnumTableRegistry* registry = new EnumTableRegistry();
+  return *registry;
+}
+
+// Enumerators of the module by their unqualified names, see FindEnumerators().
+using EnumeratorIndex = std::unordered_map<
+    std::string, std::vector<std::pair<std::string, lldb::SBType>>>;
+
+EnumeratorIndex BuildEnumeratorIndex(lldb::SBModule module) {
+  EnumeratorIndex index;
+  lldb::SBTypeList types = module.GetTypes(lldb::eTypeClassEnumeration);
+  for (uint32_t i = 0; i < types.GetSize(); ++i) {
+    lldb::SBType type = types.GetTypeAtIndex(i);
+    const char* type_name = type.GetName();
+    llvm::StringRef name = type_name ? type_name : "";
+    llvm::StringRef base_name = lldb_eval::GetBaseName(name);
+    std::string scope =
+        base_name.size() + 2 <= name.size()
+            ? name.drop_back(base_name.size() + 2).str() + "::"
+            : "";
+
+    lldb::SBTypeEnumMemberList members = type.GetEnumMembers();
+    for (uint32_t j = 0; j < members.GetSize(); ++j) {
+      const char* member = members.GetTypeEnumMemberAtIndex(j).GetName();
+      if (member) {
+        index[member].emplace_back(scope + member, type);
+      }
+    }
+  }
+  return index;
+}
+
+class EnumeratorIndexRegistry {
+ public:
+  std::shared_ptr<const EnumeratorIndex> Get(lldb::SBModule module) {
+    std::string key = lldb_eval::GetModuleKey(module);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = indexes_.find(key);
+      if (it != indexes_.end()) {
+        return it->second;
+      }
+    }
+    auto index =
+        std::make_shared<const EnumeratorIndex>(BuildEnumeratorIndex(module));
+    std::lock_guard<std::mutex> lock(mutex_);
+    return indexes_.emplace(key, index).first->second;
+  }
+
+  bool Contains(lldb::SBModule module) {
+    std::string key = lldb_eval::GetModuleKey(module);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return indexes_.count(key) > 0;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<const EnumeratorIndex>>
+      indexes_;
+};
+
+EnumeratorIndexRegistry& GetEnumeratorIndexRegistry() {
+  static EnumeratorIndexRegistry* registry = new EnumeratorIndexRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+std::shared_ptr<const EnumTable> EnumTable::Get(lldb::SBType type) {
+  type = type.GetCanonicalType();
+  if (type.GetTypeClass() != lldb::eTypeClassEnumeration) {
+    return nullptr;
+  }
+  const char* type_name = type.GetName();
+  std::string key = type_name ? type_name : "";
+  EnumTableRegistry& registry = GetEnumTableRegistry();
+  if (auto table = registry.Find(key, type)) {
+    return table;
+  }
+
+  std::shared_ptr<EnumTable> table(new EnumTable());
+  table->byte_size_ = type.GetByteSize();
+
+  // The underlying type isn't known, it's unsigned if some enumerator doesn't
+  // fit into the signed type of the same size.
+  uint64_t max_signed =
+      table->byte_size_ > 0 && table->byte_size_ < sizeof(int64_t)
+          ? (uint64_t{1} << (table->byte_size_ * 8 - 1)) - 1
+          : static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+
+  lldb::SBTypeEnumMemberList members = type.GetEnumMembers();
+  for (uint32_t i = 0; i < members.GetSize(); ++i) {
+    lldb::SBTypeEnumMember member = members.GetTypeEnumMemberAtIndex(i);
+    const char* name = member.GetName();
+    if (!name) {
+      continue;
+    }
+    int64_t value = member.GetValueAsSigned();
+    if (value < 0) {
+      table->has_negative_values_ = true;
+      table->values_.emplace(name, static_cast<uint64_t>(value));
+      continue;
+    }
+    uint64_t unsigned_value = member.GetValueAsUnsigned();
+    if (unsigned_value > max_signed) {
+      table->is_signed_ = false;
+    }
+    table->values_.emplace(name, unsigned_value);
+  }
+  return registry.Add(key, type, std::move(table));
+}
+
+bool EnumTable::Find(llvm::StringRef name, uint64_t* value) const {
+  auto it = values_.find(name.str());
+  if (it == values_.end()) {
+    return false;
+  }
+  *value = it->second;
+  return true;
+}
+
+std::vector<std::pair<std::string, lldb::SBType>> FindEnumerators(
+    lldb::SBModule module, llvm::StringRef name) {
+  if (!module.IsValid()) {
+    return {};
+  }
+  std::shared_ptr<const EnumeratorIndex> index =
+      GetEnumeratorIndexRegistry().Get(module);
+  auto it = index->find(name.str());
+  if (it == index->end()) {
+    return {};
+  }
+  return it->second;
+}
+
+void PrepareEnumerators(lldb::SBModule module) {
+  if (!module.IsValid() || HasEnumeratorIndex(module)) {
+    return;
+  }
+  lldb::SBTypeList types = module.GetTypes(lldb::eTypeClassEnumeration);
+  for (uint32_t i = 0; i < types.GetSize(); ++i) {
+    EnumTable::Get(types.GetTypeAtIndex(i));
+  }
+  GetEnumeratorIndexRegistry().Get(module);
+}
+
+bool HasEnumeratorIndex(lldb::SBModule module) {
+  return module.IsValid() && GetEnumeratorIndexRegistry().Contains(module);
+}
+
+}  // namespace lldb_eval
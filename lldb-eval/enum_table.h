@@ -0,0 +1,83 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_ENUM_TABLE_H_
+#define LLDB_EVAL_ENUM_TABLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lldb/API/SBModule.h"
+#include "lldb/API/SBType.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace lldb_eval {
+
+// EnumTable maps the names of the enumerators of an enumeration type to their
+// values. The tables are built once per type from the enumerators reported by
+// LLDB and shared by all evaluations.
+class EnumTable {
+ public:
+  // Returns the table of the enumeration type, or nullptr if the type isn't an
+  // enumeration.
+  static std::shared_ptr<const EnumTable> Get(lldb::SBType type);
+
+  // Looks up the value of the enumerator by its (unqualified) name.
+  bool Find(llvm::StringRef name, uint64_t* value) const;
+
+  // Whether the underlying type is signed, i.e. the values of all enumerators
+  // fit into the signed integer of the size of the type.
+  bool is_signed() const { return is_signed_; }
+  // Whether some enumerator is negative. The compilers make the enumerations
+  // without a fixed underlying type and without negative enumerators unsigned,
+  // e.g. their bit fields aren't sign-extended.
+  bool has_negative_values() const { return has_negative_values_; }
+  uint64_t byte_size() const { return byte_size_; }
+
+ private:
+  EnumTable() = default;
+
+  std::unordered_map<std::string, uint64_t> values_;
+  bool is_signed_ = true;
+  bool has_negative_values_ = false;
+  uint64_t byte_size_ = 0;
+};
+
+// Returns the enumerators with the given (unqualified) name among the
+// enumeration types of the module. Each one is returned with its qualified name
+// as seen from the enclosing scope of the enumeration (e.g. "ns::kRed" for
+// "enum ns::Color { kRed }"), since the enumerators of the unscoped
+// enumerations are members of that scope, and with its enumeration type.
+//
+// The enumerators of all enumeration types of the module are indexed on the
+// first lookup, the index is cached per module.
+std::vector<std::pair<std::string, lldb::SBType>> FindEnumerators(
+    lldb::SBModule module, llvm::StringRef name);
+
+// Builds the enumerator index of the module and the tables of all its
+// enumeration types ahead of the first lookup, see PrepareTarget().
+void PrepareEnumerators(lldb::SBModule module);
+
+// Checks if the enumerator index of the module is built. Never builds it.
+bool HasEnumeratorIndex(lldb::SBModule module);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_ENUM_TABLE_H_
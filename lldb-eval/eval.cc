@@ -14,14 +14,26 @@
 
 #include "lldb-eval/eval.h"
 
-#include <limits>
+#include <cstdint>
 #include <memory>
+#include <string>
 
 #include "clang/Basic/TokenKinds.h"
 #include "lldb-eval/ast.h"
+#include "lldb-eval/batch_planner.h"
+#include "lldb-eval/bitfield_layout.h"
+#include "lldb-eval/builtins.h"
+#include "lldb-eval/memory_reader.h"
+#include "lldb-eval/pointer.h"
+#include "lldb-eval/std_layout.h"
+#include "lldb-eval/std_lookup.h"
 #include "lldb-eval/value.h"
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBProcess.h"
 #include "lldb/API/SBType.h"
 #include "lldb/API/SBValue.h"
+#include "lldb/lldb-defines.h"
 #include "llvm/Support/FormatVariadic.h"
 
 namespace {
@@ -29,6 +41,10 @@ namespace {
 const char* kInvalidOperandsToBinaryExpression =
     "invalid operands to binary expression ('{0}' and '{1}')";
 
+// Arrays created by the interpreter (slices, "p@n") are read into the host
+// memory at once, so their size is limited.
+const uint64_t kMaxArraySize = 16 * 1024 * 1024;
+
 }  // namespace
 
 namespace lldb_eval {
@@ -58,10 +74,27 @@ Value Interpreter::Eval(const AstNode* tree, EvalError& error) {
 }
 
 Value Interpreter::EvalNode(const AstNode* node) {
-  // Traverse an AST pointed by the `node`.
-  node->Accept(this);
-  // If there was an error, reset the result.
-  if (error_) result_ = {};
+  SharedSubexpressions::Slot* slot = shared_ ? shared_->Find(node) : nullptr;
+  if (slot && slot->evaluated) {
+    // Already evaluated by another expression of the batch.
+    result_ = slot->value;
+    error_ = slot->error;
+  } else {
+    // Traverse an AST pointed by the `node`.
+    node->Accept(this);
+    // If there was an error, reset the result.
+    if (error_) result_ = {};
+    if (slot) {
+      slot->evaluated = true;
+      slot->value = result_;
+      slot->error = error_;
+    }
+  }
+  // Every value produced by LLDB (variables, members, dereferenced pointers,
+  // etc) passes through here, so this records everything the result depends on.
+  if (read_set_ && result_.IsSbValue()) {
+    read_set_->AddValue(result_.AsSbValue(target_));
+  }
   // Return the computed value for convenience. The caller is responsible for
   // checking if an error occured during the evaluation.
   return result_;
@@ -79,7 +112,28 @@ void Interpreter::Visit(const NumericLiteralNode* node) {
   result_ = Value(node->value());
 }
 
+void Interpreter::Visit(const StringLiteralNode* node) {
+  // The literal is an array of chars with the null terminator. It isn't in the
+  // memory of the process, lldb::SBData::SetData() copies the contents and
+  // doesn't actually use "error".
+  std::string value = node->value();
+  lldb::SBError error;
+  lldb::SBData data;
+  data.SetData(error, value.c_str(), value.size() + 1, target_.GetByteOrder(),
+               static_cast<uint8_t>(target_.GetAddressByteSize()));
+  lldb::SBType type = target_.GetBasicType(lldb::eBasicTypeChar)
+                          .GetArrayType(value.size() + 1);
+  result_ = Value(target_.CreateValueFromData("result", data, type),
+                  /* is_rvalue */ true);
+}
+
 void Interpreter::Visit(const IdentifierNode* node) {
+  auto bound = bound_variables_.find(node->name());
+  if (bound != bound_variables_.end()) {
+    result_ = bound->second;
+    return;
+  }
+
   // Internally values don't have global scope qualifier in their names and
   // LLDB doesn't support queries with it too.
   std::string name = node->name();
@@ -92,43 +146,46 @@ void Interpreter::Visit(const IdentifierNode* node) {
 
   lldb::SBValue value;
 
+  // Registers are referenced with the "$" prefix, e.g. "$rip". They are
+  // rvalues, since they don't have an address.
+  bool is_register = false;
+
   // If the identifier doesn't refer to the global scope and doesn't have any
   // other scope qualifiers, try looking among the local and instance variables.
   if (!global_scope && name.find("::") == std::string::npos) {
+    FrameSnapshot& snapshot = GetFrameSnapshot();
+
+    // Try looking for a register.
+    if (name.rfind("$", 0) == 0) {
+      value = snapshot.FindRegister(name.substr(1));
+      is_register = static_cast<bool>(value);
+    }
     // Try looking for a local variable in current scope.
     if (!value) {
-      value = frame_.FindVariable(name.c_str());
+      value = snapshot.FindVariable(name);
     }
     // Try looking for an instance variable (class member).
     if (!value) {
-      value = frame_.FindVariable("this").GetChildMemberWithName(name.c_str());
+      value = snapshot.FindInstanceVariable(name);
     }
   }
 
-  // Try looking for a global or static variable.
+  // Try looking for a global or static variable. Relative names are resolved
+  // relative to the scope of the current function.
   if (!value) {
-    // TODO(werat): Implement scope-aware lookup. Relative scopes should be
-    // resolved relative to the current scope. I.e. if the current frame is in
-    // "ns1::ns2::Foo()", then "ns2::x" should resolve to "ns1::ns2::x".
-
-    // List global variable with the same "basename". There can be many matches
-    // from other scopes (namespaces, classes), so we do additional filtering
-    // later.
-    lldb::SBValueList values = target_.FindGlobalVariables(
-        name.c_str(), /*max_matches=*/std::numeric_limits<uint32_t>::max());
-
-    // Find the corrent variable by matching the name. lldb::SBValue::GetName()
-    // can return strings like "::globarVar", "ns::i" or "int const ns::foo"
-    // depending on the version and the platform.
-    for (uint32_t i = 0; i < values.GetSize(); ++i) {
-      lldb::SBValue val = values.GetValueAtIndex(i);
-      llvm::StringRef val_name = val.GetName();
-
-      if (val_name == name || val_name == "::" + name ||
-          val_name.endswith(" " + name)) {
-        value = val;
-        break;
-      }
+    value = expr_ctx_->GetScopeResolver().ResolveVariable(node->name());
+  }
+
+  // Try looking for an enumerator, e.g. "kRed" or "Color::kRed". The
+  // enumerators are resolved once per function and looked up in the cached
+  // tables of the enumerations.
+  if (!value) {
+    lldb::SBType enum_type;
+    uint64_t enumerator;
+    if (expr_ctx_->GetScopeResolver().ResolveEnumerator(
+            node->name(), &enum_type, &enumerator)) {
+      result_ = CastScalarToEnumType(Scalar(enumerator), enum_type, target_);
+      return;
     }
   }
 
@@ -139,7 +196,7 @@ void Interpreter::Visit(const IdentifierNode* node) {
   }
 
   // Special case for "this" pointer. As per C++ standard, it's a prvalue.
-  bool is_rvalue = node->name() == "this";
+  bool is_rvalue = node->name() == "this" || is_register;
 
   result_ = Value(value, is_rvalue);
 }
@@ -191,6 +248,28 @@ void Interpreter::Visit(const CStyleCastNode* node) {
   if (!rhs) {
     return;
   }
+  if (!CheckLongDouble(rhs) || !CheckLongDouble(type)) {
+    return;
+  }
+
+  // Cast to enumeration type.
+  if (type.GetCanonicalType().GetTypeClass() == lldb::eTypeClassEnumeration) {
+    if (!rhs.IsScalar()) {
+      std::string type_name = type.GetName();
+      std::string msg = "cannot convert '{0}' to '" + type_name +
+                        "' without a conversion operator";
+      ReportTypeError(msg.c_str(), rhs);
+      return;
+    }
+    result_ = CastScalarToEnumType(rhs.AsScalar(), type, target_);
+    if (!result_) {
+      std::string msg =
+          llvm::formatv("casting '{0}' to '{1}' invalid",
+                        rhs.AsSbValue(target_).GetTypeName(), type.GetName());
+      error_.Set(EvalErrorCode::UNKNOWN, msg);
+    }
+    return;
+  }
 
   // Cast to basic type (integer/float).
   if (type.GetCanonicalType().GetTypeFlags() & lldb::eTypeIsScalar) {
@@ -282,6 +361,9 @@ void Interpreter::Visit(const MemberOfNode* node) {
     case MemberOfNode::Type::OF_POINTER:
       // "member of pointer" operator, check that LHS is a pointer and
       // dereference it.
+      if (DereferenceSmartPointer(lhs_val, &lhs_val)) {
+        break;
+      }
       if (!lhs_val.GetType().IsPointerType()) {
         ReportTypeError(
             "member reference type '{0}' is not a pointer; "
@@ -302,6 +384,12 @@ void Interpreter::Visit(const MemberOfNode* node) {
     return;
   }
 
+  // The bit fields are extracted natively, without creating the children of
+  // the object in LLDB.
+  if (ReadBitfield(lhs_val, node->member_id()->name(), &result_)) {
+    return;
+  }
+
   lldb::SBValue member_val =
       lhs_val.GetChildMemberWithName(node->member_id()->name().c_str());
 
@@ -355,6 +443,9 @@ void Interpreter::Visit(const BinaryOpNode* node) {
   if (!rhs) {
     return;
   }
+  if (!CheckLongDouble(lhs) || !CheckLongDouble(rhs)) {
+    return;
+  }
 
   switch (node->op()) {
     // "l_square" is a subscript operator -- array[index].
@@ -362,6 +453,11 @@ void Interpreter::Visit(const BinaryOpNode* node) {
       result_ = EvaluateSubscript(lhs, rhs);
       return;
 
+    // Artificial array -- object@count.
+    case clang::tok::at:
+      result_ = EvaluateArtificialArray(lhs, rhs);
+      return;
+
     // Binary addition.
     case clang::tok::plus:
       result_ = EvaluateAddition(lhs, rhs);
@@ -427,6 +523,192 @@ void Interpreter::Visit(const BinaryOpNode* node) {
       return;
     }
   }
+
+  // The remainder, the bitwise operators and the shifts aren't defined for the
+  // floating point operands.
+  if (result_.AsScalar().type_ == Scalar::Type::INVALID) {
+    ReportTypeError(kInvalidOperandsToBinaryExpression, lhs, rhs);
+  }
+}
+
+void Interpreter::Visit(const ArraySliceNode* node) {
+  auto base = EvalNode(node->base());
+  if (!base) {
+    return;
+  }
+  auto begin = EvalNode(node->begin());
+  if (!begin) {
+    return;
+  }
+  auto end = EvalNode(node->end());
+  if (!end) {
+    return;
+  }
+
+  lldb::SBValue base_val = base.AsSbValue(target_);
+  // Base can be a reference type (e.g. "int (&)[]").
+  if (base_val.GetType().IsReferenceType()) {
+    base_val = base_val.Dereference();
+  }
+  lldb::SBType base_type = base_val.GetType().GetCanonicalType();
+
+  lldb::SBType item_type;
+  lldb::addr_t base_addr;
+
+  if (base_type.IsArrayType()) {
+    item_type = base_type.GetArrayElementType();
+    base_addr = base_val.GetLoadAddress();
+    if (base_addr == LLDB_INVALID_ADDRESS) {
+      ReportTypeError("sliced array is not in memory");
+      return;
+    }
+  } else if (base_type.IsPointerType()) {
+    item_type = base_type.GetPointeeType();
+    base_addr = static_cast<lldb::addr_t>(base_val.GetValueAsUnsigned());
+  } else {
+    ReportTypeError("sliced value is not an array or pointer");
+    return;
+  }
+
+  int64_t begin_index, end_index;
+  if (!GetIndex(begin, "slice bound is not an integer", &begin_index) ||
+      !GetIndex(end, "slice bound is not an integer", &end_index)) {
+    return;
+  }
+  if (end_index <= begin_index) {
+    error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+               llvm::formatv("slice [{0}:{1}] is empty", begin_index,
+                             end_index));
+    return;
+  }
+
+  lldb::addr_t address = Pointer(base_addr, item_type.GetPointerType())
+                             .Add(begin_index)
+                             .addr();
+  result_ = CreateArrayFromMemory(item_type, address,
+                                  static_cast<uint64_t>(end_index) -
+                                      static_cast<uint64_t>(begin_index));
+}
+
+void Interpreter::Visit(const CallNode* node) {
+  const Builtin* builtin = FindBuiltin(node->name());
+  if (!builtin) {
+    std::string msg = "use of undeclared identifier '" + node->name() + "'";
+    error_.Set(EvalErrorCode::UNDECLARED_IDENTIFIER, msg);
+    return;
+  }
+
+  size_t num_args = node->num_args();
+  if (num_args < builtin->min_args || num_args > builtin->max_args) {
+    std::string expected =
+        builtin->min_args == builtin->max_args
+            ? std::to_string(builtin->min_args)
+            : llvm::formatv("{0} to {1}", builtin->min_args, builtin->max_args)
+                  .str();
+    error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+               llvm::formatv("'{0}' expects {1} arguments, {2} given",
+                             node->name(), expected, num_args));
+    return;
+  }
+
+  BuiltinCall call;
+  call.expr_ctx = expr_ctx_;
+  call.target = target_;
+  call.read_set = read_set_;
+  call.bound_variables = bound_variables_;
+
+  // The lambdas are evaluated by the builtin, once per element.
+  for (size_t i = 0; i < num_args; ++i) {
+    if (builtin->IsLambda(i)) {
+      call.args.push_back(Value());
+      call.lambdas.push_back(node->arg(i));
+      continue;
+    }
+    auto arg = EvalNode(node->arg(i));
+    if (!arg) {
+      return;
+    }
+    call.args.push_back(arg);
+    call.lambdas.push_back(nullptr);
+  }
+
+  result_ = builtin->function(call, error_);
+}
+
+void Interpreter::Visit(const MethodCallNode* node) {
+  auto object = EvalNode(node->object());
+  if (!object) {
+    return;
+  }
+
+  lldb::SBValue object_val = object.AsSbValue(target_);
+  if (object_val.GetType().IsReferenceType()) {
+    object_val = object_val.Dereference();
+  }
+  if (node->type() == MemberOfNode::Type::OF_POINTER) {
+    if (object_val.GetType().IsPointerType()) {
+      object_val = object_val.Dereference();
+    } else if (!DereferenceSmartPointer(object_val, &object_val)) {
+      ReportTypeError(
+          "member reference type '{0}' is not a pointer; "
+          "did you mean to use '.'?",
+          object);
+      return;
+    }
+  }
+
+  // Only the member functions of the standard library classes, which can be
+  // evaluated without running code in the process, are supported.
+  std::string type_name = object_val.GetType().GetUnqualifiedType().GetName();
+  StdObject std_object;
+  if (!DecodeStdObject(object_val, &std_object)) {
+    error_.Set(EvalErrorCode::NOT_IMPLEMENTED,
+               llvm::formatv("calling member functions of '{0}' is not "
+                             "supported",
+                             type_name));
+    return;
+  }
+
+  // The lookups in the associative containers take the key, the other member
+  // functions take no arguments.
+  std::string name = node->name();
+  bool is_lookup = std_object.IsAssociative() &&
+                   (name == "find" || name == "count" || name == "contains");
+  if (is_lookup && node->num_args() != 1) {
+    error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+               llvm::formatv("'{0}' expects 1 argument, {1} given", name,
+                             node->num_args()));
+    return;
+  }
+  if (!is_lookup && node->num_args() != 0) {
+    error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+               llvm::formatv("'{0}' expects no arguments, {1} given", name,
+                             node->num_args()));
+    return;
+  }
+
+  bool is_container = !std_object.IsSmartPointer();
+  bool is_sequence = is_container && !std_object.IsAssociative();
+  if (is_lookup) {
+    auto key = EvalNode(node->arg(0));
+    if (!key) {
+      return;
+    }
+    result_ = EvaluateStdLookup(std_object, name, key);
+  } else if ((is_container && name == "size") ||
+             (std_object.IsString() && name == "length")) {
+    result_ = Value(Scalar(static_cast<uint64_t>(std_object.size)));
+  } else if (is_container && name == "empty") {
+    result_ = Value(std_object.size == 0);
+  } else if ((is_sequence && name == "data") ||
+             (!is_container && name == "get")) {
+    result_ = Value(
+        Pointer(std_object.data, std_object.element_type.GetPointerType()));
+  } else {
+    error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+               llvm::formatv("no member function named '{0}' in '{1}'", name,
+                             type_name));
+  }
 }
 
 void Interpreter::Visit(const UnaryOpNode* node) {
@@ -440,6 +722,11 @@ void Interpreter::Visit(const UnaryOpNode* node) {
     lldb::SBValue rhs_val = rhs.AsSbValue(target_);
 
     if (!rhs.IsPointer()) {
+      lldb::SBValue pointee;
+      if (DereferenceSmartPointer(rhs_val, &pointee)) {
+        result_ = Value(pointee);
+        return;
+      }
       // TODO(werat): Add literal value to the error message.
       ReportTypeError("indirection requires pointer operand. ('{0}' invalid)",
                       rhs);
@@ -464,6 +751,11 @@ void Interpreter::Visit(const UnaryOpNode* node) {
     return;
   }
 
+  // The other operators read the value of the operand.
+  if (!CheckLongDouble(rhs)) {
+    return;
+  }
+
   // Unary plus.
   if (node->op() == clang::tok::plus) {
     if (rhs.IsPointer()) {
@@ -499,7 +791,8 @@ void Interpreter::Visit(const UnaryOpNode* node) {
 
   // Bitwise NOT (~).
   if (node->op() == clang::tok::tilde) {
-    if (rhs.IsScalar()) {
+    // "~" isn't defined for the floating point operands.
+    if (rhs.IsScalar() && (~rhs.AsScalar()).type_ != Scalar::Type::INVALID) {
       result_ = Value(~rhs.AsScalar());
       return;
     }
@@ -547,6 +840,11 @@ Value Interpreter::EvaluateSubscript(Value& lhs, Value& rhs) {
     base = rhs_val;
     index = lhs_val;
   } else {
+    // The standard containers, e.g. "v[i]" of "std::vector<T> v".
+    StdObject object;
+    if (DecodeStdObject(lhs_val, &object) && !object.IsSmartPointer()) {
+      return EvaluateStdSubscript(object, lhs_type, rhs);
+    }
     ReportTypeError("subscripted value is not an array or pointer");
     return Value();
   }
@@ -592,6 +890,109 @@ Value Interpreter::EvaluateSubscript(Value& lhs, Value& rhs) {
   return Value(pointer.AsSbValue(target_).Dereference());
 }
 
+Value Interpreter::EvaluateStdSubscript(const StdObject& object,
+                                        lldb::SBType type, Value& index) {
+  if (object.IsAssociative()) {
+    // Unlike operator[] of the maps, the missing keys aren't inserted.
+    if (!object.IsMap()) {
+      error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                 llvm::formatv("type '{0}' does not provide a subscript "
+                               "operator",
+                               type.GetUnqualifiedType().GetName()));
+      return Value();
+    }
+    lldb::addr_t element;
+    if (!FindStdElement(object, index, &element)) {
+      return Value();
+    }
+    if (element == 0) {
+      error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                 llvm::formatv("key is not found in '{0}'",
+                               type.GetUnqualifiedType().GetName()));
+      return Value();
+    }
+    lldb::SBType element_type = object.element_type;
+    auto pointer = Value(Pointer(element, element_type.GetPointerType()));
+    return Value(
+        pointer.AsSbValue(target_).Dereference().GetChildMemberWithName(
+            "second"));
+  }
+
+  int64_t i;
+  if (!GetIndex(index, "array subscript is not an integer", &i)) {
+    return Value();
+  }
+  // Unlike operator[] of the containers, the index is checked. The memory out
+  // of the bounds isn't worth reading.
+  if (i < 0 || static_cast<uint64_t>(i) >= object.size) {
+    error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+               llvm::formatv("index {0} is out of range of '{1}' of size {2}",
+                             i, type.GetUnqualifiedType().GetName(),
+                             object.size));
+    return Value();
+  }
+
+  lldb::SBType element_type = object.element_type;
+  auto pointer =
+      Value(Pointer(object.data, element_type.GetPointerType()).Add(i));
+  return Value(pointer.AsSbValue(target_).Dereference());
+}
+
+Value Interpreter::EvaluateStdLookup(const StdObject& object,
+                                     const std::string& method, Value& key) {
+  lldb::addr_t element;
+  if (!FindStdElement(object, key, &element)) {
+    return Value();
+  }
+  // "find" returns the pointer to the element rather than the iterator, the
+  // iterators of the containers can't be created without running the code of
+  // the process.
+  if (method == "find") {
+    lldb::SBType element_type = object.element_type;
+    return Value(Pointer(element, element_type.GetPointerType()));
+  }
+  if (method == "count") {
+    return Value(Scalar(static_cast<uint64_t>(element != 0)));
+  }
+  return Value(element != 0);
+}
+
+bool Interpreter::FindStdElement(const StdObject& object, Value& key,
+                                 lldb::addr_t* element) {
+  StdKey std_key;
+  return MakeStdKey(target_, object, key.AsSbValue(target_), read_set_,
+                    &std_key, error_) &&
+         FindStdKey(target_, object, std_key, read_set_, element, error_);
+}
+
+Value Interpreter::EvaluateArtificialArray(Value& lhs, Value& rhs) {
+  lldb::SBValue lhs_val = lhs.AsSbValue(target_);
+  if (lhs_val.GetType().IsReferenceType()) {
+    lhs_val = lhs_val.Dereference();
+  }
+
+  // The values computed by the interpreter don't have an address.
+  lldb::addr_t address =
+      lhs.IsSbValue() ? lhs_val.GetLoadAddress() : LLDB_INVALID_ADDRESS;
+  if (address == LLDB_INVALID_ADDRESS) {
+    ReportTypeError("only values in memory can be extended with '@'");
+    return Value();
+  }
+
+  int64_t count;
+  if (!GetIndex(rhs, "repetition count is not an integer", &count)) {
+    return Value();
+  }
+  if (count <= 0) {
+    error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+               llvm::formatv("invalid number {0} of repetitions", count));
+    return Value();
+  }
+
+  return CreateArrayFromMemory(lhs_val.GetType(), address,
+                               static_cast<uint64_t>(count));
+}
+
 Value Interpreter::EvaluateAddition(Value& lhs, Value& rhs) {
   // Operation '+' works for:
   //
@@ -757,6 +1158,9 @@ Value Interpreter::EvaluateComparison(Value& lhs, Value& rhs,
 }
 
 bool Interpreter::BoolConvertible(Value& val) {
+  if (!CheckLongDouble(val)) {
+    return false;
+  }
   if (val.IsScalar() || val.IsPointer()) {
     return true;
   }
@@ -766,6 +1170,159 @@ bool Interpreter::BoolConvertible(Value& val) {
   return false;
 }
 
+bool Interpreter::CheckLongDouble(const Value& val) {
+  // The values computed by the interpreter have been checked when their
+  // operands were read.
+  return !val.IsSbValue() || CheckLongDouble(val.AsSbValue(target_).GetType());
+}
+
+bool Interpreter::CheckLongDouble(lldb::SBType type) {
+  type = type.GetCanonicalType();
+  if (type.GetBasicType() != lldb::eBasicTypeLongDouble ||
+      IsHostLongDoubleFormat(target_, type.GetByteSize())) {
+    return true;
+  }
+  const char* triple = target_.GetTriple();
+  error_.Set(EvalErrorCode::NOT_IMPLEMENTED,
+             llvm::formatv("'long double' of the target '{0}' has a different "
+                           "format than on the host",
+                           triple ? triple : ""));
+  return false;
+}
+
+bool Interpreter::DereferenceSmartPointer(lldb::SBValue value,
+                                          lldb::SBValue* result) {
+  StdObject object;
+  if (!DecodeStdObject(value, &object) || !object.IsSmartPointer()) {
+    return false;
+  }
+  auto pointer =
+      Value(Pointer(object.data, object.element_type.GetPointerType()));
+  *result = pointer.AsSbValue(target_).Dereference();
+  return true;
+}
+
+FrameSnapshot& Interpreter::GetFrameSnapshot() {
+  if (!frame_snapshot_) {
+    frame_snapshot_ = FrameSnapshot::Get(frame_);
+  }
+  return *frame_snapshot_;
+}
+
+bool Interpreter::GetIndex(Value& val, const char* error_msg,
+                           int64_t* index) {
+  lldb::SBValue index_val = val.AsSbValue(target_);
+  if (index_val.GetType().IsReferenceType()) {
+    index_val = index_val.Dereference();
+  }
+
+  lldb::SBType index_type = index_val.GetType().GetCanonicalType();
+  if (index_type.GetBasicType() < lldb::eBasicTypeChar ||
+      index_type.GetBasicType() > lldb::eBasicTypeBool) {
+    ReportTypeError(error_msg);
+    return false;
+  }
+
+  *index = index_val.GetValueAsSigned();
+  return true;
+}
+
+Value Interpreter::CreateArrayFromMemory(lldb::SBType item_type,
+                                         lldb::addr_t address,
+                                         uint64_t count) {
+  uint64_t item_size = item_type.GetByteSize();
+  if (item_size == 0) {
+    ReportTypeError("array elements must have a complete type");
+    return Value();
+  }
+  if (count > kMaxArraySize / item_size) {
+    error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+               llvm::formatv("array of {0} elements is too large", count));
+    return Value();
+  }
+
+  size_t size = static_cast<size_t>(count * item_size);
+  std::string contents(size, '\0');
+  lldb::SBError read_error;
+  size_t read = target_.GetProcess().ReadMemory(address, &contents[0], size,
+                                                read_error);
+  if (read_error.Fail() || read != size) {
+    error_.Set(EvalErrorCode::UNKNOWN,
+               llvm::formatv("can't read memory at 0x{0:x}", address));
+    return Value();
+  }
+  if (read_set_) {
+    read_set_->AddMemory(address, size);
+  }
+
+  // The elements are decoded by the host, lldb::SBData::SetData() copies the
+  // contents and doesn't actually use "error".
+  lldb::SBData data;
+  data.SetData(read_error, contents.data(), size, target_.GetByteOrder(),
+               static_cast<uint8_t>(target_.GetAddressByteSize()));
+  return Value(target_.CreateValueFromData("result", data,
+                                           item_type.GetArrayType(count)),
+               /* is_rvalue */ true);
+}
+
+bool Interpreter::ReadBitfield(lldb::SBValue object, const std::string& name,
+                               Value* result) {
+  if (object.GetType().IsReferenceType()) {
+    object = object.Dereference();
+  }
+  BitfieldLayout layout;
+  if (!GetBitfieldLayout(object.GetType(), name, &layout)) {
+    return false;
+  }
+  uint64_t size = layout.type.GetByteSize();
+  if (size == 0 || size > sizeof(uint64_t)) {
+    return false;
+  }
+
+  // Only the storage unit containing the bits is read. Unlike the layout the
+  // contents aren't cached, the bit field could have been written since the
+  // previous read.
+  std::string bytes;
+  lldb::addr_t address = object.GetLoadAddress();
+  if (address != LLDB_INVALID_ADDRESS) {
+    MemoryReader reader(target_.GetProcess(), read_set_);
+    if (!reader.ReadBlock(address + layout.first_byte(), layout.byte_size(),
+                          &bytes)) {
+      return false;
+    }
+  } else {
+    // The object isn't in the memory of the process (e.g. a result of the
+    // builtin), the bits are taken from its contents.
+    bytes.resize(layout.byte_size());
+    lldb::SBError error;
+    size_t read = object.GetData().ReadRawData(error, layout.first_byte(),
+                                               &bytes[0], bytes.size());
+    if (error.Fail() || read != bytes.size()) {
+      return false;
+    }
+  }
+
+  uint64_t bits;
+  lldb::ByteOrder byte_order = target_.GetByteOrder();
+  if (!ExtractBitfield(layout, bytes, byte_order, &bits)) {
+    return false;
+  }
+
+  // Encode the value as an object of the declared type of the member.
+  std::string contents(size, '\0');
+  for (uint64_t i = 0; i < size; ++i) {
+    uint64_t index = byte_order == lldb::eByteOrderBig ? size - 1 - i : i;
+    contents[index] = static_cast<char>((bits >> (8 * i)) & 0xff);
+  }
+  lldb::SBError error;
+  lldb::SBData data;
+  data.SetData(error, contents.data(), contents.size(), byte_order,
+               static_cast<uint8_t>(target_.GetAddressByteSize()));
+  *result = Value(target_.CreateValueFromData(name.c_str(), data, layout.type),
+                  /* is_rvalue */ true);
+  return true;
+}
+
 void Interpreter::ReportTypeError(const char* fmt) {
   error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE, fmt);
 }
@@ -17,10 +17,17 @@
 #ifndef LLDB_EVAL_EVAL_H_
 #define LLDB_EVAL_EVAL_H_
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+
 #include "clang/Basic/TokenKinds.h"
 #include "expression_context.h"
 #include "lldb-eval/ast.h"
 #include "lldb-eval/defines.h"
+#include "lldb-eval/frame_snapshot.h"
+#include "lldb-eval/read_set.h"
+#include "lldb-eval/std_layout.h"
 #include "lldb-eval/value.h"
 #include "lldb/API/SBFrame.h"
 #include "lldb/API/SBProcess.h"
@@ -56,9 +63,12 @@ class EvalError {
   std::string message_;
 };
 
+class SharedSubexpressions;
+
 class Interpreter : Visitor {
  public:
-  explicit Interpreter(ExpressionContext& expr_ctx) : expr_ctx_(&expr_ctx) {
+  explicit Interpreter(ExpressionContext& expr_ctx)
+      : expr_ctx_(&expr_ctx), read_set_(nullptr), shared_(nullptr) {
     target_ = expr_ctx_->GetExecutionContext().GetTarget();
     frame_ = expr_ctx_->GetExecutionContext().GetFrame();
   }
@@ -66,6 +76,22 @@ class Interpreter : Visitor {
  public:
   Value Eval(const AstNode* tree, EvalError& error);
 
+  // Records the values read during the evaluation into the given read set. The
+  // interpreter doesn't own the read set.
+  void SetReadSet(ReadSet* read_set) { read_set_ = read_set; }
+
+  // Reuses the results of the subexpressions already evaluated by other
+  // expressions of the batch. The interpreter doesn't own the results.
+  void SetSharedSubexpressions(SharedSubexpressions* shared) {
+    shared_ = shared;
+  }
+
+  // Binds the identifier to the value, the binding shadows the variables with
+  // the same name. E.g. binds the index of a range evaluation.
+  void BindVariable(const std::string& name, Value value) {
+    bound_variables_[name] = value;
+  }
+
  private:
   void Visit(const ErrorNode* node) override;
 
@@ -73,6 +99,8 @@ class Interpreter : Visitor {
 
   void Visit(const NumericLiteralNode* node) override;
 
+  void Visit(const StringLiteralNode* node) override;
+
   void Visit(const IdentifierNode* node) override;
 
   void Visit(const CStyleCastNode* node) override;
@@ -81,6 +109,12 @@ class Interpreter : Visitor {
 
   void Visit(const BinaryOpNode* node) override;
 
+  void Visit(const ArraySliceNode* node) override;
+
+  void Visit(const CallNode* node) override;
+
+  void Visit(const MethodCallNode* node) override;
+
   void Visit(const UnaryOpNode* node) override;
 
   void Visit(const TernaryOpNode* node) override;
@@ -89,12 +123,47 @@ class Interpreter : Visitor {
   Value EvalNode(const AstNode* node);
 
   Value EvaluateSubscript(Value& lhs, Value& rhs);
+  Value EvaluateStdSubscript(const StdObject& object, lldb::SBType type,
+                             Value& index);
+  Value EvaluateStdLookup(const StdObject& object, const std::string& method,
+                          Value& key);
+
+  // Looks up the key in the associative container, see FindStdKey(). Sets the
+  // address of the element, or 0 if there is no such element.
+  bool FindStdElement(const StdObject& object, Value& key,
+                      lldb::addr_t* element);
+  Value EvaluateArtificialArray(Value& lhs, Value& rhs);
   Value EvaluateAddition(Value& lhs, Value& rhs);
   Value EvaluateSubtraction(Value& lhs, Value& rhs);
   Value EvaluateComparison(Value& lhs, Value& rhs, clang::tok::TokenKind op);
 
   bool BoolConvertible(Value& val);
 
+  // Reports an error if the value (or the type) is a "long double" whose format
+  // differs from the host's one, see IsHostLongDoubleFormat().
+  bool CheckLongDouble(const Value& val);
+  bool CheckLongDouble(lldb::SBType type);
+
+  // Dereferences the standard smart pointers, e.g. "*p" of "std::unique_ptr".
+  // Returns false if the value isn't a smart pointer.
+  bool DereferenceSmartPointer(lldb::SBValue value, lldb::SBValue* result);
+
+  // Reads the value of an integral index (e.g. a slice bound). Reports an
+  // error with the given message if the value is not an integer.
+  bool GetIndex(Value& val, const char* error_msg, int64_t* index);
+
+  // Creates an array of the objects at the given address. The contents are
+  // read from the process with a single request.
+  Value CreateArrayFromMemory(lldb::SBType item_type, lldb::addr_t address,
+                              uint64_t count);
+
+  // Reads the bit field member of the object, see GetBitfieldLayout(). Returns
+  // false if the member isn't a bit field or can't be extracted natively.
+  bool ReadBitfield(lldb::SBValue object, const std::string& name,
+                    Value* result);
+
+  FrameSnapshot& GetFrameSnapshot();
+
   void ReportTypeError(const char* fmr);
   void ReportTypeError(const char* fmt, const Value& val);
   void ReportTypeError(const char* fmt, const Value& lhs, const Value& rhs);
@@ -109,6 +178,18 @@ class Interpreter : Visitor {
   lldb::SBTarget target_;
   lldb::SBFrame frame_;
 
+  // Variables visible in the current frame. Obtained lazily on the first
+  // identifier lookup and shared with other evaluations in the same stop.
+  std::shared_ptr<FrameSnapshot> frame_snapshot_;
+
+  // Optional, collects the values the result depends on.
+  ReadSet* read_set_;
+
+  // Optional, results of the subexpressions shared within a batch.
+  SharedSubexpressions* shared_;
+
+  std::unordered_map<std::string, Value> bound_variables_;
+
   Value result_;
   EvalError error_;
 };
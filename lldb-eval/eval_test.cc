@@ -14,17 +14,31 @@
 
 #include "lldb-eval/eval.h"
 
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "lldb-eval/api.h"
 #include "lldb-eval/ast.h"
+#include "lldb-eval/batch_planner.h"
+#include "lldb-eval/compiled_expression.h"
+#include "lldb-eval/enum_table.h"
 #include "lldb-eval/expression_context.h"
+#include "lldb-eval/memory_reader.h"
+#include "lldb-eval/module_index.h"
 #include "lldb-eval/parser.h"
 #include "lldb-eval/runner.h"
+#include "lldb-eval/scope_resolver.h"
 #include "lldb-eval/value.h"
 #include "lldb/API/SBDebugger.h"
+#include "lldb/API/SBError.h"
 #include "lldb/API/SBExecutionContext.h"
 #include "lldb/API/SBFrame.h"
+#include "lldb/API/SBModule.h"
 #include "lldb/API/SBProcess.h"
 #include "lldb/API/SBTarget.h"
 #include "lldb/API/SBThread.h"
@@ -45,6 +59,12 @@ class InterpreterTest : public ::testing::Test {
   static void SetUpTestSuite() {
     runfiles_ = Runfiles::CreateForTest();
     lldb_eval::SetupLLDBServerEnv(*runfiles_);
+    // Keep the indexes built by the tests out of the user's cache directory.
+#ifndef _WIN32
+    setenv("LLDB_EVAL_INDEX_CACHE", ::testing::TempDir().c_str(), 1);
+#else
+    _putenv_s("LLDB_EVAL_INDEX_CACHE", ::testing::TempDir().c_str());
+#endif  // !_WIN32
     lldb::SBDebugger::Initialize();
   }
 
@@ -374,6 +394,37 @@ TEST_F(InterpreterTest, TestLocalVariables) {
               "use of undeclared identifier '__test_non_variable'");
 }
 
+TEST_F(InterpreterTest, TestVariableShadowing) {
+  TestExpr("a", "3");
+  TestExpr("b", "4");
+  TestExpr("a + b", "7");
+  // Repeated lookups are served from the same frame snapshot.
+  TestExpr("a + a + b + b", "14");
+}
+
+TEST_F(InterpreterTest, TestStaticShadowing) {
+  // The local shadows the static variable of the compile unit.
+  TestExpr("shadowed_static", "2");
+  TestExpr("shadowed_static + outer", "3");
+  // The static of the inner block shadows the local of the function.
+  TestExpr("counter", "20");
+  TestExpr("counter + shadowed_static", "22");
+}
+
+TEST_F(InterpreterTest, TestRegisters) {
+  // Register names are architecture specific, the test binary is built for
+  // the host.
+#if defined(__x86_64__) || defined(_M_X64)
+  TestExprOnlyCompare("(unsigned long long)$rip");
+  TestExprOnlyCompare("(unsigned long long)$rsp");
+  TestExpr("$rsp == $rsp", "true");
+  TestExprErr("&$rsp", "cannot take the address of an rvalue");
+#endif
+
+  TestExprErr("$__not_a_register",
+              "use of undeclared identifier '$__not_a_register'");
+}
+
 TEST_F(InterpreterTest, TestInstanceVariables) {
   TestExpr("this->field_", "1");
   TestExprErr("this.field_",
@@ -627,4 +678,980 @@ TEST_F(InterpreterTest, TestTemplateTypes) {
   TestExpr("(::T_2<T_1<T_1<int> >, T_1<char> >::myint)1.1", "1.10000002");
 }
 
+TEST_F(InterpreterTest, TestScopedLookup) {
+  // Names are resolved relative to "scope_ns::inner", the innermost scope wins.
+  TestExpr("x", "2");
+  TestExpr("inner::x", "2");
+  TestExpr("scope_ns::x", "1");
+  TestExpr("::scope_ns::x", "1");
+  TestExpr("::scope_ns::inner::x", "2");
+  TestExpr("x + scope_ns::x", "3");
+
+  TestExpr("(mytype)1.5", "1.5");
+  TestExpr("(inner::mytype)1.5", "1.5");
+  TestExpr("(scope_ns::mytype)1.5", "1");
+  TestExpr("(::scope_ns::mytype)1.5", "1");
+
+  TestExprErr("::x", "use of undeclared identifier '::x'");
+}
+
+TEST_F(InterpreterTest, TestModuleIndex) {
+  lldb::SBModule module = frame_.GetModule();
+  auto index = lldb_eval::ModuleIndex::Build(module);
+  ASSERT_TRUE(index);
+
+  EXPECT_TRUE(index->MayContainType("mytype"));
+  EXPECT_TRUE(index->MayContainType("scope_ns::inner::mytype"));
+  EXPECT_TRUE(index->MayContainType("T_1<int>"));
+  EXPECT_TRUE(index->MayContainType("ns::T_1<ns::T_1<int> >::myint"));
+  EXPECT_FALSE(index->MayContainType("__not_a_type"));
+
+  EXPECT_TRUE(index->MayContainGlobalVariable("scope_ns::x"));
+  EXPECT_TRUE(index->MayContainGlobalVariable("T_1<int>::cx"));
+  EXPECT_FALSE(index->MayContainGlobalVariable("__not_a_variable"));
+
+  // Indexes are invalidated by the UUID mismatch.
+  std::string path = ::testing::TempDir() + "test_binary.idx";
+  ASSERT_TRUE(index->Save(path));
+  auto loaded = lldb_eval::ModuleIndex::Load(path, index->uuid());
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->data(), index->data());
+  EXPECT_FALSE(lldb_eval::ModuleIndex::Load(path, "not-a-uuid"));
+}
+
+TEST_F(InterpreterTest, TestPrepareTarget) {
+  std::atomic<uint32_t> num_callbacks(0);
+  lldb_eval::PrepareTargetOptions options;
+  options.progress_callback = [&num_callbacks](uint32_t, uint32_t) {
+    ++num_callbacks;
+  };
+
+  // The indexes are built in the temporary directory, see SetUpTestSuite().
+  auto preparation = lldb_eval::PrepareTarget(process_.GetTarget(), options);
+  preparation->Wait();
+
+  EXPECT_TRUE(preparation->IsDone());
+  EXPECT_GT(preparation->GetNumModules(), 0u);
+  EXPECT_EQ(preparation->GetNumIndexedModules(), preparation->GetNumModules());
+  EXPECT_EQ(num_callbacks.load(), preparation->GetNumModules());
+
+  // The enumerators of all modules are indexed too.
+  lldb::SBTarget target = process_.GetTarget();
+  for (uint32_t i = 0; i < target.GetNumModules(); ++i) {
+    EXPECT_TRUE(lldb_eval::HasEnumeratorIndex(target.GetModuleAtIndex(i)));
+  }
+
+  TestExpr("x", "2");
+  TestExpr("scope_ns::x", "1");
+  TestExpr("kBlue", "kBlue");
+}
+
+TEST_F(InterpreterTest, TestResultCache) {
+  lldb_eval::InvalidateResultCache();
+  lldb_eval::ResultCacheStats before = lldb_eval::GetResultCacheStats();
+
+  // The results aren't cached by default.
+  lldb::SBError error;
+  lldb::SBValue value = lldb_eval::EvaluateExpression(frame_, "a + b", error);
+  EXPECT_TRUE(error.Success());
+  EXPECT_STREQ(value.GetValue(), "7");
+  EXPECT_EQ(lldb_eval::GetResultCacheStats().misses, before.misses);
+  EXPECT_EQ(lldb_eval::GetResultCacheStats().size, 0u);
+
+  lldb_eval::EvaluateOptions options;
+  options.use_result_cache = true;
+  value = lldb_eval::EvaluateExpression(frame_, "a + b", error, options);
+  EXPECT_TRUE(error.Success());
+  EXPECT_STREQ(value.GetValue(), "7");
+
+  // Same expression, different whitespace.
+  value = lldb_eval::EvaluateExpression(frame_, "a+b", error, options);
+  EXPECT_TRUE(error.Success());
+  EXPECT_STREQ(value.GetValue(), "7");
+
+  // Errors are cached too.
+  lldb_eval::EvaluateExpression(frame_, "a + undeclared", error, options);
+  lldb_eval::EvaluateExpression(frame_, "a + undeclared", error, options);
+  EXPECT_TRUE(error.Fail());
+  EXPECT_STREQ(error.GetCString(),
+               "use of undeclared identifier 'undeclared'");
+
+  lldb_eval::ResultCacheStats after = lldb_eval::GetResultCacheStats();
+  EXPECT_EQ(after.hits - before.hits, 2u);
+  EXPECT_EQ(after.misses - before.misses, 2u);
+  EXPECT_EQ(after.size, 2u);
+
+  lldb_eval::InvalidateResultCache();
+  EXPECT_EQ(lldb_eval::GetResultCacheStats().size, 0u);
+
+  value = lldb_eval::EvaluateExpression(frame_, "a + b", error, options);
+  EXPECT_STREQ(value.GetValue(), "7");
+  EXPECT_EQ(lldb_eval::GetResultCacheStats().misses - before.misses, 3u);
+
+  // The writes made through lldb-eval invalidate the results.
+  lldb::SBValue b = frame_.FindVariable("b");
+  ASSERT_TRUE(lldb_eval::SetValueFromCString(b, "5", error));
+  EXPECT_EQ(lldb_eval::GetResultCacheStats().size, 0u);
+  value = lldb_eval::EvaluateExpression(frame_, "a + b", error, options);
+  EXPECT_STREQ(value.GetValue(), "8");
+  ASSERT_TRUE(lldb_eval::SetValueFromCString(b, "4", error));
+  value = lldb_eval::EvaluateExpression(frame_, "a + b", error, options);
+  EXPECT_STREQ(value.GetValue(), "7");
+}
+
+TEST_F(InterpreterTest, TestCompiledExpression) {
+  lldb_eval::CompiledExpression expr("a + b");
+
+  lldb::SBError error;
+  lldb::SBValue value = expr.Evaluate(frame_, error);
+  EXPECT_TRUE(error.Success());
+  EXPECT_STREQ(value.GetValue(), "7");
+  EXPECT_FALSE(expr.reused());
+
+  // Nothing has changed, the previous result is reused.
+  value = expr.Evaluate(frame_, error);
+  EXPECT_TRUE(error.Success());
+  EXPECT_STREQ(value.GetValue(), "7");
+  EXPECT_TRUE(expr.reused());
+
+  // Modifying one of the operands invalidates the result.
+  lldb::SBValue b = frame_.FindVariable("b");
+  ASSERT_TRUE(b.SetValueFromCString("5"));
+
+  value = expr.Evaluate(frame_, error);
+  EXPECT_TRUE(error.Success());
+  EXPECT_STREQ(value.GetValue(), "8");
+  EXPECT_FALSE(expr.reused());
+
+  ASSERT_TRUE(b.SetValueFromCString("4"));
+
+  // Errors are reused too.
+  lldb_eval::CompiledExpression invalid("a + undeclared");
+  invalid.Evaluate(frame_, error);
+  invalid.Evaluate(frame_, error);
+  EXPECT_TRUE(invalid.reused());
+  EXPECT_TRUE(error.Fail());
+  EXPECT_STREQ(error.GetCString(),
+               "use of undeclared identifier 'undeclared'");
+}
+
+TEST_F(InterpreterTest, TestWatchSet) {
+  std::unique_ptr<lldb_eval::WatchSet> watch_set = lldb_eval::CreateWatchSet();
+  uint32_t sum = watch_set->Add("a + b");
+  uint32_t a = watch_set->Add("a");
+  uint32_t undeclared = watch_set->Add("undeclared");
+  EXPECT_EQ(watch_set->GetSize(), 3u);
+
+  std::vector<lldb_eval::WatchChange> changes = watch_set->Evaluate(frame_);
+  ASSERT_EQ(changes.size(), 3u);
+  EXPECT_EQ(changes[0].id, sum);
+  EXPECT_TRUE(changes[0].is_new);
+  EXPECT_STREQ(changes[0].value.GetValue(), "7");
+  EXPECT_EQ(changes[1].id, a);
+  EXPECT_STREQ(changes[1].value.GetValue(), "3");
+  EXPECT_EQ(changes[2].id, undeclared);
+  EXPECT_TRUE(changes[2].error.Fail());
+
+  // Nothing has changed.
+  EXPECT_TRUE(watch_set->Evaluate(frame_).empty());
+
+  lldb::SBValue b = frame_.FindVariable("b");
+  ASSERT_TRUE(b.SetValueFromCString("5"));
+
+  changes = watch_set->Evaluate(frame_);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].id, sum);
+  EXPECT_FALSE(changes[0].is_new);
+  EXPECT_STREQ(changes[0].value.GetValue(), "8");
+  EXPECT_TRUE(changes[0].previous.success);
+  EXPECT_EQ(changes[0].previous.value, "7");
+  EXPECT_EQ(changes[0].previous.type, "int");
+
+  ASSERT_TRUE(b.SetValueFromCString("4"));
+
+  EXPECT_TRUE(watch_set->Remove(a));
+  EXPECT_FALSE(watch_set->Remove(a));
+  EXPECT_EQ(watch_set->GetSize(), 2u);
+
+  // Entries with the same canonical form share the result.
+  uint32_t same_sum = watch_set->Add("(a)+b");
+  changes = watch_set->Evaluate(frame_);
+  ASSERT_EQ(changes.size(), 2u);
+  EXPECT_EQ(changes[0].id, sum);
+  EXPECT_STREQ(changes[0].value.GetValue(), "7");
+  EXPECT_EQ(changes[1].id, same_sum);
+  EXPECT_TRUE(changes[1].is_new);
+  EXPECT_STREQ(changes[1].value.GetValue(), "7");
+
+  EXPECT_TRUE(watch_set->Remove(sum));
+  EXPECT_TRUE(watch_set->Evaluate(frame_).empty());
+}
+
+TEST_F(InterpreterTest, TestBatchEvaluation) {
+  std::vector<std::string> exprs = {"a + b", "(a+b) * 2", "a", "b + undeclared",
+                                    "a +"};
+
+  std::vector<lldb_eval::EvaluationResult> results =
+      lldb_eval::EvaluateExpressions(frame_, exprs);
+  ASSERT_EQ(results.size(), 5u);
+  EXPECT_STREQ(results[0].value.GetValue(), "7");
+  EXPECT_STREQ(results[1].value.GetValue(), "14");
+  EXPECT_STREQ(results[2].value.GetValue(), "3");
+  EXPECT_TRUE(results[3].error.Fail());
+  EXPECT_STREQ(results[3].error.GetCString(),
+               "use of undeclared identifier 'undeclared'");
+  EXPECT_TRUE(results[4].error.Fail());
+
+  // "a", "b" and "a + b" are shared by the first three expressions.
+  lldb_eval::BatchPlanner planner;
+  std::vector<std::unique_ptr<lldb_eval::ExpressionContext>> contexts;
+  std::vector<lldb_eval::ExprResult> asts;
+  for (size_t i = 0; i < 3; ++i) {
+    contexts.push_back(std::make_unique<lldb_eval::ExpressionContext>(
+        exprs[i], lldb::SBExecutionContext(frame_)));
+    lldb_eval::Parser p(*contexts.back());
+    asts.push_back(p.Run());
+    ASSERT_FALSE(p.HasError());
+    planner.AddExpression(asts.back().get());
+  }
+  EXPECT_EQ(planner.num_subexpressions(), 8u);
+  EXPECT_EQ(planner.num_unique_subexpressions(), 4u);
+  EXPECT_EQ(planner.Plan().size(), 3u);
+}
+
+TEST_F(InterpreterTest, TestSerializedExpression) {
+  lldb::SBError error;
+  std::string data = lldb_eval::SerializeExpression(frame_, "(a+b) * 2", error);
+  ASSERT_TRUE(error.Success());
+
+  lldb::SBValue value = lldb_eval::EvaluateSerializedExpression(
+      frame_, data.data(), data.size(), error);
+  EXPECT_TRUE(error.Success());
+  EXPECT_STREQ(value.GetValue(), "14");
+
+  data.resize(data.size() - 1);
+  lldb_eval::EvaluateSerializedExpression(frame_, data.data(), data.size(),
+                                          error);
+  EXPECT_TRUE(error.Fail());
+}
+
+TEST_F(InterpreterTest, TestEvaluateInto) {
+  char buffer[16];
+  lldb_eval::ResultView result(buffer, sizeof(buffer));
+  lldb::SBError error;
+
+  // Computed by the interpreter.
+  ASSERT_TRUE(
+      lldb_eval::EvaluateExpressionInto(frame_, "a + b", result, error));
+  EXPECT_EQ(result.size(), 4u);
+  EXPECT_EQ(result.basic_type(), lldb::eBasicTypeInt);
+  EXPECT_FALSE(result.is_pointer());
+  int32_t i;
+  memcpy(&i, result.data(), sizeof(i));
+  EXPECT_EQ(i, 7);
+  EXPECT_EQ(result.GetTypeName(), "int");
+  EXPECT_STREQ(result.GetSbValue().GetValue(), "7");
+
+  ASSERT_TRUE(
+      lldb_eval::EvaluateExpressionInto(frame_, "a < b", result, error));
+  EXPECT_EQ(result.size(), 1u);
+  EXPECT_EQ(result.basic_type(), lldb::eBasicTypeBool);
+  EXPECT_EQ(buffer[0], 1);
+
+  // Read from the process.
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionInto(frame_, "a", result, error));
+  EXPECT_EQ(result.size(), 4u);
+  memcpy(&i, result.data(), sizeof(i));
+  EXPECT_EQ(i, 3);
+
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionInto(frame_, "&a", result, error));
+  EXPECT_TRUE(result.is_pointer());
+  EXPECT_EQ(result.basic_type(), lldb::eBasicTypeInvalid);
+  EXPECT_EQ(result.GetTypeName(), "int *");
+
+  // The buffer is too small.
+  lldb_eval::ResultView small(buffer, 2);
+  EXPECT_FALSE(
+      lldb_eval::EvaluateExpressionInto(frame_, "a + b", small, error));
+  EXPECT_TRUE(error.Fail());
+  EXPECT_EQ(small.size(), 4u);
+
+  EXPECT_FALSE(
+      lldb_eval::EvaluateExpressionInto(frame_, "undeclared", result, error));
+  EXPECT_STREQ(error.GetCString(),
+               "use of undeclared identifier 'undeclared'");
+}
+
+TEST_F(InterpreterTest, TestNativeFormatter) {
+  char buffer[16];
+  lldb_eval::ResultView result(buffer, sizeof(buffer));
+  lldb::SBError error;
+  char str[32];
+
+  ASSERT_TRUE(
+      lldb_eval::EvaluateExpressionInto(frame_, "a - b", result, error));
+  EXPECT_EQ(result.FormatValue(str, sizeof(str)), 2u);
+  EXPECT_STREQ(str, "-1");
+  EXPECT_EQ(result.FormatTypeName(str, sizeof(str)), 3u);
+  EXPECT_STREQ(str, "int");
+
+  lldb_eval::FormatOptions options;
+  options.radix = lldb_eval::FormatOptions::Radix::kHexadecimal;
+  result.FormatValue(str, sizeof(str), options);
+  EXPECT_STREQ(str, "0xffffffff");
+  options.radix = lldb_eval::FormatOptions::Radix::kBinary;
+  result.FormatValue(str, sizeof(str), options);
+  EXPECT_STREQ(str, "0b11111111111111111111111111111111");
+
+  ASSERT_TRUE(
+      lldb_eval::EvaluateExpressionInto(frame_, "a < b", result, error));
+  result.FormatValue(str, sizeof(str));
+  EXPECT_STREQ(str, "true");
+
+  ASSERT_TRUE(
+      lldb_eval::EvaluateExpressionInto(frame_, "a / 2.0", result, error));
+  result.FormatValue(str, sizeof(str));
+  EXPECT_STREQ(str, "1.5");
+
+  // Read from the process.
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionInto(frame_, "b", result, error));
+  result.FormatValue(str, sizeof(str));
+  EXPECT_STREQ(str, "4");
+
+  // The output is truncated like by snprintf().
+  ASSERT_TRUE(
+      lldb_eval::EvaluateExpressionInto(frame_, "a * 1000", result, error));
+  EXPECT_EQ(result.FormatValue(str, 3), 4u);
+  EXPECT_STREQ(str, "30");
+
+  // Pointers are formatted like LLDB does, e.g. "0x00007ffe...".
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionInto(frame_, "&a", result, error));
+  result.FormatValue(str, sizeof(str));
+  EXPECT_STREQ(str, result.GetSbValue().GetValue());
+  result.FormatTypeName(str, sizeof(str));
+  EXPECT_STREQ(str, "int *");
+
+  // Enumerators are formatted by their names, other values as integers of
+  // the signedness inferred from the enumerators.
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionInto(frame_, "back", result, error));
+  result.FormatValue(str, sizeof(str));
+  EXPECT_STREQ(str, "kBack");
+  ASSERT_TRUE(
+      lldb_eval::EvaluateExpressionInto(frame_, "delta", result, error));
+  result.FormatValue(str, sizeof(str));
+  EXPECT_STREQ(str, "-2");
+  ASSERT_TRUE(
+      lldb_eval::EvaluateExpressionInto(frame_, "flags", result, error));
+  result.FormatValue(str, sizeof(str));
+  EXPECT_STREQ(str, "2147483649");
+
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionInto(frame_, "c", result, error));
+  result.FormatValue(str, sizeof(str));
+  EXPECT_STREQ(str, "'x'");
+  options.radix = lldb_eval::FormatOptions::Radix::kHexadecimal;
+  result.FormatValue(str, sizeof(str), options);
+  EXPECT_STREQ(str, "0x78");
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionInto(frame_, "nl", result, error));
+  result.FormatValue(str, sizeof(str));
+  EXPECT_STREQ(str, "'\\n'");
+}
+
+TEST_F(InterpreterTest, TestChildPages) {
+  lldb::SBError error;
+  lldb_eval::ChildPageOptions options;
+  options.page_size = 100;
+
+  lldb::SBValue array =
+      lldb_eval::EvaluateExpression(frame_, "uint8_arr", error);
+  ASSERT_TRUE(error.Success());
+  std::unique_ptr<lldb_eval::ChildPager> pager =
+      lldb_eval::CreateChildPager(array, options);
+  EXPECT_EQ(pager->GetNumChildren(), 256u);
+  EXPECT_EQ(pager->GetNumPages(), 3u);
+
+  // The second page is prefetched with the first one.
+  lldb_eval::ChildPage page = pager->GetPage(0, error);
+  ASSERT_TRUE(error.Success());
+  EXPECT_EQ(page.first_index, 0u);
+  EXPECT_EQ(page.children.size(), 100u);
+  EXPECT_STREQ(page.element_type.GetName(), "uint8_t");
+
+  page = pager->GetPage(1, error);
+  ASSERT_TRUE(error.Success());
+  EXPECT_EQ(page.first_index, 100u);
+  EXPECT_EQ(page.children.size(), 100u);
+  EXPECT_STREQ(page.children[0].GetName(), "[100]");
+
+  page = pager->GetPage(2, error);
+  ASSERT_TRUE(error.Success());
+  ASSERT_EQ(page.children.size(), 56u);
+  EXPECT_STREQ(page.children[55].GetName(), "[255]");
+  EXPECT_EQ(page.children[55].GetValueAsUnsigned(), 0xABu);
+
+  pager->GetPage(3, error);
+  EXPECT_TRUE(error.Fail());
+
+  // Arrays of structs.
+  array = lldb_eval::EvaluateExpression(frame_, "c_arr", error);
+  ASSERT_TRUE(error.Success());
+  pager = lldb_eval::CreateChildPager(array, options);
+  page = pager->GetPage(0, error);
+  ASSERT_TRUE(error.Success());
+  ASSERT_EQ(page.children.size(), 2u);
+  EXPECT_EQ(
+      page.children[1].GetChildMemberWithName("field_").GetValueAsSigned(),
+      1);
+
+  // Not an array, the children are enumerated by LLDB.
+  lldb::SBValue c = lldb_eval::EvaluateExpression(frame_, "c_arr[1]", error);
+  ASSERT_TRUE(error.Success());
+  pager = lldb_eval::CreateChildPager(c, options);
+  page = pager->GetPage(0, error);
+  ASSERT_TRUE(error.Success());
+  EXPECT_FALSE(page.element_type.IsValid());
+  EXPECT_EQ(page.children.size(), c.GetNumChildren());
+}
+
+TEST_F(InterpreterTest, TestArraySlice) {
+  lldb::SBError error;
+
+  lldb::SBValue slice =
+      lldb_eval::EvaluateExpression(frame_, "int_arr[1:3]", error);
+  ASSERT_TRUE(error.Success()) << error.GetCString();
+  EXPECT_STREQ(slice.GetTypeName(), "int[2]");
+  ASSERT_EQ(slice.GetNumChildren(), 2u);
+  EXPECT_EQ(slice.GetChildAtIndex(0).GetValueAsSigned(), 2);
+  EXPECT_EQ(slice.GetChildAtIndex(1).GetValueAsSigned(), 3);
+
+  slice = lldb_eval::EvaluateExpression(frame_, "td_int_ptr[0:3]", error);
+  ASSERT_TRUE(error.Success()) << error.GetCString();
+  ASSERT_EQ(slice.GetNumChildren(), 3u);
+  EXPECT_EQ(slice.GetChildAtIndex(2).GetValueAsSigned(), 3);
+
+  slice = lldb_eval::EvaluateExpression(frame_, "uint8_arr[255:256]", error);
+  ASSERT_TRUE(error.Success()) << error.GetCString();
+  ASSERT_EQ(slice.GetNumChildren(), 1u);
+  EXPECT_EQ(slice.GetChildAtIndex(0).GetValueAsUnsigned(), 0xABu);
+
+  // GDB-style artificial arrays.
+  slice = lldb_eval::EvaluateExpression(frame_, "int_arr[0]@3", error);
+  ASSERT_TRUE(error.Success()) << error.GetCString();
+  EXPECT_STREQ(slice.GetTypeName(), "int[3]");
+  ASSERT_EQ(slice.GetNumChildren(), 3u);
+  EXPECT_EQ(slice.GetChildAtIndex(0).GetValueAsSigned(), 1);
+  EXPECT_EQ(slice.GetChildAtIndex(2).GetValueAsSigned(), 3);
+
+  // "@" binds looser than "+".
+  slice = lldb_eval::EvaluateExpression(frame_, "*td_int_ptr@1 + 1", error);
+  ASSERT_TRUE(error.Success()) << error.GetCString();
+  EXPECT_EQ(slice.GetNumChildren(), 2u);
+
+  TestExprErr("int_arr[2:1]", "slice [2:1] is empty");
+  TestExprErr("int_arr[0:1.0]", "slice bound is not an integer");
+  TestExprErr("idx_1[0:1]", "sliced value is not an array or pointer");
+  TestExprErr("1@2", "only values in memory can be extended with '@'");
+  TestExprErr("int_arr[0]@0", "invalid number 0 of repetitions");
+  TestExprErr("int_arr[0]@1.5", "repetition count is not an integer");
+}
+
+TEST_F(InterpreterTest, TestRangeEvaluation) {
+  lldb::SBError error;
+  lldb_eval::RangeResult result;
+
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionOverRange(
+      frame_, "points[i].x * scale", "i", 0, 100, result, error))
+      << error.GetCString();
+  EXPECT_TRUE(result.vectorized);
+  EXPECT_EQ(result.type, lldb::eBasicTypeInt);
+  ASSERT_EQ(result.size(), 100u);
+  EXPECT_EQ(result.Get<int32_t>(0), 0);
+  EXPECT_EQ(result.Get<int32_t>(99), 297);
+
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionOverRange(
+      frame_, "points_ptr[i + 10].y + 1", "i", 0, 10, result, error))
+      << error.GetCString();
+  EXPECT_TRUE(result.vectorized);
+  EXPECT_EQ(result.type, lldb::eBasicTypeDouble);
+  ASSERT_EQ(result.size(), 10u);
+  EXPECT_EQ(result.Get<double>(0), 6.0);
+  EXPECT_EQ(result.Get<double>(9), 10.5);
+
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionOverRange(
+      frame_, "points[i].visible && points[i].x > 50", "i", 50, 54, result,
+      error))
+      << error.GetCString();
+  EXPECT_TRUE(result.vectorized);
+  EXPECT_EQ(result.type, lldb::eBasicTypeBool);
+  ASSERT_EQ(result.size(), 4u);
+  EXPECT_FALSE(result.Get<bool>(0));
+  EXPECT_FALSE(result.Get<bool>(1));
+  EXPECT_TRUE(result.Get<bool>(2));
+  EXPECT_FALSE(result.Get<bool>(3));
+
+  // The conditional operator is evaluated for every index separately.
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionOverRange(
+      frame_, "points[i].visible ? i : -1", "i", 0, 4, result, error))
+      << error.GetCString();
+  EXPECT_FALSE(result.vectorized);
+  EXPECT_EQ(result.type, lldb::eBasicTypeLongLong);
+  ASSERT_EQ(result.size(), 4u);
+  EXPECT_EQ(result.Get<int64_t>(0), 0);
+  EXPECT_EQ(result.Get<int64_t>(1), -1);
+  EXPECT_EQ(result.Get<int64_t>(2), 2);
+
+  // Empty range.
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionOverRange(
+      frame_, "points[i].x", "i", 5, 5, result, error))
+      << error.GetCString();
+  EXPECT_EQ(result.size(), 0u);
+
+  // The division is short-circuited for the zero divisors.
+  ASSERT_TRUE(lldb_eval::EvaluateExpressionOverRange(
+      frame_, "points[i].x != 0 && 100 / points[i].x > 30", "i", 0, 4,
+      result, error))
+      << error.GetCString();
+  EXPECT_FALSE(result.vectorized);
+  ASSERT_EQ(result.size(), 4u);
+  EXPECT_FALSE(result.Get<bool>(0));
+  EXPECT_TRUE(result.Get<bool>(1));
+  EXPECT_TRUE(result.Get<bool>(3));
+
+  EXPECT_FALSE(lldb_eval::EvaluateExpressionOverRange(
+      frame_, "scale / points[i].x", "i", 0, 10, result, error));
+  EXPECT_STREQ(error.GetCString(), "division by zero or overflow");
+
+  EXPECT_FALSE(lldb_eval::EvaluateExpressionOverRange(
+      frame_, "points[i]", "i", 0, 10, result, error));
+  EXPECT_STREQ(error.GetCString(), "result of type 'Point' is not a scalar");
+
+  EXPECT_FALSE(lldb_eval::EvaluateExpressionOverRange(
+      frame_, "points[i].x", "i", 10, 0, result, error));
+  EXPECT_STREQ(error.GetCString(), "invalid range [10, 0)");
+}
+
+TEST_F(InterpreterTest, TestBuiltins) {
+  // LLDB doesn't know the builtins.
+  SkipLLDB _(this);
+
+  TestExpr("sum(latencies)", "25");
+  TestExpr("min(latencies)", "1");
+  TestExpr("max(latencies)", "9");
+  TestExpr("count(latencies, _ > 4)", "3");
+  TestExpr("any(latencies, _ == 9)", "true");
+  TestExpr("all(latencies, _ > 1)", "false");
+  TestExpr("find(latencies, 9)", "2");
+  TestExpr("find(latencies, 4)", "-1");
+  TestExpr("find_if(latencies, _ < 3)", "3");
+
+  // The arithmetic of the element type.
+  TestExpr("sum(counters)", "1");
+  TestExpr("sum(weights)", "0");
+  TestExpr("max(weights, -_)", "2");
+  TestExpr("sum(name)", "294");
+
+  // Slices, artificial arrays and the variables in the lambdas.
+  TestExpr("max(latencies[0:n])", "9");
+  TestExpr("sum(*latencies_ptr@2)", "8");
+  TestExpr("count(latencies[1:5], _ > n)", "2");
+
+  // Aggregates.
+  TestExpr("count(slots, _.busy)", "2");
+  TestExpr("sum(slots, _.id)", "100");
+  TestExpr("find_if(slots, !_.busy && _.id > 20)", "3");
+  TestExpr("count(slots[1:4], _.busy ? 1 : 0)", "1");
+  TestExpr("count(slots, _.id != 10 && 100 / (_.id - 10) > 3)", "2");
+  TestExpr("sum(filter(latencies, _ > 4))", "21");
+  TestExpr("sum(filter(slots, _.busy), _.id)", "40");
+  TestExpr("count(filter(latencies, _ > 100))", "0");
+
+  // Conditions.
+  TestExpr("max(latencies) > 5 && !any(slots, _.id == 50)", "true");
+
+  TestExprErr("sum(n)", "'sum' expects an array, got 'int'");
+  TestExprErr("sum()", "'sum' expects 1 to 2 arguments, 0 given");
+  TestExprErr("find(latencies)", "'find' expects 2 arguments, 1 given");
+  TestExprErr("sum(slots)", "result of type 'Slot' is not a scalar");
+  TestExprErr("max(filter(latencies, _ > 100))", "'max' of an empty array");
+  TestExprErr("count(latencies, _.x)", "element 0: ");
+  TestExprErr("foo(latencies)", "use of undeclared identifier 'foo'");
+}
+
+TEST_F(InterpreterTest, TestStringBuiltins) {
+  // LLDB doesn't know the builtins.
+  SkipLLDB _(this);
+
+  TestExpr("strlen(greeting)", "11");
+  TestExpr("strlen(buf)", "3");
+  TestExpr("strlen(\"\")", "0");
+  TestExpr("strlen(\"ab\" \"cd\")", "4");
+  TestExpr("streq(greeting, \"hello world\")", "true");
+  TestExpr("streq(\"hello\", greeting)", "false");
+  TestExpr("streq(buf, \"foo\")", "true");
+  TestExpr("streq(buf, greeting)", "false");
+  TestExpr("strneq(greeting, \"help\", 3)", "true");
+  TestExpr("strneq(greeting, \"help\", 4)", "false");
+  TestExpr("strneq(greeting, buf, 0)", "true");
+  TestExpr("startswith(greeting, \"hello \")", "true");
+  TestExpr("startswith(buf, \"foobar\")", "false");
+  TestExpr("contains(greeting, \"o w\")", "true");
+  TestExpr("contains(greeting, \"ow\")", "false");
+
+  // The string arrays, which aren't terminated, end with the array.
+  TestExpr("strlen(unterminated)", "3");
+  TestExpr("streq(unterminated, \"xyz\")", "true");
+
+  // Conditions.
+  TestExpr("n == 1 && startswith(greeting, \"he\")", "true");
+
+  TestExprErr("strlen(null_str)", "'strlen' argument is a null pointer");
+  TestExprErr("strlen(n)", "'strlen' expects a string, got 'int'");
+  TestExprErr("strneq(buf, buf, -1)", "'strneq' expects a non-negative length");
+  TestExprErr("strneq(buf, buf, 2000000)",
+              "'strneq' length 2000000 is larger than the limit of 1048576 "
+              "bytes");
+}
+
+TEST_F(InterpreterTest, TestMemoryBuiltins) {
+  // LLDB doesn't know the builtins.
+  SkipLLDB _(this);
+
+  TestExpr("memeq(request, \"GET \", n)", "true");
+  TestExpr("memeq(request, \"POST\", n)", "false");
+  TestExpr("memeq(request_ptr, expected, 5)", "true");
+  TestExpr("memeq(request_ptr + 1, expected, 5)", "false");
+  TestExpr("memeq(request, ring, 0)", "true");
+
+  TestExpr("memchr(ring, 0xff, 8) == ring + 2", "true");
+  TestExpr("memchr(ring, -1, 8) == ring + 2", "true");
+  TestExpr("!memchr(ring, 0xff, 2)", "true");
+  TestExpr("memchr(request_ptr, 47, 24) == request + 4", "true");
+
+  TestExpr("memfind(ring, 8, magic) == ring + 6", "true");
+  TestExpr("!memfind(ring, 7, magic)", "true");
+  TestExpr("memfind(request, 24, \"HTTP\") == request + 16", "true");
+  TestExpr("memfind(request_ptr, 24, expected) == request", "true");
+
+  TestExprErr("memchr(n, 1, 1)", "'memchr' expects a pointer, got 'int'");
+  TestExprErr("memchr(ring, 1.5, 8)", "'memchr' expects an integer byte");
+  TestExprErr("memeq(request, \"GET\", 10)",
+              "'memeq' length 10 is larger than the array of 4 bytes");
+  TestExprErr("memeq(request, ring, 100000000)",
+              "is larger than the limit of 67108864 bytes");
+  TestExprErr("memfind(ring, 8, n)",
+              "'memfind' expects an array or a string pattern, got 'int'");
+}
+
+TEST_F(InterpreterTest, TestListBuiltins) {
+  // LLDB doesn't know the builtins.
+  SkipLLDB _(this);
+
+  TestExpr("list_len(list, _->next)", "5");
+  TestExpr("list_len(empty_list, _->next)", "0");
+  TestExpr("list_len(chain_head, _->links.next)", "3");
+  TestExpr("list_len(list, _->next ? _->next->next : _->next)", "3");
+  TestExpr("list_nth(list, _->next, 3)->id", "30");
+  TestExpr("list_nth(list, _->next, 0) == list", "true");
+  TestExpr("!list_nth(list, _->next, 5)", "true");
+  TestExpr("list_nth(&chain[2], _->links.prev, 2)->value", "1");
+
+  TestExpr("list_find(list, _->next, _->id == 40)->id", "40");
+  TestExpr("list_find(list, _->next, _->id > 15 && _->id % 20 == 0)->id",
+           "20");
+  TestExpr("!list_find(list, _->next, _->id == 7)", "true");
+  TestExpr("list_find(list, _->next, _ == &nodes[2])->id", "20");
+  TestExpr("list_find(cycle_head, _->next, _->id == 3)->id", "3");
+  // The predicate fails only past the match, at the last node.
+  TestExpr("list_find(list, _->next, _->next->id == 20)->id", "10");
+
+  TestExprErr("list_len(cycle_head, _->next)",
+              "'list_len' list has a cycle, node 2 links back to the node at "
+              "0x");
+  TestExprErr("list_find(cycle_head, _->next, _->id == 4)",
+              "'list_find' list has a cycle");
+  TestExprErr("list_len(nodes[0].id, _->next)",
+              "'list_len' expects a pointer to the first node, got 'int'");
+  TestExprErr("list_len(list, _->id)",
+              "'list_len' link is not a pointer, got 'int'");
+  TestExprErr("list_nth(list, _->next, -1)",
+              "'list_nth' expects a non-negative index");
+
+  // The nodes read above are cached during the stop, the writes made through
+  // lldb-eval drop them.
+  lldb::SBValue next = frame_.FindVariable("nodes")
+                           .GetChildAtIndex(2)
+                           .GetChildMemberWithName("next");
+  std::string saved_next = next.GetValue();
+  lldb::SBError error;
+  ASSERT_TRUE(lldb_eval::SetValueFromCString(next, "0", error));
+  TestExpr("list_len(list, _->next)", "3");
+  TestExpr("!list_nth(list, _->next, 2)->next", "true");
+
+  // The writes made through the SB API require an explicit invalidation.
+  ASSERT_TRUE(next.SetValueFromCString(saved_next.c_str()));
+  lldb_eval::InvalidateMemoryCache();
+  TestExpr("list_len(list, _->next)", "5");
+
+  // Compiled expressions notice the writes to their inputs.
+  lldb_eval::CompiledExpression len("list_len(list, _->next)");
+  EXPECT_STREQ(len.Evaluate(frame_, error).GetValue(), "5");
+  ASSERT_TRUE(next.SetValueFromCString("0"));
+  EXPECT_STREQ(len.Evaluate(frame_, error).GetValue(), "3");
+  EXPECT_FALSE(len.reused());
+
+  // Without the cache the writes are always visible.
+  lldb_eval::SetMemoryCacheCapacity(0);
+  ASSERT_TRUE(next.SetValueFromCString(saved_next.c_str()));
+  TestExpr("list_len(list, _->next)", "5");
+  lldb_eval::SetMemoryCacheCapacity(lldb_eval::kDefaultStopCacheCapacity);
+}
+
+TEST_F(InterpreterTest, TestStdContainers) {
+  // LLDB uses the synthetic children and doesn't support the member calls.
+  SkipLLDB _(this);
+
+  TestExpr("vec[1]", "2");
+  TestExpr("vec[n] + vec[2]", "5");
+  TestExpr("vec_ref[0]", "1");
+  TestExpr("vec.size()", "3");
+  TestExpr("vec_ref.size()", "3");
+  TestExpr("vec.empty()", "false");
+  TestExpr("empty_vec.empty()", "true");
+  TestExpr("vec.data()[2]", "3");
+  TestExpr("nodes[1].value", "20");
+  TestExpr("(&nodes)->size()", "2");
+
+  TestExpr("short_str.size()", "2");
+  TestExpr("streq(short_str.data(), \"hi\")", "true");
+  TestExpr("long_str.length()", "33");
+  TestExpr("strlen(long_str.data())", "33");
+  TestExpr("startswith(long_str.data(), \"a string\")", "true");
+
+  TestExpr("arr[2]", "30");
+  TestExpr("arr.size()", "3");
+  TestExpr("sum(*arr.data()@3)", "60");
+
+  TestExpr("*uptr", "42");
+  TestExpr("*uptr.get() + 1", "43");
+  TestExpr("node_ptr->value", "7");
+  TestExpr("(*node_ptr).value", "7");
+  TestExpr("node_ptr->value == 7 && *sptr == 5", "true");
+  TestExpr("!null_uptr.get()", "true");
+
+  TestExprErr("vec[3]", "index 3 is out of range of 'std::vector<int");
+  TestExprErr("vec[-1]", "index -1 is out of range");
+  TestExprErr("vec.get()",
+              "no member function named 'get' in 'std::vector<int");
+  TestExprErr("uptr.size()", "no member function named 'size'");
+  TestExprErr("vec.size(1)", "'size' expects no arguments, 1 given");
+  TestExprErr("n.size()", "calling member functions of 'int' is not supported");
+  TestExprErr("vec->size()", "member reference type");
+}
+
+TEST_F(InterpreterTest, TestBitfields) {
+  TestExpr("status.version", "5");
+  TestExpr("status.flags", "17");
+  TestExpr("status.ready", "true");
+  TestExpr("status.mode", "kWrite");
+  TestExpr("status.sign", "kNegative");
+  TestExpr("status.delta", "-3");
+  TestExpr("status.code", "2748");
+  TestExpr("status.low", "9");
+  TestExpr("status.high", "6");
+  TestExpr("status.wide", "-549755813887");
+  TestExpr("status.plain", "7");
+
+  TestExpr("status_ptr->delta", "-3");
+  TestExpr("status_ptr->code + 1", "2749");
+  TestExpr("status_ref.wide", "-549755813887");
+  TestExpr("status.delta * 2", "-6");
+  TestExpr("status.low | status.high << 4", "105");
+
+  TestExprErr("status.missing", "no member named 'missing'");
+
+  // The writes made in the same stop are visible.
+  lldb::SBValue delta = frame_.FindVariable("status").GetChildMemberWithName(
+      "delta");
+  ASSERT_TRUE(delta.SetValueFromCString("7"));
+  TestExpr("status.delta", "7");
+  TestExpr("status_ptr->delta * 2", "14");
+}
+
+TEST_F(InterpreterTest, TestEnums) {
+  TestExpr("kGreen", "kGreen");
+  TestExpr("Color::kBlue", "kBlue");
+  TestExpr("State::kRunning", "kRunning");
+  TestExpr("net::kUdp", "kUdp");
+  TestExpr("net::Proto::kTcp", "kTcp");
+  TestExpr("(Color)6", "kBlue");
+
+  TestExpr("color == kGreen", "true");
+  TestExpr("color != Color::kRed", "true");
+  TestExpr("state == State::kRunning", "true");
+  TestExpr("stopped == State::kStopped", "true");
+  TestExpr("proto == net::kUdp", "true");
+  TestExpr("color < kBlue", "true");
+
+  TestExpr("(int)color", "5");
+  TestExpr("(int)stopped", "-1");
+  TestExpr("kBlue - kGreen", "1");
+  TestExpr("kRed - 1", "-1");
+  TestExpr("proto + 1", "18");
+  TestExpr("(unsigned long long)limit", "18446744073709551615");
+  TestExpr("color ? 1 : 2", "1");
+
+  TestExprErr("State::kDone", "use of undeclared identifier 'State::kDone'");
+  TestExprErr("kNone", "use of undeclared identifier 'kNone'");
+
+  // The resolver of the target has no module of its own, the enumerators are
+  // found among the enumerations of the other modules.
+  auto resolver = lldb_eval::ScopeResolver::Get(process_.GetTarget());
+  lldb::SBType type;
+  uint64_t value = 0;
+  ASSERT_TRUE(resolver->ResolveEnumerator("net::kUdp", &type, &value));
+  EXPECT_STREQ(type.GetName(), "net::Proto");
+  EXPECT_EQ(value, 17u);
+  ASSERT_TRUE(resolver->ResolveEnumerator("kBlue", &type, &value));
+  EXPECT_EQ(value, 6u);
+  EXPECT_FALSE(resolver->ResolveEnumerator("kNone", &type, &value));
+}
+
+TEST_F(InterpreterTest, TestWideScalars) {
+  TestExpr("i128_small + 1", "1001");
+  TestExpr("i128_small * -3", "-3000");
+  TestExpr("i128_small / 7", "142");
+  TestExpr("i128_small % 7", "6");
+  TestExpr("i128 < 0", "true");
+  TestExpr("u128 > i128_small", "true");
+  TestExpr("u128_max + 1 == 0", "true");
+  TestExpr("(long long)(u128 >> 100)", "3");
+  TestExpr("(long long)(u128 & 0xff)", "7");
+  TestExpr("(long long)(i128 >> 100)", "-2");
+  TestExpr("(unsigned long long)(u128_max >> 64)", "18446744073709551615");
+  TestExpr("(int)(i128_small << 3)", "8000");
+
+  // The results are compared with LLDB, including the promotions of the
+  // operands, e.g. "int128 + unsigned long long" is "__int128".
+  TestExprOnlyCompare("i128");
+  TestExprOnlyCompare("u128");
+  TestExprOnlyCompare("u128_max");
+  TestExprOnlyCompare("i128 + 1");
+  TestExprOnlyCompare("i128 - 18446744073709551615ULL");
+  TestExprOnlyCompare("u128 * 2");
+  TestExprOnlyCompare("-i128");
+  TestExprOnlyCompare("~u128");
+  TestExprOnlyCompare("i128 + u128");
+  TestExprOnlyCompare("i128 ^ u128");
+
+  TestExpr("ld * 2 == 3", "true");
+  TestExpr("ld + ld_neg > 1.2", "true");
+  TestExpr("ld < ld_neg", "false");
+  TestExpr("(int)(ld * 4)", "6");
+  TestExpr("(double)ld_neg", "-0.25");
+  TestExpr("(long double)1 == 1", "true");
+  TestExpr("(long long)(i128_small * ld)", "1500");
+  TestExpr("!ld", "false");
+
+  TestExprOnlyCompare("ld");
+  TestExprOnlyCompare("ld / 3");
+  TestExprOnlyCompare("-ld_neg");
+  TestExprOnlyCompare("ld + 1.5f");
+  TestExprOnlyCompare("(long double)i128_small");
+
+  // Every binary operator over every ordered pair of the wide types.
+  struct WideOperand {
+    std::string lhs;    // Left operand.
+    std::string rhs;    // Right operand, a non-zero divisor.
+    std::string shift;  // Right operand of the shifts.
+    bool is_integer;
+  };
+  const WideOperand operands[] = {
+      {"i128", "i128_small", "i128_shift", true},
+      {"u128", "u128_small", "u128_shift", true},
+      {"ld", "ld_neg", "ld_neg", false},
+  };
+  const char* arithmetic_ops[] = {"+",  "-",  "*",  "/",  "==", "!=", "<",
+                                  "<=", ">",  ">=", "&&", "||"};
+  const char* integer_ops[] = {"%", "&", "|", "^", "<<", ">>"};
+
+  for (const auto& l : operands) {
+    for (const auto& r : operands) {
+      for (const char* op : arithmetic_ops) {
+        TestExprOnlyCompare(l.lhs + " " + op + " " + r.rhs);
+      }
+      for (const char* op : integer_ops) {
+        bool is_shift = op[0] == '<' || op[0] == '>';
+        std::string expr =
+            l.lhs + " " + op + " " + (is_shift ? r.shift : r.rhs);
+        if (l.is_integer && r.is_integer) {
+          TestExprOnlyCompare(expr);
+        } else {
+          TestExprErr(expr, "invalid operands to binary expression");
+        }
+      }
+    }
+  }
+
+  for (const auto& operand : operands) {
+    TestExprOnlyCompare("-" + operand.lhs);
+    TestExprOnlyCompare("+" + operand.lhs);
+    TestExprOnlyCompare("!" + operand.lhs);
+    if (operand.is_integer) {
+      TestExprOnlyCompare("~" + operand.lhs);
+    } else {
+      TestExprErr("~" + operand.lhs, "invalid argument type");
+    }
+  }
+  TestExprOnlyCompare("i128_small + ld");
+}
+
+TEST_F(InterpreterTest, TestStdAssociativeContainers) {
+  SkipLLDB _(this);
+
+  TestExpr("squares[-7]", "49");
+  TestExpr("squares[50]", "2500");
+  TestExpr("squares.size()", "101");
+  TestExpr("squares.count(51)", "0");
+  TestExpr("squares.contains(0)", "true");
+  TestExpr("squares.find(3)->second", "9");
+  TestExpr("!squares.find(51)", "true");
+
+  TestExpr("ages[\"bob\"]", "25");
+  TestExpr("ages[bob]", "25");
+  TestExpr("ages[carol]", "41");
+  TestExpr("ages.count(\"dave\")", "0");
+  TestExpr("ages.find(\"alice\")->second", "30");
+
+  TestExpr("primes.count(11)", "1");
+  TestExpr("primes.contains(4)", "false");
+  TestExpr("*primes.find(13)", "13");
+
+  TestExpr("ids[693]", "99");
+  TestExpr("ids[n]", "1");
+  TestExpr("ids.count(8)", "0");
+  TestExpr("ids.size()", "100");
+  TestExpr("prices[\"pear\"]", "2.25");
+  TestExpr("prices.contains(\"plum\")", "false");
+  TestExpr("vowels.count(101)", "1");
+  TestExpr("vowels.count(98)", "0");
+
+  TestExprErr("squares[51]", "key is not found in 'std::map<int, int");
+  TestExprErr("primes[2]", "does not provide a subscript operator");
+  TestExprErr("squares.find()", "'find' expects 1 argument, 0 given");
+  TestExprErr("squares.data()", "no member function named 'data'");
+  TestExprErr("ages[1]", "cannot convert 'int' to the key type");
+  TestExprErr("by_length.count(\"one\")",
+              "custom key comparison are not supported");
+
+  // The nodes are cached during the stop, the writes made through lldb-eval
+  // drop them. The largest key is replaced, the tree stays ordered.
+  lldb::SBError error;
+  lldb::SBValue key =
+      lldb_eval::EvaluateExpression(frame_, "*primes.find(13)", error);
+  ASSERT_TRUE(error.Success());
+  ASSERT_TRUE(lldb_eval::SetValueFromCString(key, "17", error));
+  TestExpr("primes.count(13)", "0");
+  TestExpr("primes.contains(17)", "true");
+  TestExpr("*primes.find(17)", "17");
+}
+
 }  // namespace
@@ -17,7 +17,9 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "lldb-eval/scope_resolver.h"
 #include "lldb/API/SBExecutionContext.h"
+#include "lldb/API/SBFrame.h"
 #include "lldb/API/SBTarget.h"
 #include "lldb/API/SBType.h"
 
@@ -36,63 +38,17 @@ ExpressionContext::ExpressionContext(const std::string& expr,
 }
 
 lldb::SBType ExpressionContext::ResolveTypeByName(const char* name) {
-  lldb::SBTarget target = exec_ctx_.GetTarget();
-
-  // TODO(b/163308825): Do scope-aware type lookup. Look for the types defined
-  // in the current scope (function, class, namespace) and prioritize them.
-
-  // Internally types don't have global scope qualifier in their names and
-  // LLDB doesn't support queries with it too.
-  llvm::StringRef name_ref(name);
-  bool global_scope = false;
-
-  if (name_ref.startswith("::")) {
-    name_ref = name_ref.drop_front(2);
-    global_scope = true;
-  }
-
-  // SBTarget::FindTypes will return all matched types, including the ones one
-  // in different scopes. I.e. if seaching for "myint", this will also return
-  // "ns::myint" and "Foo::myint".
-  lldb::SBTypeList types = target.FindTypes(name_ref.data());
-
-  // We've found multiple types, try finding the "correct" one.
-  lldb::SBType full_match;
-  std::vector<lldb::SBType> partial_matches;
-
-  for (uint32_t i = 0; i < types.GetSize(); ++i) {
-    lldb::SBType type = types.GetTypeAtIndex(i);
-    llvm::StringRef type_name = type.GetName();
-
-    if (type_name == name_ref) {
-      full_match = type;
-    } else if (type_name.endswith(name_ref)) {
-      partial_matches.push_back(type);
-    }
-  }
-
-  if (global_scope) {
-    // Look only for full matches when looking for a globally qualified type.
-    if (full_match.IsValid()) {
-      return full_match;
-    }
-  } else {
-    // TODO(b/163308825): We're looking for type, but there may be multiple
-    // candidates and which one is correct depends on the currect scope. For now
-    // just pick the most "probable" type.
-
-    // Full match is always correct if we're currently in the global scope.
-    if (full_match.IsValid()) {
-      return full_match;
-    }
+  return GetScopeResolver().ResolveType(name);
+}
 
-    // If we have partial matches, pick a "random" one.
-    if (partial_matches.size() > 0) {
-      return partial_matches.back();
-    }
+ScopeResolver& ExpressionContext::GetScopeResolver() {
+  if (!scope_resolver_) {
+    lldb::SBFrame frame = exec_ctx_.GetFrame();
+    scope_resolver_ = frame.IsValid()
+                          ? ScopeResolver::Get(frame)
+                          : ScopeResolver::Get(exec_ctx_.GetTarget());
   }
-
-  return lldb::SBType();
+  return *scope_resolver_;
 }
 
 }  // namespace lldb_eval
@@ -17,8 +17,12 @@
 #ifndef LLDB_EVAL_EXPRESSION_CONTEXT_H_
 #define LLDB_EVAL_EXPRESSION_CONTEXT_H_
 
+#include <memory>
+#include <string>
+
 #include "clang/Basic/SourceManager.h"
 #include "lldb-eval/scalar.h"
+#include "lldb-eval/scope_resolver.h"
 #include "lldb/API/SBExecutionContext.h"
 #include "lldb/API/SBType.h"
 
@@ -34,6 +38,10 @@ class ExpressionContext {
  public:
   lldb::SBType ResolveTypeByName(const char* name);
 
+  // Returns the resolver for the names visible from the current scope. It's
+  // obtained lazily, when the first name is resolved.
+  ScopeResolver& GetScopeResolver();
+
  private:
   // Store the expression, since SourceManager doesn't take the ownership.
   std::string expr_;
@@ -43,6 +51,8 @@ class ExpressionContext {
   // provides information for semantic analysis (e.g. resolving types, looking
   // up variables, etc).
   lldb::SBExecutionContext exec_ctx_;
+
+  std::shared_ptr<ScopeResolver> scope_resolver_;
 };
 
 }  // namespace lldb_eval
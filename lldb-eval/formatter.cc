@@ -0,0 +1,383 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/formatter.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "lldb-eval/api.h"
+#include "lldb-eval/enum_table.h"
+#include "lldb/API/SBType.h"
+#include "lldb/lldb-enumerations.h"
+
+namespace {
+
+using lldb_eval::BufferWriter;
+using Radix = lldb_eval::FormatOptions::Radix;
+
+// Reads an integer of the given size, zero-extended.
+uint64_t ReadUnsigned(const void* data, size_t size) {
+  switch (size) {
+    case 1: {
+      uint8_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+    }
+    case 2: {
+      uint16_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+    }
+    case 4: {
+      uint32_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+    }
+    case 8: {
+      uint64_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+    }
+    default:
+      return 0;
+  }
+}
+
+// Reads an integer of the given size, sign-extended.
+int64_t ReadSigned(const void* data, size_t size) {
+  uint64_t value = ReadUnsigned(data, size);
+  if (size > 0 && size < sizeof(uint64_t)) {
+    unsigned shift = static_cast<unsigned>(64 - size * 8);
+    return static_cast<int64_t>(value << shift) >> shift;
+  }
+  return static_cast<int64_t>(value);
+}
+
+bool IsSupportedIntegerSize(size_t size) {
+  return size == 1 || size == 2 || size == 4 || size == 8;
+}
+
+// Formats the bit pattern of the value in a non-decimal radix, padded to the
+// size of the value, e.g. "0x0000002a".
+void FormatBits(uint64_t value, size_t size, Radix radix, BufferWriter& out) {
+  unsigned bits_per_digit = radix == Radix::kHexadecimal ? 4
+                            : radix == Radix::kOctal     ? 3
+                                                         : 1;
+  unsigned num_bits = static_cast<unsigned>(size * 8);
+  unsigned num_digits = (num_bits + bits_per_digit - 1) / bits_per_digit;
+  uint64_t mask = (1u << bits_per_digit) - 1;
+
+  char digits[64];
+  for (unsigned i = 0; i < num_digits; ++i) {
+    digits[num_digits - 1 - i] =
+        "0123456789abcdef"[(value >> (i * bits_per_digit)) & mask];
+  }
+
+  out.Append(radix == Radix::kHexadecimal ? "0x"
+             : radix == Radix::kOctal     ? "0"
+                                          : "0b");
+  out.Append(digits, num_digits);
+}
+
+void FormatDecimal(uint64_t value, bool negative, BufferWriter& out) {
+  char digits[20];
+  size_t num_digits = 0;
+  do {
+    digits[sizeof(digits) - 1 - num_digits++] =
+        static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+
+  if (negative) {
+    out.Append('-');
+  }
+  out.Append(digits + sizeof(digits) - num_digits, num_digits);
+}
+
+void FormatInteger(const void* data, size_t size, bool is_signed,
+                   Radix radix, BufferWriter& out) {
+  if (radix != Radix::kDecimal) {
+    FormatBits(ReadUnsigned(data, size), size, radix, out);
+    return;
+  }
+  if (is_signed) {
+    int64_t value = ReadSigned(data, size);
+    // Negate in unsigned arithmetic, -INT64_MIN overflows.
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value)
+                                   : static_cast<uint64_t>(value);
+    FormatDecimal(magnitude, value < 0, out);
+  } else {
+    FormatDecimal(ReadUnsigned(data, size), false, out);
+  }
+}
+
+void FormatCharacter(uint64_t code, const char* prefix, BufferWriter& out) {
+  out.Append(prefix);
+  out.Append('\'');
+  switch (code) {
+    case 0:
+      out.Append("\\0");
+      break;
+    case '\a':
+      out.Append("\\a");
+      break;
+    case '\b':
+      out.Append("\\b");
+      break;
+    case '\f':
+      out.Append("\\f");
+      break;
+    case '\n':
+      out.Append("\\n");
+      break;
+    case '\r':
+      out.Append("\\r");
+      break;
+    case '\t':
+      out.Append("\\t");
+      break;
+    case '\v':
+      out.Append("\\v");
+      break;
+    case '\\':
+      out.Append("\\\\");
+      break;
+    case '\'':
+      out.Append("\\'");
+      break;
+    default:
+      if (code >= 0x20 && code < 0x7f) {
+        out.Append(static_cast<char>(code));
+      } else {
+        char hex[24];
+        snprintf(hex, sizeof(hex), "\\x%llx",
+                 static_cast<unsigned long long>(code));
+        out.Append(hex);
+      }
+      break;
+  }
+  out.Append('\'');
+}
+
+// Prints the value with the fewest digits which still parse back to the same
+// value.
+template <typename T>
+void FormatFloat(T value, BufferWriter& out) {
+  char buffer[32];
+  for (int precision = 1; precision <= 17; ++precision) {
+    snprintf(buffer, sizeof(buffer), "%.*g", precision,
+             static_cast<double>(value));
+    if (static_cast<T>(strtod(buffer, nullptr)) == value) {
+      break;
+    }
+  }
+  out.Append(buffer);
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+BufferWriter::BufferWriter(char* buffer, size_t size)
+    : buffer_(buffer), size_(size), length_(0) {
+  if (size_ > 0) {
+    buffer_[0] = '\0';
+  }
+}
+
+void BufferWriter::Append(const char* str) { Append(str, strlen(str)); }
+
+void BufferWriter::Append(const char* str, size_t length) {
+  if (length_ + 1 < size_) {
+    size_t n = length < size_ - 1 - length_ ? length : size_ - 1 - length_;
+    memcpy(buffer_ + length_, str, n);
+    buffer_[length_ + n] = '\0';
+  }
+  length_ += length;
+}
+
+void BufferWriter::Append(char c) { Append(&c, 1); }
+
+bool FormatBasicValue(const void* data, size_t size, lldb::BasicType type,
+                      const FormatOptions& options, BufferWriter& out) {
+  switch (type) {
+    case lldb::eBasicTypeBool: {
+      if (size != 1) {
+        return false;
+      }
+      if (options.radix != Radix::kDecimal) {
+        FormatInteger(data, size, false, options.radix, out);
+      } else {
+        out.Append(ReadUnsigned(data, size) ? "true" : "false");
+      }
+      return true;
+    }
+
+    case lldb::eBasicTypeChar:
+    case lldb::eBasicTypeSignedChar:
+    case lldb::eBasicTypeUnsignedChar:
+    case lldb::eBasicTypeWChar:
+    case lldb::eBasicTypeSignedWChar:
+    case lldb::eBasicTypeUnsignedWChar:
+    case lldb::eBasicTypeChar16:
+    case lldb::eBasicTypeChar32: {
+      if (!IsSupportedIntegerSize(size)) {
+        return false;
+      }
+      if (options.radix != Radix::kDecimal) {
+        FormatInteger(data, size, false, options.radix, out);
+        return true;
+      }
+      const char* prefix = type == lldb::eBasicTypeChar16   ? "u"
+                           : type == lldb::eBasicTypeChar32 ? "U"
+                           : size > 1                       ? "L"
+                                                            : "";
+      FormatCharacter(ReadUnsigned(data, size), prefix, out);
+      return true;
+    }
+
+    case lldb::eBasicTypeShort:
+    case lldb::eBasicTypeInt:
+    case lldb::eBasicTypeLong:
+    case lldb::eBasicTypeLongLong:
+    case lldb::eBasicTypeUnsignedShort:
+    case lldb::eBasicTypeUnsignedInt:
+    case lldb::eBasicTypeUnsignedLong:
+    case lldb::eBasicTypeUnsignedLongLong: {
+      if (!IsSupportedIntegerSize(size)) {
+        return false;
+      }
+      bool is_signed = type == lldb::eBasicTypeShort ||
+                       type == lldb::eBasicTypeInt ||
+                       type == lldb::eBasicTypeLong ||
+                       type == lldb::eBasicTypeLongLong;
+      FormatInteger(data, size, is_signed, options.radix, out);
+      return true;
+    }
+
+    case lldb::eBasicTypeFloat:
+    case lldb::eBasicTypeDouble: {
+      if (size != sizeof(float) && size != sizeof(double)) {
+        return false;
+      }
+      if (options.radix != Radix::kDecimal) {
+        FormatInteger(data, size, false, options.radix, out);
+      } else if (size == sizeof(float)) {
+        float value;
+        memcpy(&value, data, sizeof(value));
+        FormatFloat(value, out);
+      } else {
+        double value;
+        memcpy(&value, data, sizeof(value));
+        FormatFloat(value, out);
+      }
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+bool FormatPointerValue(const void* data, size_t size, BufferWriter& out) {
+  if (size != sizeof(uint32_t) && size != sizeof(uint64_t)) {
+    return false;
+  }
+  FormatBits(ReadUnsigned(data, size), size, Radix::kHexadecimal, out);
+  return true;
+}
+
+bool FormatEnumValue(const void* data, size_t size, lldb::SBType type,
+                     const FormatOptions& options, BufferWriter& out) {
+  if (!IsSupportedIntegerSize(size)) {
+    return false;
+  }
+
+  if (options.radix == Radix::kDecimal) {
+    uint64_t value = ReadUnsigned(data, size);
+    uint64_t mask = size < sizeof(uint64_t)
+                        ? (uint64_t(1) << (size * 8)) - 1
+                        : ~uint64_t(0);
+
+    lldb::SBTypeEnumMemberList members = type.GetEnumMembers();
+    for (uint32_t i = 0; i < members.GetSize(); ++i) {
+      lldb::SBTypeEnumMember member = members.GetTypeEnumMemberAtIndex(i);
+      if ((member.GetValueAsUnsigned() & mask) == value) {
+        const char* name = member.GetName();
+        if (name) {
+          out.Append(name);
+          return true;
+        }
+      }
+    }
+  }
+
+  // Not an enumerator, e.g. a combination of flags. The underlying type isn't
+  // known, its signedness is inferred from the enumerators.
+  std::shared_ptr<const EnumTable> table = EnumTable::Get(type);
+  FormatInteger(data, size, !table || table->is_signed(), options.radix, out);
+  return true;
+}
+
+const char* GetBasicTypeName(lldb::BasicType type) {
+  switch (type) {
+    case lldb::eBasicTypeVoid:
+      return "void";
+    case lldb::eBasicTypeChar:
+      return "char";
+    case lldb::eBasicTypeSignedChar:
+      return "signed char";
+    case lldb::eBasicTypeUnsignedChar:
+      return "unsigned char";
+    case lldb::eBasicTypeWChar:
+      return "wchar_t";
+    case lldb::eBasicTypeChar16:
+      return "char16_t";
+    case lldb::eBasicTypeChar32:
+      return "char32_t";
+    case lldb::eBasicTypeShort:
+      return "short";
+    case lldb::eBasicTypeUnsignedShort:
+      return "unsigned short";
+    case lldb::eBasicTypeInt:
+      return "int";
+    case lldb::eBasicTypeUnsignedInt:
+      return "unsigned int";
+    case lldb::eBasicTypeLong:
+      return "long";
+    case lldb::eBasicTypeUnsignedLong:
+      return "unsigned long";
+    case lldb::eBasicTypeLongLong:
+      return "long long";
+    case lldb::eBasicTypeUnsignedLongLong:
+      return "unsigned long long";
+    case lldb::eBasicTypeBool:
+      return "bool";
+    case lldb::eBasicTypeFloat:
+      return "float";
+    case lldb::eBasicTypeDouble:
+      return "double";
+    case lldb::eBasicTypeLongDouble:
+      return "long double";
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace lldb_eval
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_FORMATTER_H_
+#define LLDB_EVAL_FORMATTER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "lldb-eval/api.h"
+#include "lldb/API/SBType.h"
+#include "lldb/lldb-enumerations.h"
+
+namespace lldb_eval {
+
+// Writes into a fixed-size buffer. Like snprintf(), it counts the characters
+// which don't fit, and the output is always null-terminated.
+class BufferWriter {
+ public:
+  BufferWriter(char* buffer, size_t size);
+
+  void Append(const char* str);
+  void Append(const char* str, size_t length);
+  void Append(char c);
+
+  // Number of characters written so far, including the ones which didn't fit.
+  size_t length() const { return length_; }
+
+ private:
+  char* buffer_;
+  size_t size_;
+  size_t length_;
+};
+
+// Formats the value of a basic type the way LLDB formats it by default. Returns
+// false if the type is not supported natively (e.g. long double).
+bool FormatBasicValue(const void* data, size_t size, lldb::BasicType type,
+                      const FormatOptions& options, BufferWriter& out);
+
+bool FormatPointerValue(const void* data, size_t size, BufferWriter& out);
+
+// Formats the value of an enumeration type as the name of the matching
+// enumerator, or as an integer if there isn't one.
+bool FormatEnumValue(const void* data, size_t size, lldb::SBType type,
+                     const FormatOptions& options, BufferWriter& out);
+
+// Returns the name of the basic type, or nullptr if it doesn't have one.
+const char* GetBasicTypeName(lldb::BasicType type);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_FORMATTER_H_
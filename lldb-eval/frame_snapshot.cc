@@ -0,0 +1,255 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/frame_snapshot.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+
+#include "lldb/API/SBBlock.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/API/SBThread.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/API/SBValueList.h"
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-enumerations.h"
+#include "lldb/lldb-types.h"
+
+namespace {
+
+// Upper bound for the number of snapshots kept alive at the same time. There is
+// usually just a handful of them (one per inspected frame), the limit protects
+// against clients walking the whole stack of every thread.
+const size_t kMaxSnapshots = 256;
+
+struct SnapshotKey {
+  uint32_t process_id;
+  uint32_t stop_id;
+  uint64_t thread_id;
+  uint32_t frame_index;
+
+  bool operator<(const SnapshotKey& other) const {
+    return std::tie(process_id, stop_id, thread_id, frame_index) <
+           std::tie(other.process_id, other.stop_id, other.thread_id,
+                    other.frame_index);
+  }
+};
+
+class SnapshotRegistry {
+ public:
+  std::shared_ptr<lldb_eval::FrameSnapshot> Get(lldb::SBFrame frame) {
+    lldb::SBThread thread = frame.GetThread();
+    lldb::SBProcess process = thread.GetProcess();
+
+    // Include the stops caused by the expression evaluation (e.g. function
+    // calls made by LLDB), they can modify the process state too.
+    SnapshotKey key = {process.GetUniqueID(),
+                       process.GetStopID(/*include_expression_stops=*/true),
+                       thread.GetThreadID(), frame.GetFrameID()};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = snapshots_.find(key);
+    if (it != snapshots_.end()) {
+      return it->second;
+    }
+
+    // The process has been resumed since the snapshots of this process were
+    // taken, the values they hold are stale.
+    for (auto i = snapshots_.begin(); i != snapshots_.end();) {
+      if (i->first.process_id == key.process_id &&
+          i->first.stop_id != key.stop_id) {
+        i = snapshots_.erase(i);
+      } else {
+        ++i;
+      }
+    }
+    if (snapshots_.size() >= kMaxSnapshots) {
+      snapshots_.clear();
+    }
+
+    auto snapshot = std::make_shared<lldb_eval::FrameSnapshot>(frame);
+    snapshots_.emplace(key, snapshot);
+    return snapshot;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshots_.clear();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<SnapshotKey, std::shared_ptr<lldb_eval::FrameSnapshot>> snapshots_;
+};
+
+SnapshotRegistry& GetSnapshotRegistry() {
+  static SnapshotRegistry* registry = new SnapshotRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+FrameSnapshot::FrameSnapshot(lldb::SBFrame frame)
+    : frame_(frame),
+      variables_enumerated_(false),
+      registers_enumerated_(false) {}
+
+std::shared_ptr<FrameSnapshot> FrameSnapshot::Get(lldb::SBFrame frame) {
+  if (!frame.IsValid()) {
+    // Nothing to cache, there are no variables in the invalid frame.
+    return std::make_shared<FrameSnapshot>(frame);
+  }
+  return GetSnapshotRegistry().Get(frame);
+}
+
+void FrameSnapshot::ClearCache() { GetSnapshotRegistry().Clear(); }
+
+lldb::SBValue FrameSnapshot::FindVariable(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!variables_enumerated_) {
+    EnumerateVariables();
+  }
+
+  auto it = variables_.find(name);
+  if (it != variables_.end()) {
+    return it->second;
+  }
+  return lldb::SBValue();
+}
+
+lldb::SBValue FrameSnapshot::FindInstanceVariable(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = instance_variables_.find(name);
+  if (it != instance_variables_.end()) {
+    return it->second;
+  }
+
+  if (!variables_enumerated_) {
+    EnumerateVariables();
+  }
+
+  lldb::SBValue value;
+  auto this_it = variables_.find("this");
+  if (this_it != variables_.end()) {
+    value = this_it->second.GetChildMemberWithName(name.c_str());
+  }
+
+  instance_variables_.emplace(name, value);
+  return value;
+}
+
+lldb::SBValue FrameSnapshot::FindRegister(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!registers_enumerated_) {
+    EnumerateRegisters();
+  }
+
+  auto it = registers_.find(name);
+  if (it != registers_.end()) {
+    return it->second;
+  }
+  return lldb::SBValue();
+}
+
+void FrameSnapshot::EnumerateVariables() {
+  variables_enumerated_ = true;
+
+  if (!frame_.IsValid()) {
+    return;
+  }
+
+  // The variables are listed starting from the outermost block of the function,
+  // so the inner declarations come last and shadow the outer ones. The globals
+  // and the statics of the compile unit are listed after all of them, they
+  // must not shadow the locals and the arguments.
+  lldb::SBValueList values =
+      frame_.GetVariables(/*arguments=*/true, /*locals=*/true,
+                          /*statics=*/true, /*in_scope_only=*/true);
+
+  // The statics declared in the blocks of the function have the same value type
+  // as the statics of the compile unit, but are scoped like the locals.
+  std::unordered_set<lldb::addr_t> function_statics;
+  for (lldb::SBBlock block = frame_.GetBlock(); block.IsValid();
+       block = block.GetParent()) {
+    lldb::SBValueList statics =
+        block.GetVariables(frame_, /*arguments=*/false, /*locals=*/false,
+                           /*statics=*/true, lldb::eNoDynamicValues);
+    for (uint32_t i = 0; i < statics.GetSize(); ++i) {
+      lldb::addr_t address = statics.GetValueAtIndex(i).GetLoadAddress();
+      if (address != LLDB_INVALID_ADDRESS) {
+        function_statics.insert(address);
+      }
+    }
+    // The outermost block of an inlined function, the blocks above it belong
+    // to the caller.
+    if (block.IsInlined()) {
+      break;
+    }
+  }
+
+  for (uint32_t i = 0; i < values.GetSize(); ++i) {
+    lldb::SBValue value = values.GetValueAtIndex(i);
+    const char* name = value.GetName();
+    if (!name) {
+      continue;
+    }
+    lldb::ValueType value_type = value.GetValueType();
+    bool is_global = value_type == lldb::eValueTypeVariableGlobal ||
+                     (value_type == lldb::eValueTypeVariableStatic &&
+                      !function_statics.count(value.GetLoadAddress()));
+    if (is_global) {
+      variables_.emplace(name, value);
+    } else {
+      variables_[name] = value;
+    }
+  }
+}
+
+void FrameSnapshot::EnumerateRegisters() {
+  registers_enumerated_ = true;
+
+  if (!frame_.IsValid()) {
+    return;
+  }
+
+  // Registers are grouped into register sets, e.g. "General Purpose Registers"
+  // and "Floating Point Registers".
+  lldb::SBValueList register_sets = frame_.GetRegisters();
+
+  for (uint32_t i = 0; i < register_sets.GetSize(); ++i) {
+    lldb::SBValue register_set = register_sets.GetValueAtIndex(i);
+
+    for (uint32_t j = 0; j < register_set.GetNumChildren(); ++j) {
+      lldb::SBValue reg = register_set.GetChildAtIndex(j);
+      const char* name = reg.GetName();
+      if (name) {
+        registers_.emplace(name, reg);
+      }
+    }
+  }
+}
+
+}  // namespace lldb_eval
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_FRAME_SNAPSHOT_H_
+#define LLDB_EVAL_FRAME_SNAPSHOT_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBValue.h"
+
+namespace lldb_eval {
+
+// FrameSnapshot holds the name -> value mapping for the variables visible in a
+// stack frame: locals, arguments, members of "this" and registers. Variables
+// are enumerated once, when the first identifier is looked up, and the
+// snapshot is shared by all evaluations in the same frame until the process is
+// resumed.
+class FrameSnapshot {
+ public:
+  explicit FrameSnapshot(lldb::SBFrame frame);
+
+  // Returns a snapshot for the given frame. Snapshots are keyed by (process,
+  // stop ID, thread, frame index), so every evaluation in the same stop gets
+  // the same instance. Snapshots of the previous stops are discarded.
+  static std::shared_ptr<FrameSnapshot> Get(lldb::SBFrame frame);
+
+  // Drops all snapshots, the variables are enumerated again on the next lookup.
+  static void ClearCache();
+
+  // Looks up a local variable or an argument (including "this").
+  lldb::SBValue FindVariable(const std::string& name);
+
+  // Looks up a member of "this", e.g. "field_" in a method of a class.
+  lldb::SBValue FindInstanceVariable(const std::string& name);
+
+  // Looks up a register by its name, e.g. "rip".
+  lldb::SBValue FindRegister(const std::string& name);
+
+ private:
+  void EnumerateVariables();
+  void EnumerateRegisters();
+
+ private:
+  std::mutex mutex_;
+  lldb::SBFrame frame_;
+
+  bool variables_enumerated_;
+  bool registers_enumerated_;
+
+  std::unordered_map<std::string, lldb::SBValue> variables_;
+  std::unordered_map<std::string, lldb::SBValue> registers_;
+  // Members of "this" are memoized on demand, including the misses. Classes can
+  // be large and expressions usually reference only a few fields.
+  std::unordered_map<std::string, lldb::SBValue> instance_variables_;
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_FRAME_SNAPSHOT_H_
@@ -0,0 +1,324 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/memory_reader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "lldb/API/SBError.h"
+
+namespace {
+
+const uint64_t kPageSize = 4096;
+
+// Most strings are short, the first chunk is small.
+const uint64_t kFirstChunkSize = 64;
+
+// Chunks of the memory blocks don't have to stay within a page, they grow
+// larger to keep the number of the reads down.
+const uint64_t kMaxBlockChunkSize = 64 * 1024;
+
+// Caches the memory read in the current stop of the process. The cache is
+// dropped when the process resumes (or another process is inspected), but the
+// stop ID doesn't change when the memory is written while the process stays
+// stopped (e.g. with lldb::SBProcess::WriteMemory), so the writes must
+// invalidate the cache explicitly.
+class StopCache {
+ public:
+  bool Read(lldb::SBProcess process, lldb::addr_t address, size_t size,
+            std::string* bytes) {
+    uint32_t process_id = process.GetUniqueID();
+    uint32_t stop_id = process.GetStopID(/*include_expression_stops=*/true);
+    uint64_t generation;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (process_id != process_id_ || stop_id != stop_id_) {
+        Clear();
+        process_id_ = process_id;
+        stop_id_ = stop_id;
+      }
+      auto it = blocks_.find(address);
+      if (it != blocks_.end() && it->second.size() >= size) {
+        bytes->assign(it->second, 0, size);
+        return true;
+      }
+      generation = generation_;
+    }
+
+    std::string buffer(size, '\0');
+    lldb::SBError error;
+    if (size > 0 &&
+        (process.ReadMemory(address, &buffer[0], size, error) != size ||
+         error.Fail())) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The memory could have been written while it was being read.
+    if (process_id == process_id_ && stop_id == stop_id_ &&
+        generation == generation_ && size <= capacity_) {
+      if (cached_bytes_ + size > capacity_) {
+        Clear();
+      }
+      std::string& cached = blocks_[address];
+      cached_bytes_ += size - std::min(cached.size(), size);
+      if (cached.size() < size) {
+        cached = buffer;
+      }
+    }
+    *bytes = std::move(buffer);
+    return true;
+  }
+
+  void Invalidate() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clear();
+    ++generation_;
+  }
+
+  void SetCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    if (cached_bytes_ > capacity_) {
+      Clear();
+    }
+  }
+
+ private:
+  void Clear() {
+    blocks_.clear();
+    cached_bytes_ = 0;
+  }
+
+  std::mutex mutex_;
+  uint32_t process_id_ = 0;
+  uint32_t stop_id_ = 0;
+  // Incremented by every invalidation.
+  uint64_t generation_ = 0;
+  std::unordered_map<lldb::addr_t, std::string> blocks_;
+  size_t cached_bytes_ = 0;
+  size_t capacity_ = lldb_eval::kDefaultStopCacheCapacity;
+};
+
+StopCache& GetStopCache() {
+  static StopCache* cache = new StopCache();
+  return *cache;
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+bool MemoryReader::ReadCString(lldb::addr_t address, size_t max_length,
+                               std::string* str, bool* terminated) {
+  str->clear();
+  *terminated = false;
+
+  uint64_t chunk_size = kFirstChunkSize;
+  char chunk[kPageSize];
+  while (str->size() < max_length) {
+    lldb::addr_t chunk_address = address + str->size();
+    uint64_t page_left = kPageSize - chunk_address % kPageSize;
+    uint64_t size = std::min<uint64_t>(
+        {chunk_size, page_left, max_length - str->size()});
+
+    size_t read = static_cast<size_t>(size);
+    if (!Read(chunk_address, chunk, read)) {
+      return false;
+    }
+
+    // memchr() is vectorized by the C library.
+    const char* end = static_cast<const char*>(memchr(chunk, '\0', read));
+    if (end) {
+      str->append(chunk, static_cast<size_t>(end - chunk));
+      *terminated = true;
+      break;
+    }
+    str->append(chunk, read);
+    chunk_size = std::min(chunk_size * 2, kPageSize);
+  }
+
+  if (read_set_) {
+    // The terminator is a part of the result too.
+    read_set_->AddMemory(address, str->size() + (*terminated ? 1 : 0));
+  }
+  return true;
+}
+
+bool MemoryReader::Compare(lldb::addr_t lhs, lldb::addr_t rhs, uint64_t size,
+                           bool* equal) {
+  uint64_t compared;
+  bool ok = CompareChunks(
+      lhs, size,
+      [this, rhs](uint64_t offset, char* buffer, size_t chunk_size) {
+        return Read(rhs + offset, buffer, chunk_size);
+      },
+      equal, &compared);
+  if (ok && read_set_) {
+    read_set_->AddMemory(lhs, compared);
+    read_set_->AddMemory(rhs, compared);
+  }
+  return ok;
+}
+
+bool MemoryReader::Compare(lldb::addr_t address, const std::string& data,
+                           bool* equal) {
+  uint64_t compared;
+  bool ok = CompareChunks(
+      address, data.size(),
+      [&data](uint64_t offset, char* buffer, size_t chunk_size) {
+        memcpy(buffer, data.data() + offset, chunk_size);
+        return true;
+      },
+      equal, &compared);
+  if (ok && read_set_) {
+    read_set_->AddMemory(address, compared);
+  }
+  return ok;
+}
+
+template <typename ReadRhs>
+bool MemoryReader::CompareChunks(lldb::addr_t lhs, uint64_t size,
+                                 ReadRhs read_rhs, bool* equal,
+                                 uint64_t* compared) {
+  *equal = true;
+  *compared = 0;
+
+  std::string lhs_chunk, rhs_chunk;
+  uint64_t chunk_size = kFirstChunkSize;
+  while (*compared < size) {
+    size_t n = static_cast<size_t>(std::min(chunk_size, size - *compared));
+    lhs_chunk.resize(n);
+    rhs_chunk.resize(n);
+    if (!Read(lhs + *compared, &lhs_chunk[0], n) ||
+        !read_rhs(*compared, &rhs_chunk[0], n)) {
+      return false;
+    }
+
+    // memcmp() is vectorized by the C library.
+    if (memcmp(lhs_chunk.data(), rhs_chunk.data(), n) != 0) {
+      // The result depends on the bytes up to the first difference.
+      auto mismatch =
+          std::mismatch(lhs_chunk.begin(), lhs_chunk.end(), rhs_chunk.begin());
+      *compared += static_cast<uint64_t>(mismatch.first - lhs_chunk.begin());
+      *compared += 1;
+      *equal = false;
+      break;
+    }
+    *compared += n;
+    chunk_size = std::min(chunk_size * 2, kMaxBlockChunkSize);
+  }
+  return true;
+}
+
+bool MemoryReader::Find(lldb::addr_t address, uint64_t size,
+                        const std::string& pattern, uint64_t* offset,
+                        bool* found) {
+  *offset = 0;
+  *found = pattern.empty();
+
+  // The window holds the bytes starting at "window_offset", the last bytes of
+  // the previous chunk are kept for the matches crossing the chunks.
+  std::string window;
+  uint64_t window_offset = 0;
+  uint64_t read_size = 0;
+  uint64_t chunk_size = kFirstChunkSize;
+  while (!*found && read_size < size && pattern.size() <= size) {
+    size_t n = static_cast<size_t>(std::min(chunk_size, size - read_size));
+    size_t kept = window.size();
+    window.resize(kept + n);
+    if (!Read(address + read_size, &window[kept], n)) {
+      return false;
+    }
+    read_size += n;
+
+    // std::string::find() looks for the first byte of the pattern with
+    // memchr(), which is vectorized by the C library.
+    size_t position = window.find(pattern);
+    if (position != std::string::npos) {
+      *offset = window_offset + position;
+      *found = true;
+      break;
+    }
+
+    size_t keep = std::min(window.size(), pattern.size() - 1);
+    window_offset += window.size() - keep;
+    window.erase(0, window.size() - keep);
+    chunk_size = std::min(chunk_size * 2, kMaxBlockChunkSize);
+  }
+
+  if (read_set_) {
+    read_set_->AddMemory(address,
+                         *found ? *offset + pattern.size() : read_size);
+  }
+  return true;
+}
+
+bool MemoryReader::ReadBlock(lldb::addr_t address, size_t size,
+                             std::string* bytes) {
+  bytes->resize(size);
+  if (size > 0 && !Read(address, &(*bytes)[0], size)) {
+    return false;
+  }
+  if (read_set_) {
+    read_set_->AddMemory(address, size);
+  }
+  return true;
+}
+
+bool MemoryReader::ReadCached(lldb::addr_t address, size_t size,
+                              std::string* bytes) {
+  if (!GetStopCache().Read(process_, address, size, bytes)) {
+    failed_address_ = address;
+    return false;
+  }
+  if (read_set_) {
+    read_set_->AddMemory(address, size);
+  }
+  return true;
+}
+
+bool MemoryReader::Read(lldb::addr_t address, char* buffer, size_t size) {
+  lldb::SBError error;
+  size_t read = process_.ReadMemory(address, buffer, size, error);
+  if (error.Fail() || read != size) {
+    failed_address_ = address;
+    return false;
+  }
+  return true;
+}
+
+void InvalidateStopCache() { GetStopCache().Invalidate(); }
+
+void SetStopCacheCapacity(size_t capacity) {
+  GetStopCache().SetCapacity(capacity);
+}
+
+uint64_t DecodeUnsigned(const std::string& bytes, uint64_t offset,
+                        uint64_t size, lldb::ByteOrder byte_order) {
+  uint64_t value = 0;
+  for (uint64_t i = 0; i < size; ++i) {
+    uint64_t index = byte_order == lldb::eByteOrderBig ? i : size - 1 - i;
+    value = (value << 8) | static_cast<uint8_t>(bytes[offset + index]);
+  }
+  return value;
+}
+
+}  // namespace lldb_eval
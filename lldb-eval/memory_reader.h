@@ -0,0 +1,107 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_MEMORY_READER_H_
+#define LLDB_EVAL_MEMORY_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "lldb-eval/read_set.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-enumerations.h"
+#include "lldb/lldb-types.h"
+
+namespace lldb_eval {
+
+// MemoryReader reads the memory of the process for the builtins, which work on
+// the raw memory rather than the LLDB values. The ranges the result depends on
+// are recorded into the optional read set.
+class MemoryReader {
+ public:
+  MemoryReader(lldb::SBProcess process, ReadSet* read_set)
+      : process_(process), read_set_(read_set) {}
+
+  // Reads the null-terminated string at the address, at most "max_length"
+  // bytes. The terminator isn't included and "terminated" tells if it was
+  // found. Returns false if the memory can't be read.
+  //
+  // The string is read in chunks, starting small and growing. The chunks never
+  // cross a page boundary, so a short string at the end of a mapped region is
+  // read fine.
+  bool ReadCString(lldb::addr_t address, size_t max_length, std::string* str,
+                   bool* terminated);
+
+  // Compares "size" bytes at the addresses, same as memcmp() == 0. The blocks
+  // are read in growing chunks and the comparison stops at the first chunk
+  // which differs. Returns false if the memory can't be read.
+  bool Compare(lldb::addr_t lhs, lldb::addr_t rhs, uint64_t size,
+               bool* equal);
+
+  // Compares the bytes at the address with the "data" of the host.
+  bool Compare(lldb::addr_t address, const std::string& data, bool* equal);
+
+  // Looks for the first occurrence of the "pattern" in the "size" bytes at the
+  // address, same as memmem(). The "offset" is the position of the match, if
+  // it was "found". Returns false if the memory can't be read.
+  bool Find(lldb::addr_t address, uint64_t size, const std::string& pattern,
+            uint64_t* offset, bool* found);
+
+  // Reads "size" bytes at the address with a single request.
+  bool ReadBlock(lldb::addr_t address, size_t size, std::string* bytes);
+
+  // Same as ReadBlock(), but the memory is cached until the process is resumed
+  // or the cache is invalidated (see InvalidateStopCache()), the objects read
+  // repeatedly (e.g. the nodes of the linked structures) are read once per
+  // stop.
+  bool ReadCached(lldb::addr_t address, size_t size, std::string* bytes);
+
+  // Address of the memory which couldn't be read by the last failed call.
+  lldb::addr_t failed_address() const { return failed_address_; }
+
+ private:
+  bool Read(lldb::addr_t address, char* buffer, size_t size);
+
+  template <typename ReadRhs>
+  bool CompareChunks(lldb::addr_t lhs, uint64_t size, ReadRhs read_rhs,
+                     bool* equal, uint64_t* compared);
+
+  lldb::SBProcess process_;
+  ReadSet* read_set_;
+  lldb::addr_t failed_address_ = LLDB_INVALID_ADDRESS;
+};
+
+// Default upper bound of the memory held by the cache of the current stop.
+const size_t kDefaultStopCacheCapacity = 16 * 1024 * 1024;
+
+// Drops the memory cached by MemoryReader::ReadCached(). Must be called after
+// the memory of the process is written while it stays stopped, the cache can't
+// detect such writes.
+void InvalidateStopCache();
+
+// Sets the maximum number of bytes held by the cache, zero disables the cache.
+void SetStopCacheCapacity(size_t capacity);
+
+// Decodes the unsigned integer of "size" bytes (at most 8) at the offset of
+// the memory read from the process.
+uint64_t DecodeUnsigned(const std::string& bytes, uint64_t offset,
+                        uint64_t size, lldb::ByteOrder byte_order);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_MEMORY_READER_H_
@@ -0,0 +1,420 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/module_index.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lldb-eval/scope_resolver.h"
+#include "lldb/API/SBFileSpec.h"
+#include "lldb/API/SBModule.h"
+#include "lldb/API/SBSymbol.h"
+#include "lldb/API/SBType.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace {
+
+// The layout of the index file (all integers are little-endian):
+//
+//   Header
+//   uint32_t types[num_types]       -- sorted offsets of the type names
+//   uint32_t globals[num_globals]   -- sorted offsets of the variable names
+//   char strings[strings_size]      -- null-terminated, deduplicated strings
+//
+// All string references are offsets in the strings section.
+
+const char kMagic[8] = {'L', 'L', 'E', 'V', 'A', 'L', 'I', 'X'};
+
+// Increment when changing the layout of the index or the way the names are
+// indexed, old indexes will be rebuilt.
+const uint32_t kVersion = 2;
+
+// Set if the module has symbols for its global variables. Variable names are
+// taken from the symbol table, without it the index can't rule out anything.
+const uint32_t kFlagHasGlobalNames = 1;
+
+enum HeaderField : uint64_t {
+  kHeaderVersion = 8,
+  kHeaderUuid = 12,
+  kHeaderFlags = 16,
+  kHeaderNumTypes = 20,
+  kHeaderTypesOffset = 24,
+  kHeaderNumGlobals = 28,
+  kHeaderGlobalsOffset = 32,
+  kHeaderStringsOffset = 36,
+  kHeaderStringsSize = 40,
+  kHeaderSize = 44,
+};
+
+// Returns the name under which the types and the variables are indexed: the
+// last component of the qualified name without template arguments, e.g. "Foo"
+// for "ns::Foo<int>".
+llvm::StringRef GetIndexKey(llvm::StringRef name) {
+  return lldb_eval::GetBaseName(name).split('<').first.trim();
+}
+
+class IndexWriter {
+ public:
+  uint32_t AddString(const std::string& str) {
+    auto it = string_offsets_.find(str);
+    if (it != string_offsets_.end()) {
+      return it->second;
+    }
+    uint32_t offset = static_cast<uint32_t>(strings_.size());
+    strings_.append(str);
+    strings_.push_back('\0');
+    string_offsets_.emplace(str, offset);
+    return offset;
+  }
+
+  std::string Write(const std::string& uuid, uint32_t flags,
+                    const std::set<std::string>& types,
+                    const std::set<std::string>& globals) {
+    uint32_t uuid_offset = AddString(uuid);
+
+    std::vector<uint32_t> type_offsets;
+    for (const auto& name : types) {
+      type_offsets.push_back(AddString(name));
+    }
+    std::vector<uint32_t> global_offsets;
+    for (const auto& name : globals) {
+      global_offsets.push_back(AddString(name));
+    }
+
+    uint64_t types_offset = kHeaderSize;
+    uint64_t globals_offset = types_offset + type_offsets.size() * 4;
+    uint64_t strings_offset = globals_offset + global_offsets.size() * 4;
+
+    std::string data(kMagic, sizeof(kMagic));
+    AppendU32(data, kVersion);
+    AppendU32(data, uuid_offset);
+    AppendU32(data, flags);
+    AppendU32(data, static_cast<uint32_t>(type_offsets.size()));
+    AppendU32(data, static_cast<uint32_t>(types_offset));
+    AppendU32(data, static_cast<uint32_t>(global_offsets.size()));
+    AppendU32(data, static_cast<uint32_t>(globals_offset));
+    AppendU32(data, static_cast<uint32_t>(strings_offset));
+    AppendU32(data, static_cast<uint32_t>(strings_.size()));
+
+    for (uint32_t offset : type_offsets) {
+      AppendU32(data, offset);
+    }
+    for (uint32_t offset : global_offsets) {
+      AppendU32(data, offset);
+    }
+    data.append(strings_);
+
+    return data;
+  }
+
+ private:
+  static void AppendU32(std::string& data, uint32_t value) {
+    char buf[4];
+    llvm::support::endian::write32le(buf, value);
+    data.append(buf, sizeof(buf));
+  }
+
+ private:
+  std::string strings_;
+  std::unordered_map<std::string, uint32_t> string_offsets_;
+};
+
+std::string GetCacheDirectory() {
+  auto env = llvm::sys::Process::GetEnv("LLDB_EVAL_INDEX_CACHE");
+  if (env) {
+    // Empty value disables the on-disk cache.
+    return *env;
+  }
+  llvm::SmallString<128> path;
+  if (!llvm::sys::path::cache_directory(path)) {
+    return "";
+  }
+  llvm::sys::path::append(path, "lldb-eval");
+  return path.str().str();
+}
+
+// Returns the path of the index file for the module, or an empty string if
+// the index can't be cached.
+std::string GetCachePath(lldb::SBModule module) {
+  // Without UUID there is no way to tell if the index on disk is up-to-date.
+  const char* uuid = module.GetUUIDString();
+  std::string cache_dir = GetCacheDirectory();
+  if (!uuid || !*uuid || cache_dir.empty()) {
+    return "";
+  }
+  llvm::SmallString<128> path(cache_dir);
+  llvm::sys::path::append(path, std::string(uuid) + ".idx");
+  return path.str().str();
+}
+
+class IndexRegistry {
+ public:
+  // Returns false if the module hasn't been seen yet. Otherwise sets "index",
+  // which is nullptr if the index is not available.
+  bool Lookup(const std::string& key,
+              std::shared_ptr<lldb_eval::ModuleIndex>* index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = indexes_.find(key);
+    if (it == indexes_.end()) {
+      return false;
+    }
+    *index = it->second;
+    return true;
+  }
+
+  // Registers the index for the module, nullptr marks it as not available.
+  // Returns the registered index, which can be different from the given one if
+  // another thread has built the same index in the meantime.
+  std::shared_ptr<lldb_eval::ModuleIndex> Add(
+      const std::string& key, std::shared_ptr<lldb_eval::ModuleIndex> index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& registered = indexes_[key];
+    if (!registered) {
+      registered = index;
+    }
+    return registered;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<lldb_eval::ModuleIndex>>
+      indexes_;
+};
+
+IndexRegistry& GetIndexRegistry() {
+  static IndexRegistry* registry = new IndexRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+std::string GetModuleKey(lldb::SBModule module) {
+  if (!module.IsValid()) {
+    return "";
+  }
+  const char* uuid = module.GetUUIDString();
+  if (uuid) {
+    return uuid;
+  }
+  char path[4096];
+  module.GetFileSpec().GetPath(path, sizeof(path));
+  return path;
+}
+
+ModuleIndex::ModuleIndex(std::unique_ptr<llvm::MemoryBuffer> buffer)
+    : buffer_(std::move(buffer)) {}
+
+std::shared_ptr<ModuleIndex> ModuleIndex::Get(lldb::SBModule module) {
+  std::shared_ptr<ModuleIndex> index = Find(module);
+  if (index || !module.IsValid()) {
+    return index;
+  }
+
+  index = Build(module);
+  std::string path = GetCachePath(module);
+  if (!path.empty()) {
+    // The cache is best-effort, the index is usable even if it's not saved.
+    index->Save(path);
+  }
+
+  return GetIndexRegistry().Add(GetModuleKey(module), index);
+}
+
+std::shared_ptr<ModuleIndex> ModuleIndex::Find(lldb::SBModule module) {
+  if (!module.IsValid()) {
+    return nullptr;
+  }
+
+  std::string key = GetModuleKey(module);
+  std::shared_ptr<ModuleIndex> index;
+  if (GetIndexRegistry().Lookup(key, &index)) {
+    return index;
+  }
+
+  // Check the disk only once, the index can be built later by Get().
+  std::string path = GetCachePath(module);
+  if (!path.empty()) {
+    index = Load(path, module.GetUUIDString());
+  }
+
+  return GetIndexRegistry().Add(key, index);
+}
+
+std::unique_ptr<ModuleIndex> ModuleIndex::Build(lldb::SBModule module) {
+  const char* uuid = module.GetUUIDString();
+
+  std::set<std::string> types;
+  std::set<std::string> globals;
+
+  lldb::SBTypeList type_list = module.GetTypes(lldb::eTypeClassAny);
+  for (uint32_t i = 0; i < type_list.GetSize(); ++i) {
+    lldb::SBType type = type_list.GetTypeAtIndex(i);
+    const char* name = type.GetName();
+    if (!name || !*name) {
+      continue;
+    }
+    types.insert(GetIndexKey(name).str());
+  }
+
+  size_t num_symbols = module.GetNumSymbols();
+  for (size_t i = 0; i < num_symbols; ++i) {
+    lldb::SBSymbol symbol = module.GetSymbolAtIndex(i);
+    const char* name = symbol.GetName();
+    if (symbol.GetType() == lldb::eSymbolTypeData && name && *name) {
+      globals.insert(GetIndexKey(name).str());
+    }
+  }
+
+  uint32_t flags = globals.empty() ? 0 : kFlagHasGlobalNames;
+
+  IndexWriter writer;
+  std::string data =
+      writer.Write(uuid ? uuid : "", flags, types, globals);
+
+  return std::unique_ptr<ModuleIndex>(
+      new ModuleIndex(llvm::MemoryBuffer::getMemBufferCopy(data, "<index>")));
+}
+
+std::unique_ptr<ModuleIndex> ModuleIndex::Load(const std::string& path,
+                                               llvm::StringRef uuid) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    return nullptr;
+  }
+
+  std::unique_ptr<ModuleIndex> index(new ModuleIndex(std::move(*buffer)));
+  if (!index->Validate() || index->uuid() != uuid) {
+    return nullptr;
+  }
+  return index;
+}
+
+bool ModuleIndex::Save(const std::string& path) const {
+  llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path));
+
+  // Write to a temporary file first, so that other sessions never see a
+  // partially written index.
+  int fd;
+  llvm::SmallString<128> temp_path;
+  if (llvm::sys::fs::createUniqueFile(path + ".tmp-%%%%%%", fd, temp_path)) {
+    return false;
+  }
+
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  os << data();
+  os.close();
+  if (os.has_error()) {
+    os.clear_error();
+    llvm::sys::fs::remove(temp_path);
+    return false;
+  }
+
+  if (llvm::sys::fs::rename(temp_path, path)) {
+    llvm::sys::fs::remove(temp_path);
+    return false;
+  }
+  return true;
+}
+
+llvm::StringRef ModuleIndex::uuid() const {
+  return ReadString(ReadU32(kHeaderUuid));
+}
+
+bool ModuleIndex::MayContainType(llvm::StringRef name) const {
+  return FindString(ReadU32(kHeaderTypesOffset), ReadU32(kHeaderNumTypes),
+                    GetIndexKey(name));
+}
+
+bool ModuleIndex::MayContainGlobalVariable(llvm::StringRef name) const {
+  if (!(ReadU32(kHeaderFlags) & kFlagHasGlobalNames)) {
+    return true;
+  }
+  return FindString(ReadU32(kHeaderGlobalsOffset), ReadU32(kHeaderNumGlobals),
+                    GetIndexKey(name));
+}
+
+bool ModuleIndex::Validate() const {
+  llvm::StringRef data = buffer_->getBuffer();
+  if (data.size() < kHeaderSize ||
+      std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 ||
+      ReadU32(kHeaderVersion) != kVersion) {
+    return false;
+  }
+
+  auto table_fits = [&data](uint64_t offset, uint64_t count,
+                            uint64_t entry_size) {
+    return offset <= data.size() && count * entry_size <= data.size() - offset;
+  };
+
+  uint64_t strings_offset = ReadU32(kHeaderStringsOffset);
+  uint64_t strings_size = ReadU32(kHeaderStringsSize);
+
+  // Strings must be null-terminated, so that reading them never goes out of
+  // bounds.
+  return table_fits(ReadU32(kHeaderTypesOffset), ReadU32(kHeaderNumTypes), 4) &&
+         table_fits(ReadU32(kHeaderGlobalsOffset), ReadU32(kHeaderNumGlobals),
+                    4) &&
+         table_fits(strings_offset, strings_size, 1) && strings_size > 0 &&
+         data[strings_offset + strings_size - 1] == '\0';
+}
+
+uint32_t ModuleIndex::ReadU32(uint64_t offset) const {
+  return llvm::support::endian::read32le(buffer_->getBufferStart() + offset);
+}
+
+llvm::StringRef ModuleIndex::ReadString(uint32_t offset) const {
+  uint32_t strings_size = ReadU32(kHeaderStringsSize);
+  if (offset >= strings_size) {
+    return llvm::StringRef();
+  }
+  const char* str =
+      buffer_->getBufferStart() + ReadU32(kHeaderStringsOffset) + offset;
+  return llvm::StringRef(str, strings_size - offset).split('\0').first;
+}
+
+bool ModuleIndex::FindString(uint64_t table_offset, uint32_t size,
+                             llvm::StringRef str) const {
+  uint32_t lo = 0;
+  uint32_t hi = size;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    int cmp = ReadString(ReadU32(table_offset + mid * 4)).compare(str);
+    if (cmp < 0) {
+      lo = mid + 1;
+    } else if (cmp > 0) {
+      hi = mid;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace lldb_eval
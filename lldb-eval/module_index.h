@@ -0,0 +1,106 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_MODULE_INDEX_H_
+#define LLDB_EVAL_MODULE_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "lldb/API/SBModule.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace lldb_eval {
+
+// Returns a string identifying the module, e.g. its UUID or its path.
+std::string GetModuleKey(lldb::SBModule module);
+
+// ModuleIndex is a compact summary of the debug information of a module: the
+// names of the types and global variables defined in it. It's only a filter:
+//  - type lookups skip the modules which can't define the type, without asking
+//    LLDB;
+//  - global variable lookups search the modules ruled out by their indexes
+//    last, since the index doesn't know about the folded constants (see
+//    MayContainGlobalVariable()). A name which isn't defined anywhere is still
+//    looked up in every module.
+// The record layouts and the member offsets aren't indexed. The SB API doesn't
+// tell the module of a type, so the layouts couldn't be matched with the types
+// the interpreter works with.
+//
+// Indexes are stored on disk in the cache directory, one file per module UUID,
+// and are memory-mapped on load. The directory is specified by the
+// LLDB_EVAL_INDEX_CACHE environment variable and defaults to
+// "<user cache directory>/lldb-eval".
+class ModuleIndex {
+ public:
+  // Returns the index for the module. The index is loaded from the cache
+  // directory if there is an up-to-date one, otherwise it's built and saved.
+  // Returns nullptr if the module is invalid.
+  static std::shared_ptr<ModuleIndex> Get(lldb::SBModule module);
+
+  // Same as Get(), but never builds the index. Returns nullptr if the index is
+  // neither built nor cached on disk yet.
+  static std::shared_ptr<ModuleIndex> Find(lldb::SBModule module);
+
+  // Builds the index for the module from its debug information and symbols.
+  static std::unique_ptr<ModuleIndex> Build(lldb::SBModule module);
+
+  // Loads the index from the file. Returns nullptr if the file doesn't exist,
+  // is corrupted or was built for a module with a different UUID.
+  static std::unique_ptr<ModuleIndex> Load(const std::string& path,
+                                           llvm::StringRef uuid);
+
+  // Writes the index to the file. Returns false on failure.
+  bool Save(const std::string& path) const;
+
+  llvm::StringRef uuid() const;
+
+  // Checks if the module may define a type with the given name. Names are
+  // compared by their last component without the template arguments, so
+  // "ns::Foo<int>" matches any "Foo".
+  bool MayContainType(llvm::StringRef name) const;
+
+  // Checks if the module may define a global or static variable with the given
+  // name. Names are compared the same way as for the types. The variables are
+  // indexed by their symbols, so a miss doesn't rule out the constants folded
+  // by the compiler (e.g. "static const int" members), which have none.
+  bool MayContainGlobalVariable(llvm::StringRef name) const;
+
+  // Serialized representation of the index.
+  llvm::StringRef data() const { return buffer_->getBuffer(); }
+
+ private:
+  explicit ModuleIndex(std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+  // Checks the header and the bounds of all tables. Doesn't check the UUID.
+  bool Validate() const;
+
+  uint32_t ReadU32(uint64_t offset) const;
+  llvm::StringRef ReadString(uint32_t offset) const;
+
+  // Binary searches the sorted table of string offsets.
+  bool FindString(uint64_t table_offset, uint32_t size,
+                  llvm::StringRef str) const;
+
+ private:
+  std::unique_ptr<llvm::MemoryBuffer> buffer_;
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_MODULE_INDEX_H_
@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/LangOptions.h"
@@ -189,6 +190,11 @@ void Parser::ConsumeToken() {
     return;
   }
   pp_->Lex(token_);
+
+  // The lexer knows "@" only in Objective-C mode.
+  if (token_.is(clang::tok::unknown) && pp_->getSpelling(token_) == "@") {
+    token_.setKind(clang::tok::at);
+  }
 }
 
 void Parser::BailOut(const std::string& error, clang::SourceLocation loc) {
@@ -374,22 +380,42 @@ ExprResult Parser::ParseRelationalExpression() {
 // Parse a shift_expression.
 //
 //  shift_expression:
-//    additive_expression {"<<" additive_expression}
-//    additive_expression {">>" additive_expression}
+//    artificial_array_expression {"<<" artificial_array_expression}
+//    artificial_array_expression {">>" artificial_array_expression}
 //
 ExprResult Parser::ParseShiftExpression() {
-  auto lhs = ParseAdditiveExpression();
+  auto lhs = ParseArtificialArrayExpression();
 
   while (token_.isOneOf(clang::tok::lessless, clang::tok::greatergreater)) {
     clang::tok::TokenKind kind = token_.getKind();
     ConsumeToken();
-    auto rhs = ParseAdditiveExpression();
+    auto rhs = ParseArtificialArrayExpression();
     lhs = std::make_unique<BinaryOpNode>(kind, std::move(lhs), std::move(rhs));
   }
 
   return lhs;
 }
 
+// Parse an artificial_array_expression. This is a GDB extension, "p@n" is an
+// array of "n" objects starting at "p". It binds tighter than the shifts and
+// looser than the additions, like in GDB.
+//
+//  artificial_array_expression:
+//    additive_expression {"@" additive_expression}
+//
+ExprResult Parser::ParseArtificialArrayExpression() {
+  auto lhs = ParseAdditiveExpression();
+
+  while (token_.is(clang::tok::at)) {
+    ConsumeToken();
+    auto rhs = ParseAdditiveExpression();
+    lhs = std::make_unique<BinaryOpNode>(clang::tok::at, std::move(lhs),
+                                         std::move(rhs));
+  }
+
+  return lhs;
+}
+
 // Parse an additive_expression.
 //
 //  additive_expression:
@@ -505,8 +531,11 @@ ExprResult Parser::ParseUnaryExpression() {
 //
 //  postfix_expression:
 //    primary_expression {"[" expression "]"}
+//    primary_expression {"[" expression ":" expression "]"}
 //    primary_expression {"." id_expression}
 //    primary_expression {"->" id_expression}
+//    primary_expression {"." id_expression "(" [argument_list] ")"}
+//    primary_expression {"->" id_expression "(" [argument_list] ")"}
 //    primary_expression {"++"}
 //    primary_expression {"--"}
 //
@@ -524,6 +553,12 @@ ExprResult Parser::ParsePostfixExpression() {
                         : MemberOfNode::Type::OF_POINTER;
         ConsumeToken();
         auto member_id = ParseIdExpression();
+        if (token_.is(clang::tok::l_paren)) {
+          auto args = ParseArgumentList();
+          lhs = std::make_unique<MethodCallNode>(
+              type, std::move(lhs), member_id->name(), std::move(args));
+          break;
+        }
         lhs = std::make_unique<MemberOfNode>(type, std::move(lhs),
                                              std::move(member_id));
         break;
@@ -538,6 +573,15 @@ ExprResult Parser::ParsePostfixExpression() {
       case clang::tok::l_square: {
         ConsumeToken();
         auto rhs = ParseExpression();
+        if (token_.is(clang::tok::colon)) {
+          ConsumeToken();
+          auto end = ParseExpression();
+          Expect(clang::tok::r_square);
+          ConsumeToken();
+          lhs = std::make_unique<ArraySliceNode>(std::move(lhs), std::move(rhs),
+                                                 std::move(end));
+          break;
+        }
         Expect(clang::tok::r_square);
         ConsumeToken();
         lhs = std::make_unique<BinaryOpNode>(clang::tok::l_square,
@@ -560,7 +604,9 @@ ExprResult Parser::ParsePostfixExpression() {
 //  primary_expression:
 //    numeric_literal
 //    boolean_literal
+//    string_literal
 //    id_expression
+//    builtin_call
 //    "this"
 //    "(" expression ")"
 //
@@ -569,8 +615,22 @@ ExprResult Parser::ParsePrimaryExpression() {
     return ParseNumericLiteral();
   } else if (token_.isOneOf(clang::tok::kw_true, clang::tok::kw_false)) {
     return ParseBooleanLiteral();
+  } else if (token_.is(clang::tok::string_literal)) {
+    return ParseStringLiteral();
+  } else if (token_.isOneOf(clang::tok::wide_string_literal,
+                            clang::tok::utf8_string_literal,
+                            clang::tok::utf16_string_literal,
+                            clang::tok::utf32_string_literal)) {
+    BailOut("Only narrow string literals are supported: " +
+                TokenDescription(token_),
+            token_.getLocation());
+    return std::make_unique<ErrorNode>();
   } else if (token_.isOneOf(clang::tok::coloncolon, clang::tok::identifier)) {
-    return ParseIdExpression();
+    auto id_expression = ParseIdExpression();
+    if (token_.is(clang::tok::l_paren)) {
+      return ParseBuiltinCall(id_expression->name());
+    }
+    return id_expression;
   } else if (token_.is(clang::tok::kw_this)) {
     ConsumeToken();
     return std::make_unique<IdentifierNode>("this");
@@ -587,6 +647,39 @@ ExprResult Parser::ParsePrimaryExpression() {
   return std::make_unique<ErrorNode>();
 }
 
+// Parse a builtin_call, the function name is already consumed.
+//
+//  builtin_call:
+//    identifier "(" [argument_list] ")"
+//
+ExprResult Parser::ParseBuiltinCall(const std::string& name) {
+  auto args = ParseArgumentList();
+  return std::make_unique<CallNode>(name, std::move(args));
+}
+
+// Parse the parenthesized arguments of a call.
+//
+//  argument_list:
+//    assignment_expression {"," assignment_expression}
+//
+std::vector<ExprResult> Parser::ParseArgumentList() {
+  Expect(clang::tok::l_paren);
+  ConsumeToken();
+
+  std::vector<ExprResult> args;
+  if (!token_.is(clang::tok::r_paren)) {
+    args.push_back(ParseAssignmentExpression());
+    while (token_.is(clang::tok::comma)) {
+      ConsumeToken();
+      args.push_back(ParseAssignmentExpression());
+    }
+  }
+
+  Expect(clang::tok::r_paren);
+  ConsumeToken();
+  return args;
+}
+
 // Parse a type_id.
 //
 //  type_id:
@@ -646,6 +739,7 @@ void Parser::ParseTypeSpecifierSeq(TypeDeclaration* type_decl) {
 //    "unsigned"
 //    "float"
 //    "double"
+//    "__int128"
 //    "void"
 //
 // Returns TRUE if a type_specifier was successfully parsed at this location.
@@ -969,7 +1063,7 @@ bool Parser::IsSimpleTypeSpecifierKeyword(clang::Token token) const {
       clang::tok::kw_wchar_t, clang::tok::kw_bool, clang::tok::kw_short,
       clang::tok::kw_int, clang::tok::kw_long, clang::tok::kw_signed,
       clang::tok::kw_unsigned, clang::tok::kw_float, clang::tok::kw_double,
-      clang::tok::kw_void);
+      clang::tok::kw___int128, clang::tok::kw_void);
 }
 
 bool Parser::IsCvQualifier(clang::Token token) const {
@@ -1046,6 +1140,30 @@ std::string Parser::ParseUnqualifiedId() {
   return identifier;
 }
 
+// Parse a string_literal. Adjacent literals are concatenated, e.g. "a" "b".
+//
+//  string_literal:
+//    ? clang::tok::string_literal ? {? clang::tok::string_literal ?}
+//
+ExprResult Parser::ParseStringLiteral() {
+  Expect(clang::tok::string_literal);
+  std::vector<clang::Token> tokens;
+  while (token_.is(clang::tok::string_literal)) {
+    tokens.push_back(token_);
+    ConsumeToken();
+  }
+
+  clang::StringLiteralParser literal(tokens, *pp_);
+  if (literal.hadError || !literal.isAscii()) {
+    BailOut("Failed to parse token as string-literal: " +
+                TokenDescription(tokens[0]),
+            tokens[0].getLocation());
+    return std::make_unique<ErrorNode>();
+  }
+
+  return std::make_unique<StringLiteralNode>(literal.GetString().str());
+}
+
 // Parse a numeric_literal.
 //
 //  numeric_literal:
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/LangOptions.h"
@@ -74,12 +75,15 @@ class Parser {
   ExprResult ParseEqualityExpression();
   ExprResult ParseRelationalExpression();
   ExprResult ParseShiftExpression();
+  ExprResult ParseArtificialArrayExpression();
   ExprResult ParseAdditiveExpression();
   ExprResult ParseMultiplicativeExpression();
   ExprResult ParseCastExpression();
   ExprResult ParseUnaryExpression();
   ExprResult ParsePostfixExpression();
   ExprResult ParsePrimaryExpression();
+  ExprResult ParseBuiltinCall(const std::string& name);
+  std::vector<ExprResult> ParseArgumentList();
 
   TypeDeclaration ParseTypeId();
   void ParseTypeSpecifierSeq(TypeDeclaration* type_decl);
@@ -102,6 +106,7 @@ class Parser {
   std::string ParseUnqualifiedId();
 
   ExprResult ParseNumericLiteral();
+  ExprResult ParseStringLiteral();
   ExprResult ParseBooleanLiteral();
 
   ExprResult ParseNumericConstant(clang::Token token);
@@ -16,9 +16,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "lldb-eval/api.h"
+#include "lldb-eval/ast_printer.h"
+#include "lldb-eval/ast_serialization.h"
 #include "lldb-eval/expression_context.h"
 #include "lldb/API/SBExecutionContext.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 // DISALLOW_COPY_AND_ASSIGN is also defined in
 // lldb/lldb-defines.h
@@ -40,6 +45,22 @@ lldb_eval::Parser::Error ParseExpr(const std::string& expr) {
   return parser.GetError();
 }
 
+std::string PrintCanonical(const std::string& expr) {
+  lldb_eval::ExpressionContext expr_ctx(expr, lldb::SBExecutionContext());
+  lldb_eval::Parser parser(expr_ctx);
+  auto tree = parser.Run();
+  EXPECT_EQ(parser.GetError(), "");
+  return lldb_eval::PrintCanonical(tree.get());
+}
+
+lldb_eval::ExprResult ParseTree(const std::string& expr) {
+  lldb_eval::ExpressionContext expr_ctx(expr, lldb::SBExecutionContext());
+  lldb_eval::Parser parser(expr_ctx);
+  auto tree = parser.Run();
+  EXPECT_EQ(parser.GetError(), "");
+  return tree;
+}
+
 class ParserTest : public ::testing::Test {
  protected:
   void TestExpr(const std::string& expr) {
@@ -74,6 +95,29 @@ TEST_F(ParserTest, TestUnbalancedParentheses) {
 
 TEST_F(ParserTest, TestMemberAccess) { TestExpr("foo->bar.baz"); }
 
+TEST_F(ParserTest, TestBuiltinCall) {
+  TestExpr("sum(a)");
+  TestExpr("count(a, _ > 1)");
+  TestExpr("f()");
+  TestExprErr("sum(a, )", "Unexpected token: <')' (r_paren)>");
+  TestExprErr("sum(a", "expected 'r_paren', got: <'' (eof)>");
+}
+
+TEST_F(ParserTest, TestStringLiteral) {
+  TestExpr("\"foo\"");
+  TestExpr("streq(s, \"foo\" \"bar\")");
+  TestExprErr("L\"foo\"", "Only narrow string literals are supported");
+  TestExprErr("u8\"foo\"", "Only narrow string literals are supported");
+}
+
+TEST_F(ParserTest, TestMethodCall) {
+  TestExpr("v.size()");
+  TestExpr("p->get()->x");
+  TestExpr("v.data()[1]");
+  TestExpr("m.count(a, b)");
+  TestExprErr("v.size(", "Unexpected token: <'' (eof)>");
+}
+
 TEST_F(ParserTest, TestMemberAccessInvalid) {
   auto msg =
       "<expr>:1:6: expected 'identifier', got: <'2' (numeric_constant)>\n"
@@ -146,4 +190,126 @@ TEST_F(ParserTest, TestTemplateTypes) {
               "       ^      ");
 }
 
+TEST_F(ParserTest, TestCanonicalForm) {
+  EXPECT_EQ(PrintCanonical("a+b"), "a + b");
+  EXPECT_EQ(PrintCanonical("(a)  +  b"), "a + b");
+  EXPECT_EQ(PrintCanonical("((a + b))"), "a + b");
+  EXPECT_EQ(PrintCanonical("(a + b) * c"), "(a + b) * c");
+  EXPECT_EQ(PrintCanonical("a + (b * c)"), "a + b * c");
+  EXPECT_EQ(PrintCanonical("(a - b) - c"), "a - b - c");
+  EXPECT_EQ(PrintCanonical("a - (b - c)"), "a - (b - c)");
+  EXPECT_EQ(PrintCanonical("a || (b && c)"), "a || b && c");
+  EXPECT_EQ(PrintCanonical("(a ? b : c) ? d : (e ? f : g)"),
+            "(a ? b : c) ? d : e ? f : g");
+  EXPECT_EQ(PrintCanonical("- -a"), "- -a");
+  EXPECT_EQ(PrintCanonical("-(-a)"), "- -a");
+  EXPECT_EQ(PrintCanonical("(*p).x"), "(*p).x");
+  EXPECT_EQ(PrintCanonical("(p->a)[ 1 ].b"), "p->a[1].b");
+  EXPECT_EQ(PrintCanonical("(long int)1"), "(long)1");
+  EXPECT_EQ(PrintCanonical("(char*)p"), "(char *)p");
+  EXPECT_EQ(PrintCanonical("((char*)p)->x"), "((char *)p)->x");
+  EXPECT_EQ(PrintCanonical("(true)"), "true");
+  EXPECT_EQ(PrintCanonical("a[ 1 : n+1 ]"), "a[1:n + 1]");
+  EXPECT_EQ(PrintCanonical("(*p)@(n+1)"), "*p @ n + 1");
+  EXPECT_EQ(PrintCanonical("(p@n) << 1"), "p @ n << 1");
+  EXPECT_EQ(PrintCanonical("p@(n << 1)"), "p @ (n << 1)");
+  EXPECT_EQ(PrintCanonical("count( a[0:n] ,(_.x>1) )"),
+            "count(a[0:n], _.x > 1)");
+  EXPECT_EQ(PrintCanonical("sum(a)*2"), "sum(a) * 2");
+  EXPECT_EQ(PrintCanonical("(v) . size ( )"), "v.size()");
+  EXPECT_EQ(PrintCanonical("(*p)->get()[ 1 ]"), "(*p)->get()[1]");
+  EXPECT_EQ(PrintCanonical("\"foo\"  \"bar\""), "\"foobar\"");
+  EXPECT_EQ(PrintCanonical("\"a\\\"b\\\\\\n\\x01\""),
+            "\"a\\\"b\\\\\\n\\001\"");
+
+  EXPECT_EQ(PrintCanonical("0x10 + 1u + 1ULL"), "16 + 1u + 1ull");
+  EXPECT_EQ(PrintCanonical("1.50 + 2.f + 1e10"), "1.5 + 2.0f + 1e+10");
+
+  // The canonical form parses to the same tree.
+  for (const char* expr :
+       {"(a + b) * c", "- -a", "((char*)p)->x[1]", "a ? b : c ? d : e",
+        "1.5 + 2.f + 3000000000", "~(a & b) | c ^ d"}) {
+    std::string canonical = PrintCanonical(expr);
+    EXPECT_EQ(PrintCanonical(canonical), canonical);
+  }
+
+  // The hash depends only on the canonical form.
+  lldb_eval::ExpressionKey key = lldb_eval::GetExpressionKey("a + b");
+  EXPECT_EQ(key.canonical, "a + b");
+  EXPECT_EQ(key.hash_low, lldb_eval::GetExpressionKey("a + b").hash_low);
+  EXPECT_EQ(key.hash_high, lldb_eval::GetExpressionKey("a + b").hash_high);
+  EXPECT_NE(key.hash_low, lldb_eval::GetExpressionKey("a - b").hash_low);
+  EXPECT_NE(key.hash_low, key.hash_high);
+}
+
+TEST_F(ParserTest, TestSerialization) {
+  std::vector<std::string> exprs = {
+      "1 + 2 * (4 - 5) + 6 / 3 - (7 % 8)",
+      "1 || 2 && 3 >> 4 << 5 * (7 ^ 8)",
+      "foo->bar.baz",
+      "(int)1",
+      "(long long)1",
+      "(unsigned long)1",
+      "(long const long)1",
+      "(char*)1",
+      "(long long**)1",
+      "(long*&)1",
+      "(const long const long const* const const)1",
+      "true ? 1.5f : -~a[2]",
+      "!x != 3000000000 && -1.25e-10 <= 0xffffffffffffffff",
+      "a[1:n + 1]",
+      "p[0] @ n << 2",
+      "sum(a) + count(a, _->x > 1)",
+      "streq(s, \"a\\\"b\\n\")",
+      "v.size() + p->get()->x + m.count(a, 1)",
+  };
+
+  std::vector<lldb_eval::ExprResult> trees;
+  for (const auto& expr : exprs) {
+    SCOPED_TRACE("[serializing expr]: " + expr);
+    trees.push_back(ParseTree(expr));
+
+    std::string data = lldb_eval::SerializeAst(trees.back().get());
+    std::string error;
+    auto tree = lldb_eval::DeserializeAst(data, &error);
+    ASSERT_TRUE(tree) << error;
+    EXPECT_EQ(lldb_eval::PrintCanonical(tree.get()),
+              lldb_eval::PrintCanonical(trees.back().get()));
+    EXPECT_EQ(lldb_eval::SerializeAst(tree.get()), data);
+  }
+
+  std::string data = lldb_eval::SerializeAst(trees[0].get());
+  std::string error;
+  EXPECT_FALSE(lldb_eval::DeserializeAst(data.substr(0, data.size() - 1),
+                                         &error));
+  EXPECT_THAT(error, HasSubstr("unexpected end of data"));
+  EXPECT_FALSE(lldb_eval::DeserializeAst(data + "x", &error));
+  EXPECT_THAT(error, HasSubstr("unexpected data after the expression"));
+  EXPECT_FALSE(lldb_eval::DeserializeAst("1 + 2", &error));
+  EXPECT_EQ(error, "not an encoded expression");
+  data[8] = 2;
+  EXPECT_FALSE(lldb_eval::DeserializeAst(data, &error));
+  EXPECT_EQ(error, "unsupported encoding version 2");
+
+  std::vector<const lldb_eval::AstNode*> library_trees;
+  for (const auto& tree : trees) {
+    library_trees.push_back(tree.get());
+  }
+  std::string library_data = lldb_eval::AstLibrary::Build(library_trees);
+  auto library = lldb_eval::AstLibrary::Create(
+      llvm::MemoryBuffer::getMemBuffer(library_data), &error);
+  ASSERT_TRUE(library) << error;
+  ASSERT_EQ(library->size(), trees.size());
+  for (uint32_t i = 0; i < library->size(); ++i) {
+    auto tree = library->Load(i, &error);
+    ASSERT_TRUE(tree) << error;
+    EXPECT_EQ(lldb_eval::PrintCanonical(tree.get()),
+              lldb_eval::PrintCanonical(trees[i].get()));
+  }
+  EXPECT_FALSE(library->Load(library->size(), &error));
+
+  EXPECT_FALSE(lldb_eval::AstLibrary::Create(
+      llvm::MemoryBuffer::getMemBuffer(library_data.substr(0, 20)), &error));
+}
+
 }  // namespace
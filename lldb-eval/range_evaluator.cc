@@ -0,0 +1,1370 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/range_evaluator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "clang/Basic/TokenKinds.h"
+#include "lldb-eval/api.h"
+#include "lldb-eval/ast.h"
+#include "lldb-eval/eval.h"
+#include "lldb-eval/expression_context.h"
+#include "lldb-eval/read_set.h"
+#include "lldb-eval/scalar.h"
+#include "lldb-eval/scalar_dispatch.h"
+#include "lldb-eval/value.h"
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/API/SBTarget.h"
+#include "lldb/API/SBType.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-enumerations.h"
+#include "lldb/lldb-types.h"
+
+namespace {
+
+using lldb_eval::AstNode;
+using lldb_eval::DispatchIntegerType;
+using lldb_eval::DispatchType;
+using lldb_eval::EvalError;
+using lldb_eval::EvalErrorCode;
+using lldb_eval::GetScalarType;
+using lldb_eval::IsInteger;
+using lldb_eval::Scalar;
+using lldb_eval::Value;
+
+// Objects closer than this are read with a single request, reading the gap is
+// cheaper than another request.
+const uint64_t kMaxGap = 4096;
+
+// Largest single read request.
+const uint64_t kMaxReadSize = 1024 * 1024;
+
+lldb::ByteOrder GetHostByteOrder() {
+  uint16_t probe = 1;
+  uint8_t first_byte;
+  memcpy(&first_byte, &probe, sizeof(first_byte));
+  return first_byte ? lldb::eByteOrderLittle : lldb::eByteOrderBig;
+}
+
+// Finds the nodes whose value depends on the index variable.
+class IndexUseFinder : lldb_eval::Visitor {
+ public:
+  explicit IndexUseFinder(const std::string& index_name)
+      : index_name_(index_name) {}
+
+  std::unordered_set<const AstNode*> Find(const AstNode* tree) {
+    nodes_.clear();
+    Uses(tree);
+    return std::move(nodes_);
+  }
+
+ private:
+  bool Uses(const AstNode* node) {
+    node->Accept(this);
+    if (uses_) {
+      nodes_.insert(node);
+    }
+    return uses_;
+  }
+
+  void Visit(const lldb_eval::ErrorNode*) override { uses_ = false; }
+
+  void Visit(const lldb_eval::BooleanLiteralNode*) override { uses_ = false; }
+
+  void Visit(const lldb_eval::NumericLiteralNode*) override { uses_ = false; }
+
+  void Visit(const lldb_eval::StringLiteralNode*) override { uses_ = false; }
+
+  void Visit(const lldb_eval::IdentifierNode* node) override {
+    uses_ = node->name() == index_name_;
+  }
+
+  void Visit(const lldb_eval::CStyleCastNode* node) override {
+    uses_ = Uses(node->rhs());
+  }
+
+  void Visit(const lldb_eval::MemberOfNode* node) override {
+    uses_ = Uses(node->lhs());
+  }
+
+  void Visit(const lldb_eval::BinaryOpNode* node) override {
+    bool lhs = Uses(node->lhs());
+    bool rhs = Uses(node->rhs());
+    uses_ = lhs || rhs;
+  }
+
+  void Visit(const lldb_eval::ArraySliceNode* node) override {
+    bool base = Uses(node->base());
+    bool begin = Uses(node->begin());
+    bool end = Uses(node->end());
+    uses_ = base || begin || end;
+  }
+
+  void Visit(const lldb_eval::CallNode* node) override {
+    bool uses = false;
+    for (size_t i = 0; i < node->num_args(); ++i) {
+      uses = Uses(node->arg(i)) || uses;
+    }
+    uses_ = uses;
+  }
+
+  void Visit(const lldb_eval::MethodCallNode* node) override {
+    bool uses = Uses(node->object());
+    for (size_t i = 0; i < node->num_args(); ++i) {
+      uses = Uses(node->arg(i)) || uses;
+    }
+    uses_ = uses;
+  }
+
+  void Visit(const lldb_eval::UnaryOpNode* node) override {
+    uses_ = Uses(node->rhs());
+  }
+
+  void Visit(const lldb_eval::TernaryOpNode* node) override {
+    bool cond = Uses(node->cond());
+    bool lhs = Uses(node->lhs());
+    bool rhs = Uses(node->rhs());
+    uses_ = cond || lhs || rhs;
+  }
+
+ private:
+  std::string index_name_;
+  bool uses_ = false;
+  std::unordered_set<const AstNode*> nodes_;
+};
+
+// Native scalars, one per index. Only the vector matching the type is used.
+struct Column {
+  Scalar::Type type = Scalar::Type::INVALID;
+  // Results of the comparisons and the logical operators, and the bools read
+  // from memory.
+  bool is_bool = false;
+
+  std::vector<int32_t> int32;
+  std::vector<uint32_t> uint32;
+  std::vector<int64_t> int64;
+  std::vector<uint64_t> uint64;
+  std::vector<float> float32;
+  std::vector<double> float64;
+};
+
+template <typename T>
+std::vector<T>& Values(Column& column);
+
+template <>
+std::vector<int32_t>& Values(Column& column) {
+  return column.int32;
+}
+
+template <>
+std::vector<uint32_t>& Values(Column& column) {
+  return column.uint32;
+}
+
+template <>
+std::vector<int64_t>& Values(Column& column) {
+  return column.int64;
+}
+
+template <>
+std::vector<uint64_t>& Values(Column& column) {
+  return column.uint64;
+}
+
+template <>
+std::vector<float>& Values(Column& column) {
+  return column.float32;
+}
+
+template <>
+std::vector<double>& Values(Column& column) {
+  return column.float64;
+}
+
+// The columns hold the scalars up to 64 bits, the wider ones are evaluated
+// only outside of the ranges.
+bool IsColumnType(Scalar::Type type) {
+  return IsInteger(type) || type == Scalar::Type::FLOAT ||
+         type == Scalar::Type::DOUBLE;
+}
+
+size_t GetSize(Column& column) {
+  size_t size = 0;
+  DispatchType(column.type,
+               [&](auto tag) { size = Values<decltype(tag)>(column).size(); });
+  return size;
+}
+
+// Converts the values like the Scalar type promotion does.
+void Convert(Column* column, Scalar::Type type) {
+  if (column->type == type) {
+    return;
+  }
+
+  Column result;
+  result.type = type;
+  DispatchType(column->type, [&](auto from_tag) {
+    const auto& from = Values<decltype(from_tag)>(*column);
+    DispatchType(type, [&](auto to_tag) {
+      using To = decltype(to_tag);
+      std::vector<To>& to = Values<To>(result);
+      to.resize(from.size());
+      for (size_t k = 0; k < from.size(); ++k) {
+        to[k] = static_cast<To>(from[k]);
+      }
+    });
+  });
+  *column = std::move(result);
+}
+
+Column Broadcast(const Scalar& value, bool is_bool, size_t size) {
+  Column column;
+  column.type = value.type_;
+  column.is_bool = is_bool;
+  DispatchType(value.type_, [&](auto tag) {
+    using T = decltype(tag);
+    Values<T>(column).assign(size, value.GetAs<T>());
+  });
+  return column;
+}
+
+// The loops below work on plain arrays of native types, so that the compiler
+// can vectorize them.
+template <typename T, typename Op>
+void Loop(const std::vector<T>& lhs, const std::vector<T>& rhs,
+          std::vector<T>* out, Op op) {
+  out->resize(lhs.size());
+  for (size_t k = 0; k < lhs.size(); ++k) {
+    (*out)[k] = static_cast<T>(op(lhs[k], rhs[k]));
+  }
+}
+
+template <typename T, typename Op>
+void CompareLoop(const std::vector<T>& lhs, const std::vector<T>& rhs,
+                 std::vector<int32_t>* out, Op op) {
+  out->resize(lhs.size());
+  for (size_t k = 0; k < lhs.size(); ++k) {
+    (*out)[k] = op(lhs[k], rhs[k]) ? 1 : 0;
+  }
+}
+
+template <typename Op>
+void Arithmetic(Column& lhs, Column& rhs, Column* out, Op op) {
+  DispatchType(out->type, [&](auto tag) {
+    using T = decltype(tag);
+    Loop(Values<T>(lhs), Values<T>(rhs), &Values<T>(*out), op);
+  });
+}
+
+template <typename Op>
+void IntegerArithmetic(Column& lhs, Column& rhs, Column* out, Op op) {
+  DispatchIntegerType(out->type, [&](auto tag) {
+    using T = decltype(tag);
+    Loop(Values<T>(lhs), Values<T>(rhs), &Values<T>(*out), op);
+  });
+}
+
+template <typename Op>
+void Compare(Column& lhs, Column& rhs, Column* out, Op op) {
+  DispatchType(lhs.type, [&](auto tag) {
+    using T = decltype(tag);
+    CompareLoop(Values<T>(lhs), Values<T>(rhs), &out->int32, op);
+  });
+  out->type = Scalar::Type::INT32;
+  out->is_bool = true;
+}
+
+// Checks if the integer division traps for any of the operands.
+bool DivisionTraps(Column& lhs, Column& rhs) {
+  bool traps = false;
+  DispatchIntegerType(lhs.type, [&](auto tag) {
+    using T = decltype(tag);
+    const std::vector<T>& a = Values<T>(lhs);
+    const std::vector<T>& b = Values<T>(rhs);
+    for (size_t k = 0; k < a.size(); ++k) {
+      if (b[k] == 0) {
+        traps = true;
+      }
+      if constexpr (std::is_signed<T>::value) {
+        if (b[k] == static_cast<T>(-1) &&
+            a[k] == std::numeric_limits<T>::min()) {
+          traps = true;
+        }
+      }
+    }
+  });
+  return traps;
+}
+
+bool IsSigned(lldb::BasicType basic_type) {
+  switch (basic_type) {
+    case lldb::eBasicTypeUnsignedChar:
+    case lldb::eBasicTypeUnsignedWChar:
+    case lldb::eBasicTypeUnsignedShort:
+    case lldb::eBasicTypeUnsignedInt:
+    case lldb::eBasicTypeUnsignedLong:
+    case lldb::eBasicTypeUnsignedLongLong:
+    case lldb::eBasicTypeBool:
+      return false;
+    default:
+      return true;
+  }
+}
+
+// Decodes the objects of type Stored (in the host byte order) into values of
+// type T.
+template <typename Stored, typename T>
+void Decode(const std::vector<char>& contents, std::vector<T>* values) {
+  size_t count = contents.size() / sizeof(Stored);
+  values->resize(count);
+  if (count == 0) {
+    return;
+  }
+  if constexpr (std::is_same<Stored, T>::value) {
+    memcpy(values->data(), contents.data(), contents.size());
+  } else {
+    for (size_t k = 0; k < count; ++k) {
+      Stored value;
+      memcpy(&value, contents.data() + k * sizeof(Stored), sizeof(value));
+      (*values)[k] = static_cast<T>(value);
+    }
+  }
+}
+
+bool IsBoolValue(const Value& value, lldb::SBTarget target) {
+  return value.type() == Value::Type::BOOLEAN ||
+         value.AsSbValue(target).GetType().GetCanonicalType().GetBasicType() ==
+             lldb::eBasicTypeBool;
+}
+
+// Operand of the vectorized evaluation.
+struct Operand {
+  enum class Kind {
+    // Doesn't depend on the index, evaluated once.
+    kInvariant,
+    // Scalar per index.
+    kScalars,
+    // Object in memory per index, e.g. "arr[i]".
+    kObjects,
+    // Pointer per index, e.g. "&arr[i]". The type is the pointee type.
+    kPointers,
+  };
+
+  Kind kind = Kind::kInvariant;
+  Value value;
+  Column column;
+  lldb::SBType type;
+  std::vector<lldb::addr_t> addresses;
+  // If set, the addresses are the offsets in these contents, e.g. of an array
+  // created by the interpreter, which isn't in memory.
+  const std::string* contents = nullptr;
+};
+
+using Bindings = std::unordered_map<std::string, Value>;
+
+// Evaluates the expression for all indexes at once. The bound identifier (the
+// index or the element) is the given operand. Only the nodes depending on it
+// are visited, the others are evaluated by the Interpreter.
+class ColumnEvaluator : lldb_eval::Visitor {
+ public:
+  ColumnEvaluator(lldb_eval::ExpressionContext& expr_ctx,
+                  std::unordered_set<const AstNode*> dependent, size_t size,
+                  Operand binding, const Bindings& bindings,
+                  lldb_eval::ReadSet* read_set)
+      : expr_ctx_(&expr_ctx),
+        interpreter_(expr_ctx),
+        read_set_(read_set),
+        dependent_(std::move(dependent)),
+        size_(size),
+        binding_(std::move(binding)),
+        conditional_depth_(0),
+        ok_(true) {
+    target_ = expr_ctx.GetExecutionContext().GetTarget();
+    interpreter_.SetReadSet(read_set);
+    for (const auto& [name, value] : bindings) {
+      interpreter_.BindVariable(name, value);
+    }
+  }
+
+  // Returns false if the expression can't be evaluated over columns. The error
+  // is set only if the expression must not be evaluated at all (e.g. it
+  // divides by zero).
+  bool Evaluate(const AstNode* tree, Column* result) {
+    Operand operand = Eval(tree);
+    return ok_ && ToColumn(operand, result);
+  }
+
+  const EvalError& error() const { return error_; }
+
+ private:
+  Operand Eval(const AstNode* node) {
+    if (!ok_) {
+      return Operand();
+    }
+    if (dependent_.count(node) == 0) {
+      Operand operand;
+      EvalError error;
+      operand.value = interpreter_.Eval(node, error);
+      if (error) {
+        // Let the per-index evaluation report it.
+        ok_ = false;
+      }
+      return operand;
+    }
+    node->Accept(this);
+    return std::move(result_);
+  }
+
+  void Unsupported() { ok_ = false; }
+
+  void Visit(const lldb_eval::ErrorNode*) override { Unsupported(); }
+
+  void Visit(const lldb_eval::BooleanLiteralNode*) override { Unsupported(); }
+
+  void Visit(const lldb_eval::NumericLiteralNode*) override { Unsupported(); }
+
+  void Visit(const lldb_eval::StringLiteralNode*) override { Unsupported(); }
+
+  void Visit(const lldb_eval::IdentifierNode*) override {
+    // Only the bound identifier itself depends on it.
+    result_ = binding_;
+  }
+
+  void Visit(const lldb_eval::CStyleCastNode* node) override {
+    Operand rhs = Eval(node->rhs());
+    if (!ok_) {
+      return;
+    }
+
+    lldb_eval::TypeDeclaration type_decl = node->type_decl();
+    if (!type_decl.ptr_operators_.empty()) {
+      Unsupported();
+      return;
+    }
+    lldb::SBType type = expr_ctx_->ResolveTypeByName(
+        type_decl.GetBaseName().c_str());
+    lldb::SBType canonical = type.GetCanonicalType();
+    lldb::BasicType basic_type = canonical.GetBasicType();
+
+    // The casts truncating the values (e.g. to char) are left to the
+    // Interpreter.
+    Scalar::Type scalar_type =
+        GetScalarType(basic_type, canonical.GetByteSize());
+    if (scalar_type == Scalar::Type::INVALID ||
+        canonical.GetByteSize() < sizeof(int32_t) ||
+        (scalar_type == Scalar::Type::INT32 && !IsSigned(basic_type))) {
+      Unsupported();
+      return;
+    }
+
+    result_ = Operand();
+    result_.kind = Operand::Kind::kScalars;
+    if (!ToColumn(rhs, &result_.column)) {
+      Unsupported();
+      return;
+    }
+    Convert(&result_.column, scalar_type);
+    result_.column.is_bool = false;
+  }
+
+  void Visit(const lldb_eval::MemberOfNode* node) override {
+    Operand lhs = Eval(node->lhs());
+    if (!ok_) {
+      return;
+    }
+
+    if (node->type() == lldb_eval::MemberOfNode::Type::OF_POINTER) {
+      if (!ToPointers(lhs)) {
+        Unsupported();
+        return;
+      }
+    } else if (lhs.kind != Operand::Kind::kObjects) {
+      Unsupported();
+      return;
+    }
+
+    // Only the direct fields, the rest (e.g. the members of the base classes)
+    // is left to the Interpreter.
+    lldb::SBType type = lhs.type.GetCanonicalType();
+    std::string name = node->member_id()->name();
+    for (uint32_t i = 0; i < type.GetNumberOfFields(); ++i) {
+      lldb::SBTypeMember field = type.GetFieldAtIndex(i);
+      const char* field_name = field.GetName();
+      if (!field_name || name != field_name) {
+        continue;
+      }
+      if (field.IsBitfield()) {
+        break;
+      }
+      uint64_t offset = field.GetOffsetInBytes();
+      result_ = Operand();
+      result_.kind = Operand::Kind::kObjects;
+      result_.type = field.GetType();
+      result_.addresses = std::move(lhs.addresses);
+      for (lldb::addr_t& address : result_.addresses) {
+        address += offset;
+      }
+      return;
+    }
+    Unsupported();
+  }
+
+  void Visit(const lldb_eval::BinaryOpNode* node) override {
+    clang::tok::TokenKind op = node->op();
+
+    // The right operand of "&&" and "||" is evaluated for every index, even
+    // the ones it's short-circuited for.
+    bool short_circuit =
+        op == clang::tok::ampamp || op == clang::tok::pipepipe;
+    Operand lhs = Eval(node->lhs());
+    conditional_depth_ += short_circuit ? 1 : 0;
+    Operand rhs = Eval(node->rhs());
+    conditional_depth_ -= short_circuit ? 1 : 0;
+    if (!ok_) {
+      return;
+    }
+
+    // Subscript and the pointer arithmetic.
+    if (op == clang::tok::l_square || op == clang::tok::plus ||
+        op == clang::tok::minus) {
+      bool lhs_pointer = IsPointerLike(lhs);
+      bool rhs_pointer = IsPointerLike(rhs);
+      if (lhs_pointer && rhs_pointer) {
+        Unsupported();
+        return;
+      }
+      if (lhs_pointer || (rhs_pointer && op != clang::tok::minus)) {
+        Operand& base = lhs_pointer ? lhs : rhs;
+        Operand& index = lhs_pointer ? rhs : lhs;
+        if (!Advance(base, index, op == clang::tok::minus)) {
+          Unsupported();
+          return;
+        }
+        result_ = std::move(base);
+        if (op == clang::tok::l_square) {
+          result_.kind = Operand::Kind::kObjects;
+        }
+        return;
+      }
+      if (op == clang::tok::l_square) {
+        Unsupported();
+        return;
+      }
+    }
+
+    result_ = Operand();
+    result_.kind = Operand::Kind::kScalars;
+    Column lhs_column, rhs_column;
+    if (!ToColumn(lhs, &lhs_column) || !ToColumn(rhs, &rhs_column) ||
+        !ApplyBinaryOp(op, lhs_column, rhs_column, &result_.column)) {
+      ok_ = false;
+    }
+  }
+
+  void Visit(const lldb_eval::ArraySliceNode*) override { Unsupported(); }
+
+  void Visit(const lldb_eval::CallNode*) override { Unsupported(); }
+
+  void Visit(const lldb_eval::MethodCallNode*) override { Unsupported(); }
+
+  void Visit(const lldb_eval::UnaryOpNode* node) override {
+    Operand rhs = Eval(node->rhs());
+    if (!ok_) {
+      return;
+    }
+
+    switch (node->op()) {
+      case clang::tok::star: {
+        if (!ToPointers(rhs)) {
+          Unsupported();
+          return;
+        }
+        result_ = std::move(rhs);
+        result_.kind = Operand::Kind::kObjects;
+        return;
+      }
+      case clang::tok::amp: {
+        if (rhs.kind != Operand::Kind::kObjects) {
+          Unsupported();
+          return;
+        }
+        result_ = std::move(rhs);
+        result_.kind = Operand::Kind::kPointers;
+        return;
+      }
+      case clang::tok::plus:
+      case clang::tok::minus:
+      case clang::tok::tilde:
+      case clang::tok::exclaim:
+        break;
+      default:
+        Unsupported();
+        return;
+    }
+
+    result_ = Operand();
+    result_.kind = Operand::Kind::kScalars;
+    Column& column = result_.column;
+    if (!ToColumn(rhs, &column)) {
+      Unsupported();
+      return;
+    }
+
+    switch (node->op()) {
+      case clang::tok::plus:
+        column.is_bool = false;
+        break;
+      case clang::tok::minus: {
+        // Same as the Interpreter, which multiplies by -1.
+        Column minus_one = Broadcast(Scalar(-1), false, size_);
+        Convert(&column, std::max(column.type, Scalar::Type::INT32));
+        Convert(&minus_one, column.type);
+        Arithmetic(column, minus_one, &column,
+                   [](auto a, auto b) { return a * b; });
+        column.is_bool = false;
+        break;
+      }
+      case clang::tok::tilde: {
+        if (!IsInteger(column.type)) {
+          Unsupported();
+          return;
+        }
+        DispatchIntegerType(column.type, [&](auto tag) {
+          using T = decltype(tag);
+          for (T& value : Values<T>(column)) {
+            value = static_cast<T>(~value);
+          }
+        });
+        column.is_bool = false;
+        break;
+      }
+      case clang::tok::exclaim: {
+        Column zero = Broadcast(Scalar(0), false, size_);
+        Convert(&zero, column.type);
+        Column result;
+        Compare(column, zero, &result, [](auto a, auto b) { return a == b; });
+        column = std::move(result);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  void Visit(const lldb_eval::TernaryOpNode*) override { Unsupported(); }
+
+ private:
+  bool ApplyBinaryOp(clang::tok::TokenKind op, Column& lhs, Column& rhs,
+                     Column* out) {
+    Scalar::Type type = std::max(lhs.type, rhs.type);
+    Convert(&lhs, type);
+    Convert(&rhs, type);
+    out->type = type;
+    out->is_bool = false;
+
+    switch (op) {
+      case clang::tok::plus:
+        Arithmetic(lhs, rhs, out, [](auto a, auto b) { return a + b; });
+        return true;
+      case clang::tok::minus:
+        Arithmetic(lhs, rhs, out, [](auto a, auto b) { return a - b; });
+        return true;
+      case clang::tok::star:
+        Arithmetic(lhs, rhs, out, [](auto a, auto b) { return a * b; });
+        return true;
+
+      case clang::tok::slash:
+      case clang::tok::percent: {
+        if (IsInteger(type) && DivisionTraps(lhs, rhs)) {
+          // The trapping indexes may be short-circuited, let the per-index
+          // evaluation decide.
+          if (conditional_depth_ == 0) {
+            error_.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                       "division by zero or overflow");
+          }
+          return false;
+        }
+        if (op == clang::tok::slash) {
+          Arithmetic(lhs, rhs, out, [](auto a, auto b) { return a / b; });
+          return true;
+        }
+        if (!IsInteger(type)) {
+          return false;
+        }
+        IntegerArithmetic(lhs, rhs, out, [](auto a, auto b) { return a % b; });
+        return true;
+      }
+
+      case clang::tok::amp:
+      case clang::tok::pipe:
+      case clang::tok::caret:
+      case clang::tok::lessless:
+      case clang::tok::greatergreater: {
+        if (!IsInteger(type)) {
+          return false;
+        }
+        if (op == clang::tok::amp) {
+          IntegerArithmetic(lhs, rhs, out,
+                            [](auto a, auto b) { return a & b; });
+        } else if (op == clang::tok::pipe) {
+          IntegerArithmetic(lhs, rhs, out,
+                            [](auto a, auto b) { return a | b; });
+        } else if (op == clang::tok::caret) {
+          IntegerArithmetic(lhs, rhs, out,
+                            [](auto a, auto b) { return a ^ b; });
+        } else if (op == clang::tok::lessless) {
+          IntegerArithmetic(lhs, rhs, out,
+                            [](auto a, auto b) { return a << b; });
+        } else {
+          IntegerArithmetic(lhs, rhs, out,
+                            [](auto a, auto b) { return a >> b; });
+        }
+        return true;
+      }
+
+      case clang::tok::equalequal:
+        Compare(lhs, rhs, out, [](auto a, auto b) { return a == b; });
+        return true;
+      case clang::tok::exclaimequal:
+        Compare(lhs, rhs, out, [](auto a, auto b) { return a != b; });
+        return true;
+      case clang::tok::less:
+        Compare(lhs, rhs, out, [](auto a, auto b) { return a < b; });
+        return true;
+      case clang::tok::lessequal:
+        Compare(lhs, rhs, out, [](auto a, auto b) { return a <= b; });
+        return true;
+      case clang::tok::greater:
+        Compare(lhs, rhs, out, [](auto a, auto b) { return a > b; });
+        return true;
+      case clang::tok::greaterequal:
+        Compare(lhs, rhs, out, [](auto a, auto b) { return a >= b; });
+        return true;
+
+      // Both operands are already evaluated, so there is nothing to
+      // short-circuit. The errors of the right operand are left to the
+      // per-index evaluation, see Visit(BinaryOpNode).
+      case clang::tok::ampamp:
+        Compare(lhs, rhs, out, [](auto a, auto b) {
+          return a != decltype(a)(0) && b != decltype(b)(0);
+        });
+        return true;
+      case clang::tok::pipepipe:
+        Compare(lhs, rhs, out, [](auto a, auto b) {
+          return a != decltype(a)(0) || b != decltype(b)(0);
+        });
+        return true;
+
+      default:
+        return false;
+    }
+  }
+
+  // Checks if the operand is an array or a pointer.
+  bool IsPointerLike(Operand& operand) {
+    switch (operand.kind) {
+      case Operand::Kind::kPointers:
+        return true;
+      case Operand::Kind::kObjects: {
+        lldb::SBType type = operand.type.GetCanonicalType();
+        return type.IsArrayType() || type.IsPointerType();
+      }
+      case Operand::Kind::kInvariant: {
+        if (operand.value.IsPointer()) {
+          return true;
+        }
+        lldb::SBType type =
+            operand.value.AsSbValue(target_).GetType().GetDereferencedType();
+        return type.GetCanonicalType().IsArrayType();
+      }
+      case Operand::Kind::kScalars:
+        return false;
+    }
+    return false;
+  }
+
+  // Converts an array or a pointer operand to kPointers.
+  bool ToPointers(Operand& operand) {
+    switch (operand.kind) {
+      case Operand::Kind::kPointers:
+        return true;
+
+      case Operand::Kind::kObjects: {
+        lldb::SBType type = operand.type.GetCanonicalType();
+        if (type.IsArrayType()) {
+          // The array decays to a pointer to its first element.
+          operand.type = type.GetArrayElementType();
+        } else if (type.IsPointerType()) {
+          if (!LoadPointers(type.GetByteSize(), operand.contents,
+                            &operand.addresses)) {
+            return false;
+          }
+          // The pointers point to the memory.
+          operand.contents = nullptr;
+          operand.type = type.GetPointeeType();
+        } else {
+          return false;
+        }
+        operand.kind = Operand::Kind::kPointers;
+        return true;
+      }
+
+      case Operand::Kind::kInvariant: {
+        lldb::SBValue value = operand.value.AsSbValue(target_);
+        if (value.GetType().IsReferenceType()) {
+          value = value.Dereference();
+        }
+        lldb::SBType type = value.GetType().GetCanonicalType();
+        lldb::addr_t address;
+        if (type.IsArrayType()) {
+          address = value.GetLoadAddress();
+          operand.type = type.GetArrayElementType();
+        } else if (type.IsPointerType()) {
+          address = static_cast<lldb::addr_t>(value.GetValueAsUnsigned());
+          operand.type = type.GetPointeeType();
+        } else {
+          return false;
+        }
+        if (address == LLDB_INVALID_ADDRESS) {
+          return false;
+        }
+        operand.kind = Operand::Kind::kPointers;
+        operand.addresses.assign(size_, address);
+        return true;
+      }
+
+      case Operand::Kind::kScalars:
+        return false;
+    }
+    return false;
+  }
+
+  // Advances the pointers by the index, in the units of the pointee size.
+  bool Advance(Operand& base, Operand& index, bool subtract) {
+    Column offsets;
+    if (!ToPointers(base) || !ToColumn(index, &offsets) ||
+        !IsInteger(offsets.type)) {
+      return false;
+    }
+    uint64_t size = base.type.GetByteSize();
+    if (size == 0) {
+      return false;
+    }
+
+    Convert(&offsets, Scalar::Type::INT64);
+    std::vector<lldb::addr_t>& addresses = base.addresses;
+    for (size_t k = 0; k < addresses.size(); ++k) {
+      // The address arithmetic wraps around.
+      uint64_t offset = static_cast<uint64_t>(offsets.int64[k]) * size;
+      addresses[k] = subtract ? addresses[k] - offset : addresses[k] + offset;
+    }
+    return true;
+  }
+
+  bool ToColumn(Operand& operand, Column* column) {
+    switch (operand.kind) {
+      case Operand::Kind::kScalars:
+        *column = std::move(operand.column);
+        return true;
+
+      case Operand::Kind::kInvariant: {
+        if (!operand.value.IsScalar()) {
+          return false;
+        }
+        Scalar scalar = operand.value.AsScalar();
+        if (!IsColumnType(scalar.type_)) {
+          return false;
+        }
+        *column = Broadcast(scalar, IsBoolValue(operand.value, target_),
+                            size_);
+        return true;
+      }
+
+      case Operand::Kind::kObjects:
+        return LoadScalars(operand.type, operand.addresses, operand.contents,
+                           column);
+
+      case Operand::Kind::kPointers:
+        return false;
+    }
+    return false;
+  }
+
+  // Reads the objects at the addresses, nearby objects are read with a single
+  // request. If "source" is set, the objects are copied from it instead.
+  bool ReadObjects(const std::vector<lldb::addr_t>& addresses, size_t size,
+                   const std::string* source, std::vector<char>* contents) {
+    if (target_.GetByteOrder() != GetHostByteOrder()) {
+      return false;
+    }
+
+    size_t count = addresses.size();
+    contents->resize(count * size);
+
+    if (source) {
+      for (size_t k = 0; k < count; ++k) {
+        if (addresses[k] > source->size() ||
+            source->size() - addresses[k] < size) {
+          return false;
+        }
+        memcpy(contents->data() + k * size, source->data() + addresses[k],
+               size);
+      }
+      return true;
+    }
+
+    // Usually the addresses are already sorted, e.g. "arr[i].field".
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    if (!std::is_sorted(addresses.begin(), addresses.end())) {
+      std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return addresses[a] < addresses[b];
+      });
+    }
+
+    lldb::SBProcess process = target_.GetProcess();
+    std::string window;
+    size_t first = 0;
+    while (first < count) {
+      lldb::addr_t start = addresses[order[first]];
+      lldb::addr_t end = start + size;
+      size_t last = first + 1;
+      for (; last < count; ++last) {
+        lldb::addr_t address = addresses[order[last]];
+        if (address > end + kMaxGap || address + size - start > kMaxReadSize) {
+          break;
+        }
+        end = std::max(end, address + size);
+      }
+
+      window.resize(static_cast<size_t>(end - start));
+      lldb::SBError error;
+      size_t read =
+          process.ReadMemory(start, &window[0], window.size(), error);
+      if (error.Fail() || read != window.size()) {
+        return false;
+      }
+      if (read_set_) {
+        read_set_->AddMemory(start, window.size());
+      }
+      for (size_t k = first; k < last; ++k) {
+        memcpy(contents->data() + order[k] * size,
+               window.data() + (addresses[order[k]] - start), size);
+      }
+      first = last;
+    }
+    return true;
+  }
+
+  bool LoadPointers(uint64_t size, const std::string* source,
+                    std::vector<lldb::addr_t>* addresses) {
+    std::vector<char> contents;
+    if (!ReadObjects(*addresses, static_cast<size_t>(size), source,
+                     &contents)) {
+      return false;
+    }
+    if (size == sizeof(uint32_t)) {
+      Decode<uint32_t>(contents, addresses);
+    } else if (size == sizeof(uint64_t)) {
+      Decode<uint64_t>(contents, addresses);
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool LoadScalars(lldb::SBType type,
+                   const std::vector<lldb::addr_t>& addresses,
+                   const std::string* source, Column* column) {
+    lldb::SBType canonical = type.GetCanonicalType();
+    lldb::BasicType basic_type = canonical.GetBasicType();
+    uint64_t size = canonical.GetByteSize();
+
+    Scalar::Type scalar_type = GetScalarType(basic_type, size);
+    if (scalar_type == Scalar::Type::INVALID) {
+      return false;
+    }
+
+    std::vector<char> contents;
+    if (!ReadObjects(addresses, static_cast<size_t>(size), source,
+                     &contents)) {
+      return false;
+    }
+
+    *column = Column();
+    column->type = scalar_type;
+    column->is_bool = basic_type == lldb::eBasicTypeBool;
+
+    bool is_signed = IsSigned(basic_type);
+    switch (scalar_type) {
+      case Scalar::Type::INT32:
+        if (size == 1) {
+          is_signed ? Decode<int8_t>(contents, &column->int32)
+                    : Decode<uint8_t>(contents, &column->int32);
+        } else if (size == 2) {
+          is_signed ? Decode<int16_t>(contents, &column->int32)
+                    : Decode<uint16_t>(contents, &column->int32);
+        } else {
+          Decode<int32_t>(contents, &column->int32);
+        }
+        break;
+      case Scalar::Type::UINT32:
+        if (size == 1) {
+          Decode<uint8_t>(contents, &column->uint32);
+        } else {
+          Decode<uint32_t>(contents, &column->uint32);
+        }
+        break;
+      case Scalar::Type::INT64:
+        Decode<int64_t>(contents, &column->int64);
+        break;
+      case Scalar::Type::UINT64:
+        Decode<uint64_t>(contents, &column->uint64);
+        break;
+      case Scalar::Type::FLOAT:
+        Decode<float>(contents, &column->float32);
+        break;
+      case Scalar::Type::DOUBLE:
+        Decode<double>(contents, &column->float64);
+        break;
+      case Scalar::Type::INT128:
+      case Scalar::Type::UINT128:
+      case Scalar::Type::LONG_DOUBLE:
+      case Scalar::Type::INVALID:
+        return false;
+    }
+    return true;
+  }
+
+ private:
+  lldb_eval::ExpressionContext* expr_ctx_;
+  lldb_eval::Interpreter interpreter_;
+  lldb::SBTarget target_;
+  lldb_eval::ReadSet* read_set_;
+
+  std::unordered_set<const AstNode*> dependent_;
+  size_t size_;
+  Operand binding_;
+
+  // Number of the enclosing operands which aren't evaluated for every index.
+  int conditional_depth_;
+  bool ok_;
+  EvalError error_;
+  Operand result_;
+};
+
+// The reference evaluation, the Interpreter evaluates the expression for every
+// index with the identifier bound to bind(index). The errors are prefixed with
+// e.g. "index 5: ", where 5 is the "first_label" + index.
+template <typename Bind>
+bool EvaluateEach(lldb_eval::ExpressionContext& expr_ctx, const AstNode* tree,
+                  const std::string& name, size_t size,
+                  const Bindings& bindings, lldb_eval::ReadSet* read_set,
+                  const char* label, int64_t first_label, Bind bind,
+                  Column* column, EvalError& error) {
+  lldb_eval::Interpreter interpreter(expr_ctx);
+  interpreter.SetReadSet(read_set);
+  for (const auto& [bound_name, value] : bindings) {
+    interpreter.BindVariable(bound_name, value);
+  }
+  lldb::SBTarget target = expr_ctx.GetExecutionContext().GetTarget();
+
+  for (size_t k = 0; k < size; ++k) {
+    interpreter.BindVariable(name, bind(k));
+    Value value = interpreter.Eval(tree, error);
+    if (error) {
+      error.Set(error.code(), std::string(label) + " " +
+                                  std::to_string(first_label +
+                                                 static_cast<int64_t>(k)) +
+                                  ": " + error.message());
+      return false;
+    }
+
+    Scalar scalar = value.IsScalar() ? value.AsScalar() : Scalar();
+    if (scalar.type_ == Scalar::Type::INVALID) {
+      std::string type = value.AsSbValue(target).GetTypeName();
+      error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                "result of type '" + type + "' is not a scalar");
+      return false;
+    }
+    if (!IsColumnType(scalar.type_)) {
+      std::string type = value.AsSbValue(target).GetTypeName();
+      error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                "results of type '" + type + "' are not supported in ranges");
+      return false;
+    }
+
+    bool is_bool = IsBoolValue(value, target);
+    if (k == 0) {
+      column->type = scalar.type_;
+      column->is_bool = is_bool;
+    } else if (scalar.type_ != column->type) {
+      // E.g. the branches of a conditional operator have different types.
+      Convert(column, std::max(column->type, scalar.type_));
+      scalar.PromoteTo(column->type);
+    }
+    column->is_bool = column->is_bool && is_bool;
+    DispatchType(column->type, [&](auto tag) {
+      using T = decltype(tag);
+      Values<T>(*column).push_back(scalar.GetAs<T>());
+    });
+  }
+  return true;
+}
+
+void StoreResult(Column& column, lldb_eval::RangeResult* result) {
+  size_t size = GetSize(column);
+
+  if (column.is_bool) {
+    result->type = lldb::eBasicTypeBool;
+    result->element_size = 1;
+    result->data.resize(size);
+    DispatchType(column.type, [&](auto tag) {
+      using T = decltype(tag);
+      const std::vector<T>& values = Values<T>(column);
+      for (size_t k = 0; k < size; ++k) {
+        result->data[k] = values[k] != T(0) ? 1 : 0;
+      }
+    });
+    return;
+  }
+
+  switch (column.type) {
+    case Scalar::Type::INT32:
+      result->type = lldb::eBasicTypeInt;
+      break;
+    case Scalar::Type::UINT32:
+      result->type = lldb::eBasicTypeUnsignedInt;
+      break;
+    case Scalar::Type::INT64:
+      result->type = lldb::eBasicTypeLongLong;
+      break;
+    case Scalar::Type::UINT64:
+      result->type = lldb::eBasicTypeUnsignedLongLong;
+      break;
+    case Scalar::Type::FLOAT:
+      result->type = lldb::eBasicTypeFloat;
+      break;
+    case Scalar::Type::DOUBLE:
+      result->type = lldb::eBasicTypeDouble;
+      break;
+    case Scalar::Type::INT128:
+    case Scalar::Type::UINT128:
+    case Scalar::Type::LONG_DOUBLE:
+      // Rejected by EvaluateEach(), see IsColumnType().
+    case Scalar::Type::INVALID:
+      // Empty range.
+      return;
+  }
+
+  DispatchType(column.type, [&](auto tag) {
+    using T = decltype(tag);
+    const std::vector<T>& values = Values<T>(column);
+    result->element_size = sizeof(T);
+    result->data.resize(size * sizeof(T));
+    if (size > 0) {
+      memcpy(result->data.data(), values.data(), size * sizeof(T));
+    }
+  });
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+bool EvaluateOverRange(ExpressionContext& expr_ctx, const AstNode* tree,
+                       const std::string& index_name, int64_t begin,
+                       int64_t end, RangeResult* result, EvalError& error) {
+  *result = RangeResult();
+
+  if (begin > end) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              "invalid range [" + std::to_string(begin) + ", " +
+                  std::to_string(end) + ")");
+    return false;
+  }
+  uint64_t size = static_cast<uint64_t>(end) - static_cast<uint64_t>(begin);
+  if (size > static_cast<uint64_t>(kMaxRangeSize)) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              "range of " + std::to_string(size) + " indexes is too large");
+    return false;
+  }
+
+  // The index is a "long long", same as for the per-index evaluation.
+  Operand index;
+  index.kind = Operand::Kind::kScalars;
+  index.column.type = Scalar::Type::INT64;
+  index.column.int64.resize(static_cast<size_t>(size));
+  std::iota(index.column.int64.begin(), index.column.int64.end(), begin);
+
+  Column column;
+  IndexUseFinder finder(index_name);
+  ColumnEvaluator evaluator(expr_ctx, finder.Find(tree),
+                            static_cast<size_t>(size), std::move(index),
+                            Bindings(), nullptr);
+
+  if (evaluator.Evaluate(tree, &column)) {
+    result->vectorized = true;
+  } else if (evaluator.error()) {
+    error = evaluator.error();
+    return false;
+  } else if (!EvaluateEach(
+                 expr_ctx, tree, index_name, static_cast<size_t>(size),
+                 Bindings(), nullptr, "index", begin,
+                 [&](size_t k) {
+                   return Value(Scalar(begin + static_cast<int64_t>(k)));
+                 },
+                 &column, error)) {
+    return false;
+  }
+
+  StoreResult(column, result);
+  return true;
+}
+
+bool EvaluateOverElements(
+    ExpressionContext& expr_ctx, const AstNode* tree,
+    const std::string& element_name, lldb::SBValue array,
+    const std::string* contents,
+    const std::unordered_map<std::string, Value>& bindings,
+    ReadSet* read_set, RangeResult* result, EvalError& error) {
+  *result = RangeResult();
+
+  lldb::SBType type = array.GetType().GetCanonicalType();
+  lldb::SBType element_type = type.GetArrayElementType();
+  uint64_t element_size = element_type.GetByteSize();
+  if (!type.IsArrayType() || element_size == 0) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              "array elements must have a complete type");
+    return false;
+  }
+  uint64_t size = array.GetByteSize() / element_size;
+  if (size > static_cast<uint64_t>(kMaxRangeSize)) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              "array of " + std::to_string(size) + " elements is too large");
+    return false;
+  }
+
+  Operand element;
+  element.kind = Operand::Kind::kObjects;
+  element.type = element_type;
+
+  // The arrays created by the interpreter (e.g. slices) aren't in memory, the
+  // elements are read from their contents.
+  std::string array_contents;
+  lldb::addr_t address = array.GetLoadAddress();
+  if (!contents && address == LLDB_INVALID_ADDRESS) {
+    lldb::SBData data = array.GetData();
+    lldb::SBError read_error;
+    array_contents.resize(data.GetByteSize());
+    if (!array_contents.empty()) {
+      data.ReadRawData(read_error, 0, &array_contents[0],
+                       array_contents.size());
+    }
+    if (read_error.Fail()) {
+      array_contents.clear();
+    }
+    contents = &array_contents;
+  }
+  if (contents) {
+    if (address != LLDB_INVALID_ADDRESS && read_set) {
+      read_set->AddMemory(address, contents->size());
+    }
+    element.contents = contents;
+    address = 0;
+  }
+  element.addresses.resize(static_cast<size_t>(size));
+  for (size_t k = 0; k < element.addresses.size(); ++k) {
+    element.addresses[k] = address + k * element_size;
+  }
+
+  Column column;
+  IndexUseFinder finder(element_name);
+  ColumnEvaluator evaluator(expr_ctx, finder.Find(tree),
+                            static_cast<size_t>(size), std::move(element),
+                            bindings, read_set);
+
+  if (evaluator.Evaluate(tree, &column)) {
+    result->vectorized = true;
+  } else if (evaluator.error()) {
+    error = evaluator.error();
+    return false;
+  } else if (!EvaluateEach(
+                 expr_ctx, tree, element_name, static_cast<size_t>(size),
+                 bindings, read_set, "element", 0,
+                 [&](size_t k) {
+                   uint32_t index = static_cast<uint32_t>(k);
+                   return Value(array.GetChildAtIndex(index));
+                 },
+                 &column, error)) {
+    return false;
+  }
+
+  StoreResult(column, result);
+  return true;
+}
+
+bool EvaluateOverPointers(
+    ExpressionContext& expr_ctx, const AstNode* tree,
+    const std::string& element_name, lldb::SBType pointer_type,
+    const std::vector<lldb::addr_t>& addresses, int64_t first_index,
+    const std::unordered_map<std::string, Value>& bindings,
+    ReadSet* read_set, RangeResult* result, EvalError& error) {
+  *result = RangeResult();
+
+  Operand element;
+  element.kind = Operand::Kind::kPointers;
+  element.type = pointer_type.GetPointeeType();
+  element.addresses = addresses;
+
+  Column column;
+  IndexUseFinder finder(element_name);
+  ColumnEvaluator evaluator(expr_ctx, finder.Find(tree), addresses.size(),
+                            std::move(element), bindings, read_set);
+
+  if (evaluator.Evaluate(tree, &column)) {
+    result->vectorized = true;
+  } else if (evaluator.error()) {
+    error = evaluator.error();
+    return false;
+  } else if (!EvaluateEach(expr_ctx, tree, element_name, addresses.size(),
+                           bindings, read_set, "node", first_index,
+                           [&](size_t k) {
+                             return Value(
+                                 Pointer(addresses[k], pointer_type));
+                           },
+                           &column, error)) {
+    return false;
+  }
+
+  StoreResult(column, result);
+  return true;
+}
+
+}  // namespace lldb_eval
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_RANGE_EVALUATOR_H_
+#define LLDB_EVAL_RANGE_EVALUATOR_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lldb-eval/api.h"
+#include "lldb-eval/ast.h"
+#include "lldb-eval/eval.h"
+#include "lldb-eval/expression_context.h"
+#include "lldb-eval/read_set.h"
+#include "lldb-eval/value.h"
+#include "lldb/API/SBType.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-types.h"
+
+namespace lldb_eval {
+
+// Maximum number of the indexes evaluated at once.
+const int64_t kMaxRangeSize = 16 * 1024 * 1024;
+
+// Evaluates the expression for every value of the index variable in the range
+// [begin, end), see EvaluateExpressionOverRange().
+//
+// The vectorized evaluation handles the index, the loop-invariant parts (they
+// are evaluated once by the Interpreter), subscripts, member accesses, pointer
+// arithmetic, casts and the arithmetic, bitwise, comparison and logical
+// operators. The objects in memory are gathered with a few bulk reads, nearby
+// objects (e.g. a field of every element of an array) are read together.
+// Everything else (e.g. the conditional operator, the bit fields, errors) is
+// evaluated by the Interpreter once per index.
+bool EvaluateOverRange(ExpressionContext& expr_ctx, const AstNode* tree,
+                       const std::string& index_name, int64_t begin,
+                       int64_t end, RangeResult* result, EvalError& error);
+
+// Evaluates the expression for every element of the array, the identifier
+// "element_name" refers to the element (e.g. the predicates of the builtins).
+// The "bindings" are visible in the expression, the memory read is recorded
+// into the optional "read_set". The elements of the arrays which aren't in
+// memory (e.g. slices) are taken from their contents. If "contents" is set, it
+// holds the contents of the array already read by the caller, the elements are
+// taken from it instead of the memory.
+bool EvaluateOverElements(
+    ExpressionContext& expr_ctx, const AstNode* tree,
+    const std::string& element_name, lldb::SBValue array,
+    const std::string* contents,
+    const std::unordered_map<std::string, Value>& bindings,
+    ReadSet* read_set, RangeResult* result, EvalError& error);
+
+// Evaluates the expression for every object at the given addresses, the
+// identifier "element_name" is the pointer of "pointer_type" to the object
+// (e.g. the predicates over the nodes of the linked lists). The errors refer
+// to the objects by their position, starting from "first_index".
+bool EvaluateOverPointers(
+    ExpressionContext& expr_ctx, const AstNode* tree,
+    const std::string& element_name, lldb::SBType pointer_type,
+    const std::vector<lldb::addr_t>& addresses, int64_t first_index,
+    const std::unordered_map<std::string, Value>& bindings,
+    ReadSet* read_set, RangeResult* result, EvalError& error);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_RANGE_EVALUATOR_H_
@@ -0,0 +1,173 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/read_set.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/API/SBThread.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-enumerations.h"
+
+namespace {
+
+// Values larger than this are not worth re-reading on every stop, it's cheaper
+// to re-evaluate the expression.
+const uint64_t kMaxValueSize = 64 * 1024;
+
+// Ranges closer than this are merged into a single read request.
+const uint64_t kMaxGap = 64;
+
+bool ReadValueData(lldb::SBValue value, std::string* contents) {
+  lldb::SBData data = value.GetData();
+  lldb::SBError error;
+  contents->resize(data.GetByteSize());
+  if (contents->empty()) {
+    return true;
+  }
+  data.ReadRawData(error, 0, &(*contents)[0], contents->size());
+  return error.Success();
+}
+
+bool ReadMemory(lldb::SBProcess process, lldb::addr_t address, size_t size,
+                std::string* contents) {
+  lldb::SBError error;
+  contents->resize(size);
+  size_t read = process.ReadMemory(address, &(*contents)[0], size, error);
+  return error.Success() && read == size;
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+ReadSet::ReadSet() : complete_(true) {}
+
+void ReadSet::AddValue(lldb::SBValue value) {
+  if (!complete_ || !value.IsValid()) {
+    return;
+  }
+
+  lldb::ValueType value_type = value.GetValueType();
+
+  // Values created by the interpreter itself don't depend on the process.
+  if (value_type == lldb::eValueTypeConstResult) {
+    return;
+  }
+
+  if (value_type == lldb::eValueTypeRegister) {
+    std::string contents;
+    const char* name = value.GetName();
+    if (!name || !ReadValueData(value, &contents)) {
+      complete_ = false;
+      return;
+    }
+    registers_.emplace_back(name, contents);
+    return;
+  }
+
+  lldb::addr_t address = value.GetLoadAddress();
+  if (address == LLDB_INVALID_ADDRESS) {
+    // E.g. a variable living in a register.
+    complete_ = false;
+    return;
+  }
+  AddMemory(address, value.GetByteSize());
+}
+
+void ReadSet::AddMemory(lldb::addr_t address, uint64_t size) {
+  if (!complete_) {
+    return;
+  }
+  if (size > kMaxValueSize) {
+    complete_ = false;
+    return;
+  }
+  if (size > 0) {
+    ranges_.push_back({address, size});
+  }
+}
+
+void ReadSet::Capture(lldb::SBFrame frame) {
+  if (!complete_) {
+    return;
+  }
+
+  std::sort(ranges_.begin(), ranges_.end(),
+            [](const Range& a, const Range& b) {
+              return a.address < b.address;
+            });
+
+  std::vector<Range> merged;
+  for (const Range& range : ranges_) {
+    if (!merged.empty() &&
+        range.address <= merged.back().address + merged.back().size + kMaxGap) {
+      lldb::addr_t end = std::max(merged.back().address + merged.back().size,
+                                  range.address + range.size);
+      merged.back().size = end - merged.back().address;
+    } else {
+      merged.push_back(range);
+    }
+  }
+  ranges_ = merged;
+
+  lldb::SBProcess process = frame.GetThread().GetProcess();
+  for (const Range& range : ranges_) {
+    Region region;
+    region.address = range.address;
+    if (!ReadMemory(process, range.address, range.size, &region.contents)) {
+      complete_ = false;
+      return;
+    }
+    regions_.push_back(std::move(region));
+  }
+}
+
+bool ReadSet::IsUnchanged(lldb::SBFrame frame) const {
+  if (!complete_) {
+    return false;
+  }
+
+  lldb::SBProcess process = frame.GetThread().GetProcess();
+  std::string contents;
+  for (const Region& region : regions_) {
+    if (!ReadMemory(process, region.address, region.contents.size(),
+                    &contents) ||
+        contents != region.contents) {
+      return false;
+    }
+  }
+
+  for (const auto& reg : registers_) {
+    lldb::SBValue value = frame.FindRegister(reg.first.c_str());
+    if (!value.IsValid() || !ReadValueData(value, &contents) ||
+        contents != reg.second) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::vector<ReadSet::Range> ReadSet::GetRanges() const { return ranges_; }
+
+}  // namespace lldb_eval
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_READ_SET_H_
+#define LLDB_EVAL_READ_SET_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-types.h"
+
+namespace lldb_eval {
+
+// ReadSet records the state of the process an evaluation depends on: the
+// memory ranges and the registers it has read. If none of them has changed
+// since the evaluation, re-evaluating the expression gives the same result.
+//
+// The tracking is conservative: values which can't be re-read later (e.g.
+// variables living in registers) make the read set incomplete, in which case
+// the expression must always be re-evaluated.
+class ReadSet {
+ public:
+  struct Range {
+    lldb::addr_t address;
+    uint64_t size;
+  };
+
+  ReadSet();
+
+  // Records the value read by the interpreter.
+  void AddValue(lldb::SBValue value);
+
+  // Records the memory range read by the interpreter directly, bypassing the
+  // LLDB values (e.g. the contents of an array slice).
+  void AddMemory(lldb::addr_t address, uint64_t size);
+
+  // Reads the current contents of the recorded memory ranges. Must be called
+  // once, after the evaluation, while the process is still stopped.
+  void Capture(lldb::SBFrame frame);
+
+  // Checks if the recorded memory and registers have the same contents in the
+  // given frame as they had when they were captured.
+  bool IsUnchanged(lldb::SBFrame frame) const;
+
+  bool IsComplete() const { return complete_; }
+
+  // Merged memory ranges, sorted by address. Available after Capture().
+  std::vector<Range> GetRanges() const;
+
+ private:
+  // Contiguous memory region, adjacent and overlapping ranges are merged so
+  // that each region is read with a single request.
+  struct Region {
+    lldb::addr_t address;
+    std::string contents;
+  };
+
+ private:
+  bool complete_;
+
+  std::vector<Range> ranges_;
+  std::vector<Region> regions_;
+  // Register name -> contents.
+  std::vector<std::pair<std::string, std::string>> registers_;
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_READ_SET_H_
@@ -0,0 +1,156 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/result_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/API/SBThread.h"
+#include "lldb/API/SBValue.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace lldb_eval {
+
+bool ResultCache::Key::operator==(const Key& other) const {
+  return process_id == other.process_id && stop_id == other.stop_id &&
+         thread_id == other.thread_id && frame_index == other.frame_index &&
+         expr == other.expr;
+}
+
+size_t ResultCache::KeyHash::operator()(const Key& key) const {
+  return llvm::hash_combine(key.process_id, key.stop_id, key.thread_id,
+                            key.frame_index, key.expr);
+}
+
+ResultCache::ResultCache()
+    : capacity_(kDefaultCapacity), hits_(0), misses_(0), evictions_(0) {}
+
+ResultCache& ResultCache::Get() {
+  static ResultCache* cache = new ResultCache();
+  return *cache;
+}
+
+bool ResultCache::Lookup(lldb::SBFrame frame, llvm::StringRef canonical_expr,
+                         lldb::SBValue* value, lldb::SBError* error) {
+  Key key = MakeKey(frame, canonical_expr);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  PurgeStaleEntries(key);
+
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++misses_;
+    return false;
+  }
+
+  // Move the entry to the front of the LRU list.
+  entries_.splice(entries_.begin(), entries_, it->second);
+
+  *value = it->second->value;
+  *error = it->second->error;
+  ++hits_;
+  return true;
+}
+
+void ResultCache::Insert(lldb::SBFrame frame, llvm::StringRef canonical_expr,
+                         lldb::SBValue value, const lldb::SBError& error) {
+  Key key = MakeKey(frame, canonical_expr);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (capacity_ == 0) {
+    return;
+  }
+  PurgeStaleEntries(key);
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+
+  entries_.push_front({key, value, error});
+  index_.emplace(key, entries_.begin());
+  EvictToCapacity();
+}
+
+void ResultCache::Invalidate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+}
+
+void ResultCache::SetCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = capacity;
+  EvictToCapacity();
+}
+
+ResultCacheStats ResultCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ResultCacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  stats.size = entries_.size();
+  stats.capacity = capacity_;
+  return stats;
+}
+
+ResultCache::Key ResultCache::MakeKey(lldb::SBFrame frame,
+                                      llvm::StringRef canonical_expr) {
+  lldb::SBThread thread = frame.GetThread();
+  lldb::SBProcess process = thread.GetProcess();
+
+  // Include the stops caused by the expression evaluation (e.g. function calls
+  // made by LLDB), they can modify the process state too.
+  return {process.GetUniqueID(),
+          process.GetStopID(/*include_expression_stops=*/true),
+          thread.GetThreadID(), frame.GetFrameID(), canonical_expr.str()};
+}
+
+void ResultCache::PurgeStaleEntries(const Key& key) {
+  auto stop_id = last_stop_ids_.find(key.process_id);
+  if (stop_id != last_stop_ids_.end() && stop_id->second == key.stop_id) {
+    return;
+  }
+  last_stop_ids_[key.process_id] = key.stop_id;
+
+  // The process has been resumed since these results were computed.
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->key.process_id == key.process_id &&
+        it->key.stop_id != key.stop_id) {
+      index_.erase(it->key);
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ResultCache::EvictToCapacity() {
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+    ++evictions_;
+  }
+}
+
+}  // namespace lldb_eval
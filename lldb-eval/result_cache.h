@@ -0,0 +1,120 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_RESULT_CACHE_H_
+#define LLDB_EVAL_RESULT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "lldb-eval/api.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBValue.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace lldb_eval {
+
+// ResultCache memoizes the results of the evaluations while the process is
+// stopped. Results are keyed by (process, stop ID, thread, frame index,
+// canonical expression), where the canonical expression is produced by
+// PrintCanonical(). Stop IDs include the stops caused by the expression
+// evaluation, so resuming the process or running a function in it invalidates
+// the results automatically.
+//
+// LLDB doesn't expose any "memory generation" counter through the SB API, so
+// the writes made while the process stays stopped must invalidate the cache
+// explicitly. The writes made through lldb_eval::SetValueFromCString() and
+// lldb_eval::WriteMemory() do, the clients writing through the SB API directly
+// (e.g. SBProcess::WriteMemory) must call Invalidate() after such writes.
+//
+// The cache is bounded, the least recently used results are evicted first.
+class ResultCache {
+ public:
+  static const size_t kDefaultCapacity = 1024;
+
+  ResultCache();
+
+  // Returns the cache shared by all evaluations.
+  static ResultCache& Get();
+
+  // Looks up the result of the expression in the given frame. Returns false if
+  // the expression was not evaluated during the current stop.
+  bool Lookup(lldb::SBFrame frame, llvm::StringRef canonical_expr,
+              lldb::SBValue* value, lldb::SBError* error);
+
+  void Insert(lldb::SBFrame frame, llvm::StringRef canonical_expr,
+              lldb::SBValue value, const lldb::SBError& error);
+
+  // Drops all cached results.
+  void Invalidate();
+
+  // Sets the maximum number of cached results, zero disables the cache.
+  void SetCapacity(size_t capacity);
+
+  ResultCacheStats GetStats() const;
+
+ private:
+  struct Key {
+    uint32_t process_id;
+    uint32_t stop_id;
+    uint64_t thread_id;
+    uint32_t frame_index;
+    std::string expr;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    Key key;
+    lldb::SBValue value;
+    lldb::SBError error;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  static Key MakeKey(lldb::SBFrame frame, llvm::StringRef canonical_expr);
+
+  // Drops the results of the previous stops of the process.
+  void PurgeStaleEntries(const Key& key);
+
+  void EvictToCapacity();
+
+ private:
+  mutable std::mutex mutex_;
+  size_t capacity_;
+
+  // Most recently used entries go first.
+  EntryList entries_;
+  std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+  std::unordered_map<uint32_t, uint32_t> last_stop_ids_;
+
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t evictions_;
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_RESULT_CACHE_H_
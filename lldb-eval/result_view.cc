@@ -0,0 +1,265 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/result_view.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "lldb-eval/api.h"
+#include "lldb-eval/formatter.h"
+#include "lldb-eval/pointer.h"
+#include "lldb-eval/scalar.h"
+#include "lldb-eval/value.h"
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBTarget.h"
+#include "lldb/API/SBType.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-enumerations.h"
+
+namespace {
+
+lldb::BasicType GetScalarBasicType(lldb_eval::Scalar::Type type) {
+  using Type = lldb_eval::Scalar::Type;
+  switch (type) {
+    case Type::INT32:
+      return lldb::eBasicTypeInt;
+    case Type::UINT32:
+      return lldb::eBasicTypeUnsignedInt;
+    case Type::INT64:
+      return lldb::eBasicTypeLongLong;
+    case Type::UINT64:
+      return lldb::eBasicTypeUnsignedLongLong;
+    case Type::FLOAT:
+      return lldb::eBasicTypeFloat;
+    case Type::DOUBLE:
+      return lldb::eBasicTypeDouble;
+    case Type::INT128:
+      return lldb::eBasicTypeInt128;
+    case Type::UINT128:
+      return lldb::eBasicTypeUnsignedInt128;
+    case Type::LONG_DOUBLE:
+      return lldb::eBasicTypeLongDouble;
+    case Type::INVALID:
+      break;
+  }
+  return lldb::eBasicTypeInvalid;
+}
+
+size_t GetScalarSize(lldb_eval::Scalar::Type type) {
+  using Type = lldb_eval::Scalar::Type;
+  switch (type) {
+    case Type::INT32:
+    case Type::UINT32:
+    case Type::FLOAT:
+      return 4;
+    case Type::INT64:
+    case Type::UINT64:
+    case Type::DOUBLE:
+      return 8;
+    case Type::INT128:
+    case Type::UINT128:
+      return 16;
+    case Type::LONG_DOUBLE:
+      return sizeof(long double);
+    case Type::INVALID:
+      break;
+  }
+  return 0;
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+ResultView::ResultView(void* buffer, size_t buffer_size)
+    : buffer_(buffer),
+      buffer_size_(buffer_size),
+      size_(0),
+      basic_type_(lldb::eBasicTypeInvalid),
+      is_pointer_(false),
+      is_enum_(false) {}
+
+std::string ResultView::GetTypeName() const {
+  // SB API methods are not const.
+  lldb::SBTarget target = target_;
+  lldb::SBType type =
+      type_.IsValid() ? type_ : target.GetBasicType(basic_type_);
+  const char* name = type.GetName();
+  return name ? name : "";
+}
+
+lldb::SBValue ResultView::GetSbValue() const {
+  lldb::SBValue value = value_;
+  if (value.IsValid()) {
+    return value;
+  }
+  if (size_ == 0 || size_ > buffer_size_) {
+    return lldb::SBValue();
+  }
+
+  lldb::SBTarget target = target_;
+  lldb::SBType type =
+      type_.IsValid() ? type_ : target.GetBasicType(basic_type_);
+  // lldb::SBData::SetData() doesn't actually use "error".
+  lldb::SBError error;
+  lldb::SBData data;
+  data.SetData(error, buffer_, size_, target.GetByteOrder(),
+               static_cast<uint8_t>(target.GetAddressByteSize()));
+  return target.CreateValueFromData("result", data, type);
+}
+
+size_t ResultView::FormatValue(char* buffer, size_t buffer_size,
+                               const FormatOptions& options) const {
+  BufferWriter out(buffer, buffer_size);
+
+  if (size_ > 0 && size_ <= buffer_size_) {
+    bool formatted = false;
+    if (is_pointer_) {
+      formatted = FormatPointerValue(buffer_, size_, out);
+    } else if (is_enum_) {
+      lldb::SBType type = type_;
+      formatted = FormatEnumValue(buffer_, size_, type.GetCanonicalType(),
+                                  options, out);
+    } else if (basic_type_ != lldb::eBasicTypeInvalid) {
+      formatted = FormatBasicValue(buffer_, size_, basic_type_, options, out);
+    }
+    if (formatted) {
+      return out.length();
+    }
+  }
+
+  // Aggregates and the types without a native formatter.
+  lldb::SBValue value = GetSbValue();
+  const char* str = value.GetValue();
+  if (!str) {
+    str = value.GetSummary();
+  }
+  out.Append(str ? str : "");
+  return out.length();
+}
+
+size_t ResultView::FormatTypeName(char* buffer, size_t buffer_size) const {
+  BufferWriter out(buffer, buffer_size);
+
+  lldb::SBType type = type_;
+  const char* name = type.IsValid() ? type.GetName()
+                                    : lldb_eval::GetBasicTypeName(basic_type_);
+  out.Append(name ? name : "");
+  return out.length();
+}
+
+bool ResultViewBuilder::Build(const Value& value, lldb::SBTarget target,
+                              ResultView* view, lldb::SBError& error) {
+  view->target_ = target;
+  view->type_ = lldb::SBType();
+  view->value_ = lldb::SBValue();
+  view->basic_type_ = lldb::eBasicTypeInvalid;
+  view->is_pointer_ = false;
+  view->is_enum_ = false;
+  view->size_ = 0;
+
+  // The scalars and the pointers computed by the interpreter are in the host
+  // byte order, the same as in Value::AsSbValue().
+  Scalar scalar;
+  uint64_t address = 0;
+
+  switch (value.type()) {
+    case Value::Type::INVALID: {
+      error.SetErrorString("invalid result");
+      return false;
+    }
+    case Value::Type::BOOLEAN: {
+      view->basic_type_ = lldb::eBasicTypeBool;
+      view->size_ = 1;
+      scalar = value.AsScalar();
+      break;
+    }
+    case Value::Type::SCALAR: {
+      scalar = value.AsScalar();
+      view->basic_type_ = GetScalarBasicType(scalar.type_);
+      view->size_ = GetScalarSize(scalar.type_);
+      break;
+    }
+    case Value::Type::POINTER: {
+      Pointer pointer = value.AsPointer();
+      view->type_ = pointer.type();
+      view->is_pointer_ = true;
+      view->size_ = static_cast<size_t>(pointer.type().GetByteSize());
+      address = pointer.addr();
+      break;
+    }
+    case Value::Type::SB_VALUE: {
+      lldb::SBValue sb_value = value.AsSbValue(target);
+      lldb::SBType canonical = sb_value.GetType().GetCanonicalType();
+      view->value_ = sb_value;
+      view->type_ = sb_value.GetType();
+      view->basic_type_ = canonical.GetBasicType();
+      view->is_pointer_ = canonical.IsPointerType();
+      view->is_enum_ =
+          canonical.GetTypeClass() == lldb::eTypeClassEnumeration;
+      view->size_ = static_cast<size_t>(sb_value.GetByteSize());
+      break;
+    }
+  }
+
+  if (view->size_ > view->buffer_size_) {
+    error.SetErrorString(("result doesn't fit into the buffer (" +
+                          std::to_string(view->size_) + " bytes required)")
+                             .c_str());
+    return false;
+  }
+
+  switch (value.type()) {
+    case Value::Type::BOOLEAN: {
+      bool b = scalar.AsBool();
+      memcpy(view->buffer_, &b, view->size_);
+      break;
+    }
+    case Value::Type::SCALAR: {
+      memcpy(view->buffer_, &scalar.value_, view->size_);
+      break;
+    }
+    case Value::Type::POINTER: {
+      if (view->size_ == sizeof(uint32_t)) {
+        uint32_t address32 = static_cast<uint32_t>(address);
+        memcpy(view->buffer_, &address32, sizeof(address32));
+      } else if (view->size_ == sizeof(uint64_t)) {
+        memcpy(view->buffer_, &address, sizeof(address));
+      }
+      break;
+    }
+    case Value::Type::SB_VALUE: {
+      if (view->size_ == 0) {
+        break;
+      }
+      lldb::SBData data = view->value_.GetData();
+      lldb::SBError read_error;
+      data.ReadRawData(read_error, 0, view->buffer_, view->size_);
+      if (read_error.Fail()) {
+        error = read_error;
+        return false;
+      }
+      break;
+    }
+    case Value::Type::INVALID:
+      break;
+  }
+
+  return true;
+}
+
+}  // namespace lldb_eval
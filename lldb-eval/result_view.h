@@ -0,0 +1,38 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_RESULT_VIEW_H_
+#define LLDB_EVAL_RESULT_VIEW_H_
+
+#include "lldb-eval/api.h"
+#include "lldb-eval/value.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBTarget.h"
+
+namespace lldb_eval {
+
+class ResultViewBuilder {
+ public:
+  // Writes the value into the view. Fails if the value is invalid or doesn't
+  // fit into the buffer of the view, in which case the view still has the size
+  // and the type of the value.
+  static bool Build(const Value& value, lldb::SBTarget target,
+                    ResultView* view, lldb::SBError& error);
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_RESULT_VIEW_H_
@@ -14,24 +14,153 @@
 
 #include "lldb-eval/scalar.h"
 
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <string>
 
 #include "lldb-eval/defines.h"
+#include "lldb-eval/enum_table.h"
 #include "lldb/API/SBError.h"
+#include "lldb/API/SBTarget.h"
 #include "lldb/API/SBType.h"
 #include "lldb/API/SBValue.h"
 #include "lldb/lldb-enumerations.h"
+#include "llvm/ADT/Triple.h"
 
 namespace lldb_eval {
 
+namespace {
+
+// Returns the number of the significand bits of the target's "long double" of
+// the given size, or zero if its format is unknown.
+int GetLongDoubleDigits(lldb::SBTarget target, uint64_t byte_size) {
+  // "long double" is the same as "double" (e.g. on ARM or with MSVC).
+  if (byte_size == sizeof(double)) {
+    return std::numeric_limits<double>::digits;
+  }
+
+  const char* triple = target.GetTriple();
+  if (!triple) {
+    return 0;
+  }
+  switch (llvm::Triple(triple).getArch()) {
+    case llvm::Triple::x86:
+    case llvm::Triple::x86_64:
+      // x87 extended precision, padded to 12 or 16 bytes.
+      return byte_size == 12 || byte_size == 16 ? 64 : 0;
+    case llvm::Triple::aarch64:
+    case llvm::Triple::aarch64_be:
+    case llvm::Triple::mips64:
+    case llvm::Triple::mips64el:
+    case llvm::Triple::riscv64:
+    case llvm::Triple::sparcv9:
+    case llvm::Triple::systemz:
+      // IEEE binary128.
+      return byte_size == 16 ? 113 : 0;
+    default:
+      // E.g. the double-double of PowerPC, which has the same size.
+      return 0;
+  }
+}
+
+Scalar FromEnumValue(lldb::SBValue value, lldb::SBType type) {
+  // The signedness of the enumeration is cached with its enumerators, so the
+  // values are decoded without asking LLDB about the underlying type.
+  std::shared_ptr<const EnumTable> table = EnumTable::Get(type);
+  if (!table) {
+    return Scalar();
+  }
+
+  // Same as the integers, the narrow enumerations are promoted to int.
+  Scalar ret;
+  lldb::SBError error;
+  lldb::SBData data = value.GetData();
+  bool is_signed = table->is_signed();
+  switch (table->byte_size()) {
+    case 1:
+      ret = is_signed
+                ? Scalar(static_cast<int32_t>(data.GetSignedInt8(error, 0)))
+                : Scalar(static_cast<int32_t>(data.GetUnsignedInt8(error, 0)));
+      break;
+    case 2:
+      ret = is_signed
+                ? Scalar(static_cast<int32_t>(data.GetSignedInt16(error, 0)))
+                : Scalar(static_cast<int32_t>(data.GetUnsignedInt16(error, 0)));
+      break;
+    case 4:
+      ret = is_signed ? Scalar(data.GetSignedInt32(error, 0))
+                      : Scalar(data.GetUnsignedInt32(error, 0));
+      break;
+    case 8:
+      ret = is_signed ? Scalar(data.GetSignedInt64(error, 0))
+                      : Scalar(data.GetUnsignedInt64(error, 0));
+      break;
+    default:
+      break;
+  }
+
+  if (error.Fail()) {
+    // Error trying to get the value: error.GetCString()
+    return Scalar();
+  }
+  return ret;
+}
+
+// Conversion rank of the type: the operands of the binary operators are
+// converted to the type of the higher rank, same as the usual arithmetic
+// conversions of C++ (for the types of 32 bits and wider).
+int GetRank(Scalar::Type type) {
+  switch (type) {
+    case Scalar::Type::INVALID:
+      return 0;
+    case Scalar::Type::INT32:
+      return 1;
+    case Scalar::Type::UINT32:
+      return 2;
+    case Scalar::Type::INT64:
+      return 3;
+    case Scalar::Type::UINT64:
+      return 4;
+    case Scalar::Type::INT128:
+      return 5;
+    case Scalar::Type::UINT128:
+      return 6;
+    case Scalar::Type::FLOAT:
+      return 7;
+    case Scalar::Type::DOUBLE:
+      return 8;
+    case Scalar::Type::LONG_DOUBLE:
+      return 9;
+  }
+  unreachable("Scalar::Type enum wasn't exhausted in the switch statement.");
+}
+
+// Unlike the other binary operators, the operands of the shifts aren't
+// converted to a common type: the result has the type of the left operand and
+// the right one is only the shift count, e.g. "int128 >> unsigned __int128" is
+// an arithmetic shift of "__int128".
+bool GetShiftOperands(const Scalar& lhs, const Scalar& rhs, Scalar* a,
+                      uint64_t* count) {
+  if (rhs.type_ == Scalar::Type::INVALID ||
+      GetRank(rhs.type_) >= GetRank(Scalar::Type::FLOAT)) {
+    return false;
+  }
+  *a = lhs;
+  *count = rhs.GetAs<uint64_t>();
+  return true;
+}
+
+}  // namespace
+
 Scalar::Type PromoteOperands(const Scalar& lhs, const Scalar& rhs, Scalar* a,
                              Scalar* b) {
   *a = lhs;
   *b = rhs;
 
-  if (a->type_ > b->type_) {
+  if (GetRank(a->type_) > GetRank(b->type_)) {
     b->PromoteTo(a->type_);
-  } else if (a->type_ < b->type_) {
+  } else if (GetRank(a->type_) < GetRank(b->type_)) {
     a->PromoteTo(b->type_);
   }
 
@@ -42,136 +171,42 @@ Scalar::Type PromoteOperands(const Scalar& lhs, const Scalar& rhs, Scalar* a,
 }
 
 void Scalar::PromoteTo(Type type) {
-  switch (type_) {
+  // Can't promote undefined values or convert to the lower rank.
+  if (type_ == Type::INVALID || GetRank(type) < GetRank(type_)) {
+    SetInvalid();
+    return;
+  }
+
+  switch (type) {
     case Type::INVALID:
-      // Can't promote undefined values.
       SetInvalid();
       break;
-
     case Type::INT32:
-      switch (type) {
-        case Type::INVALID:
-          SetInvalid();
-          break;
-        case Type::INT32:
-          // No-op, already required type.
-          break;
-        case Type::UINT32:
-          SetValueUInt32(value_.int32_);
-          break;
-        case Type::INT64:
-          SetValueInt64(value_.int32_);
-          break;
-        case Type::UINT64:
-          SetValueUInt64(value_.int32_);
-          break;
-        case Type::FLOAT:
-          SetValueFloat(static_cast<float>(value_.int32_));
-          break;
-        case Type::DOUBLE:
-          SetValueDouble(static_cast<double>(value_.int32_));
-          break;
-      }
+      SetValueInt32(GetAs<int32_t>());
       break;
-
     case Type::UINT32:
-      switch (type) {
-        case Type::INVALID:
-        case Type::INT32:
-          SetInvalid();
-          break;
-        case Type::UINT32:
-          // No-op, already required type.
-          break;
-        case Type::INT64:
-          SetValueInt64(value_.uint32_);
-          break;
-        case Type::UINT64:
-          SetValueUInt64(value_.uint32_);
-          break;
-        case Type::FLOAT:
-          SetValueFloat(static_cast<float>(value_.uint32_));
-          break;
-        case Type::DOUBLE:
-          SetValueDouble(static_cast<double>(value_.uint32_));
-          break;
-      }
+      SetValueUInt32(GetAs<uint32_t>());
       break;
-
     case Type::INT64:
-      switch (type) {
-        case Type::INVALID:
-        case Type::INT32:
-        case Type::UINT32:
-          SetInvalid();
-          break;
-        case Type::INT64:
-          // No-op, already required type.
-          break;
-        case Type::UINT64:
-          SetValueUInt64(value_.int64_);
-          break;
-        case Type::FLOAT:
-          SetValueFloat(static_cast<float>(value_.int64_));
-          break;
-        case Type::DOUBLE:
-          SetValueDouble(static_cast<double>(value_.int64_));
-          break;
-      }
+      SetValueInt64(GetAs<int64_t>());
       break;
-
     case Type::UINT64:
-      switch (type) {
-        case Type::INVALID:
-        case Type::INT32:
-        case Type::UINT32:
-        case Type::INT64:
-          SetInvalid();
-          break;
-        case Type::UINT64:
-          // No-op, already required type.
-          break;
-        case Type::FLOAT:
-          SetValueFloat(static_cast<float>(value_.uint64_));
-          break;
-        case Type::DOUBLE:
-          SetValueDouble(static_cast<double>(value_.uint64_));
-          break;
-      }
+      SetValueUInt64(GetAs<uint64_t>());
+      break;
+    case Type::INT128:
+      SetValueInt128(GetAs<Int128>());
+      break;
+    case Type::UINT128:
+      SetValueUInt128(GetAs<UInt128>());
       break;
-
     case Type::FLOAT:
-      switch (type) {
-        case Type::INVALID:
-        case Type::INT32:
-        case Type::UINT32:
-        case Type::INT64:
-        case Type::UINT64:
-          SetInvalid();
-          break;
-        case Type::FLOAT:
-          // No-op, already required type.
-          break;
-        case Type::DOUBLE:
-          SetValueDouble(static_cast<double>(value_.float_));
-          break;
-      }
+      SetValueFloat(GetAs<float>());
       break;
-
     case Type::DOUBLE:
-      switch (type) {
-        case Type::INVALID:
-        case Type::INT32:
-        case Type::UINT32:
-        case Type::INT64:
-        case Type::UINT64:
-        case Type::FLOAT:
-          SetInvalid();
-          break;
-        case Type::DOUBLE:
-          // No-op, already required type.
-          break;
-      }
+      SetValueDouble(GetAs<double>());
+      break;
+    case Type::LONG_DOUBLE:
+      SetValueLongDouble(GetAs<long double>());
       break;
   }
 }
@@ -180,6 +215,10 @@ Scalar Scalar::FromSbValue(lldb::SBValue value) {
   // Get the canonical type, because the initial one can be a typedef/alias.
   lldb::SBType type = value.GetType().GetCanonicalType();
 
+  if (type.GetTypeClass() == lldb::eTypeClassEnumeration) {
+    return FromEnumValue(value, type);
+  }
+
   switch (type.GetBasicType()) {
     case lldb::eBasicTypeInvalid: {
       // Can't get a Scalar out of SBValue with non-basic type.
@@ -190,9 +229,6 @@ Scalar Scalar::FromSbValue(lldb::SBValue value) {
       break;
     }
     case lldb::eBasicTypeHalf:
-    case lldb::eBasicTypeInt128:
-    case lldb::eBasicTypeUnsignedInt128:
-    case lldb::eBasicTypeLongDouble:
     case lldb::eBasicTypeFloatComplex:
     case lldb::eBasicTypeDoubleComplex:
     case lldb::eBasicTypeLongDoubleComplex:
@@ -303,12 +339,59 @@ Scalar Scalar::FromSbValue(lldb::SBValue value) {
       }
       return Scalar(val);
     }
+    case lldb::eBasicTypeInt128:
+    case lldb::eBasicTypeUnsignedInt128: {
+#if LLDB_EVAL_HAS_INT128
+      // lldb::SBData has no accessors for the 128-bit integers. The contents
+      // are in the host byte order, same as in Value::AsSbValue().
+      UInt128 bits;
+      if (value.GetByteSize() != sizeof(bits)) {
+        break;
+      }
+      lldb::SBError error;
+      size_t read = value.GetData().ReadRawData(error, 0, &bits, sizeof(bits));
+      if (error.Fail() || read != sizeof(bits)) {
+        // Error trying to get int128: error.GetCString()
+        break;
+      }
+      Scalar ret;
+      if (type.GetBasicType() == lldb::eBasicTypeInt128) {
+        ret.SetValueInt128(static_cast<Int128>(bits));
+      } else {
+        ret.SetValueUInt128(bits);
+      }
+      return ret;
+#else
+      // The host compiler doesn't support 128-bit integers.
+      break;
+#endif
+    }
+    case lldb::eBasicTypeLongDouble: {
+      // The extended precision values are decoded by the host, the formats
+      // of the host and the target must match (e.g. both are x87).
+      if (!IsHostLongDoubleFormat(value.GetTarget(), value.GetByteSize())) {
+        break;
+      }
+      lldb::SBError error;
+      long double val = value.GetData().GetLongDouble(error, 0);
+      if (error.Fail()) {
+        // Error trying to get long double: error.GetCString()
+        break;
+      }
+      return Scalar(val);
+    }
   }
 
   // Failed to get a Scalar value from lldb::SBValue.
   return Scalar();
 }
 
+bool IsHostLongDoubleFormat(lldb::SBTarget target, uint64_t byte_size) {
+  return byte_size == sizeof(long double) &&
+         GetLongDoubleDigits(target, byte_size) ==
+             std::numeric_limits<long double>::digits;
+}
+
 const Scalar operator~(const Scalar& rhs) {
   Scalar ret;
 
@@ -327,8 +410,15 @@ const Scalar operator~(const Scalar& rhs) {
     case Scalar::Type::UINT64:
       ret.SetValueUInt64(~rhs.value_.uint64_);
       break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(~rhs.value_.int128_);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(~rhs.value_.uint128_);
+      break;
     case Scalar::Type::FLOAT:
     case Scalar::Type::DOUBLE:
+    case Scalar::Type::LONG_DOUBLE:
       // Can't do & on float/double.
       break;
   }
@@ -353,12 +443,21 @@ const Scalar operator+(const Scalar& lhs, const Scalar& rhs) {
     case Scalar::Type::UINT64:
       ret.SetValueUInt64(a.value_.uint64_ + b.value_.uint64_);
       break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ + b.value_.int128_);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ + b.value_.uint128_);
+      break;
     case Scalar::Type::FLOAT:
       ret.SetValueFloat(a.value_.float_ + b.value_.float_);
       break;
     case Scalar::Type::DOUBLE:
       ret.SetValueDouble(a.value_.double_ + b.value_.double_);
       break;
+    case Scalar::Type::LONG_DOUBLE:
+      ret.SetValueLongDouble(a.value_.long_double_ + b.value_.long_double_);
+      break;
   }
 
   return ret;
@@ -382,12 +481,21 @@ const Scalar operator-(const Scalar& lhs, const Scalar& rhs) {
     case Scalar::Type::UINT64:
       ret.SetValueUInt64(a.value_.uint64_ - b.value_.uint64_);
       break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ - b.value_.int128_);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ - b.value_.uint128_);
+      break;
     case Scalar::Type::FLOAT:
       ret.SetValueFloat(a.value_.float_ - b.value_.float_);
       break;
     case Scalar::Type::DOUBLE:
       ret.SetValueDouble(a.value_.double_ - b.value_.double_);
       break;
+    case Scalar::Type::LONG_DOUBLE:
+      ret.SetValueLongDouble(a.value_.long_double_ - b.value_.long_double_);
+      break;
   }
 
   return ret;
@@ -411,12 +519,21 @@ const Scalar operator/(const Scalar& lhs, const Scalar& rhs) {
     case Scalar::Type::UINT64:
       ret.SetValueUInt64(a.value_.uint64_ / b.value_.uint64_);
       break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ / b.value_.int128_);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ / b.value_.uint128_);
+      break;
     case Scalar::Type::FLOAT:
       ret.SetValueFloat(a.value_.float_ / b.value_.float_);
       break;
     case Scalar::Type::DOUBLE:
       ret.SetValueDouble(a.value_.double_ / b.value_.double_);
       break;
+    case Scalar::Type::LONG_DOUBLE:
+      ret.SetValueLongDouble(a.value_.long_double_ / b.value_.long_double_);
+      break;
   }
 
   return ret;
@@ -440,12 +557,21 @@ const Scalar operator*(const Scalar& lhs, const Scalar& rhs) {
     case Scalar::Type::UINT64:
       ret.SetValueUInt64(a.value_.uint64_ * b.value_.uint64_);
       break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ * b.value_.int128_);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ * b.value_.uint128_);
+      break;
     case Scalar::Type::FLOAT:
       ret.SetValueFloat(a.value_.float_ * b.value_.float_);
       break;
     case Scalar::Type::DOUBLE:
       ret.SetValueDouble(a.value_.double_ * b.value_.double_);
       break;
+    case Scalar::Type::LONG_DOUBLE:
+      ret.SetValueLongDouble(a.value_.long_double_ * b.value_.long_double_);
+      break;
   }
 
   return ret;
@@ -469,8 +595,15 @@ const Scalar operator&(const Scalar& lhs, const Scalar& rhs) {
     case Scalar::Type::UINT64:
       ret.SetValueUInt64(a.value_.uint64_ & b.value_.uint64_);
       break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ & b.value_.int128_);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ & b.value_.uint128_);
+      break;
     case Scalar::Type::FLOAT:
     case Scalar::Type::DOUBLE:
+    case Scalar::Type::LONG_DOUBLE:
       // Can't do & on float/double.
       break;
   }
@@ -496,8 +629,15 @@ const Scalar operator|(const Scalar& lhs, const Scalar& rhs) {
     case Scalar::Type::UINT64:
       ret.SetValueUInt64(a.value_.uint64_ | b.value_.uint64_);
       break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ | b.value_.int128_);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ | b.value_.uint128_);
+      break;
     case Scalar::Type::FLOAT:
     case Scalar::Type::DOUBLE:
+    case Scalar::Type::LONG_DOUBLE:
       // Can't do | on float/double.
       break;
   }
@@ -523,8 +663,15 @@ const Scalar operator%(const Scalar& lhs, const Scalar& rhs) {
     case Scalar::Type::UINT64:
       ret.SetValueUInt64(a.value_.uint64_ % b.value_.uint64_);
       break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ % b.value_.int128_);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ % b.value_.uint128_);
+      break;
     case Scalar::Type::FLOAT:
     case Scalar::Type::DOUBLE:
+    case Scalar::Type::LONG_DOUBLE:
       // Can't do % on float/double.
       break;
   }
@@ -550,8 +697,15 @@ const Scalar operator^(const Scalar& lhs, const Scalar& rhs) {
     case Scalar::Type::UINT64:
       ret.SetValueUInt64(a.value_.uint64_ ^ b.value_.uint64_);
       break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ ^ b.value_.int128_);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ ^ b.value_.uint128_);
+      break;
     case Scalar::Type::FLOAT:
     case Scalar::Type::DOUBLE:
+    case Scalar::Type::LONG_DOUBLE:
       // Can't do ^ on float/double.
       break;
   }
@@ -560,25 +714,37 @@ const Scalar operator^(const Scalar& lhs, const Scalar& rhs) {
 }
 
 const Scalar operator<<(const Scalar& lhs, const Scalar& rhs) {
-  Scalar a, b, ret;
+  Scalar a, ret;
+  uint64_t count;
 
-  switch (PromoteOperands(lhs, rhs, &a, &b)) {
+  if (!GetShiftOperands(lhs, rhs, &a, &count)) {
+    return ret;
+  }
+
+  switch (a.type_) {
     case Scalar::Type::INVALID:
       break;
     case Scalar::Type::INT32:
-      ret.SetValueInt32(a.value_.int32_ << b.value_.int32_);
+      ret.SetValueInt32(a.value_.int32_ << count);
       break;
     case Scalar::Type::UINT32:
-      ret.SetValueUInt32(a.value_.uint32_ << b.value_.uint32_);
+      ret.SetValueUInt32(a.value_.uint32_ << count);
       break;
     case Scalar::Type::INT64:
-      ret.SetValueInt64(a.value_.int64_ << b.value_.int64_);
+      ret.SetValueInt64(a.value_.int64_ << count);
       break;
     case Scalar::Type::UINT64:
-      ret.SetValueUInt64(a.value_.uint64_ << b.value_.uint64_);
+      ret.SetValueUInt64(a.value_.uint64_ << count);
+      break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ << count);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ << count);
       break;
     case Scalar::Type::FLOAT:
     case Scalar::Type::DOUBLE:
+    case Scalar::Type::LONG_DOUBLE:
       // Can't do << on float/double.
       break;
   }
@@ -587,25 +753,37 @@ const Scalar operator<<(const Scalar& lhs, const Scalar& rhs) {
 }
 
 const Scalar operator>>(const Scalar& lhs, const Scalar& rhs) {
-  Scalar a, b, ret;
+  Scalar a, ret;
+  uint64_t count;
 
-  switch (PromoteOperands(lhs, rhs, &a, &b)) {
+  if (!GetShiftOperands(lhs, rhs, &a, &count)) {
+    return ret;
+  }
+
+  switch (a.type_) {
     case Scalar::Type::INVALID:
       break;
     case Scalar::Type::INT32:
-      ret.SetValueInt32(a.value_.int32_ >> b.value_.int32_);
+      ret.SetValueInt32(a.value_.int32_ >> count);
       break;
     case Scalar::Type::UINT32:
-      ret.SetValueUInt32(a.value_.uint32_ >> b.value_.uint32_);
+      ret.SetValueUInt32(a.value_.uint32_ >> count);
       break;
     case Scalar::Type::INT64:
-      ret.SetValueInt64(a.value_.int64_ >> b.value_.int64_);
+      ret.SetValueInt64(a.value_.int64_ >> count);
       break;
     case Scalar::Type::UINT64:
-      ret.SetValueUInt64(a.value_.uint64_ >> b.value_.uint64_);
+      ret.SetValueUInt64(a.value_.uint64_ >> count);
+      break;
+    case Scalar::Type::INT128:
+      ret.SetValueInt128(a.value_.int128_ >> count);
+      break;
+    case Scalar::Type::UINT128:
+      ret.SetValueUInt128(a.value_.uint128_ >> count);
       break;
     case Scalar::Type::FLOAT:
     case Scalar::Type::DOUBLE:
+    case Scalar::Type::LONG_DOUBLE:
       // Can't do >> on float/double.
       break;
   }
@@ -628,10 +806,16 @@ bool operator==(const Scalar& lhs, const Scalar& rhs) {
       return a.value_.int64_ == b.value_.int64_;
     case Scalar::Type::UINT64:
       return a.value_.uint64_ == b.value_.uint64_;
+    case Scalar::Type::INT128:
+      return a.value_.int128_ == b.value_.int128_;
+    case Scalar::Type::UINT128:
+      return a.value_.uint128_ == b.value_.uint128_;
     case Scalar::Type::FLOAT:
       return a.value_.float_ == b.value_.float_;
     case Scalar::Type::DOUBLE:
       return a.value_.double_ == b.value_.double_;
+    case Scalar::Type::LONG_DOUBLE:
+      return a.value_.long_double_ == b.value_.long_double_;
   }
   unreachable("Scalar::Type enum wasn't exhausted in the switch statement.");
 }
@@ -653,10 +837,16 @@ bool operator<(const Scalar& lhs, const Scalar& rhs) {
       return a.value_.int64_ < b.value_.int64_;
     case Scalar::Type::UINT64:
       return a.value_.uint64_ < b.value_.uint64_;
+    case Scalar::Type::INT128:
+      return a.value_.int128_ < b.value_.int128_;
+    case Scalar::Type::UINT128:
+      return a.value_.uint128_ < b.value_.uint128_;
     case Scalar::Type::FLOAT:
       return a.value_.float_ < b.value_.float_;
     case Scalar::Type::DOUBLE:
       return a.value_.double_ < b.value_.double_;
+    case Scalar::Type::LONG_DOUBLE:
+      return a.value_.long_double_ < b.value_.long_double_;
   }
   unreachable("Scalar::Type enum wasn't exhausted in the switch statement.");
 }
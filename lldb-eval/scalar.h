@@ -21,12 +21,28 @@
 #include <string>
 
 #include "lldb-eval/defines.h"
+#include "lldb/API/SBTarget.h"
 #include "lldb/API/SBValue.h"
 
 namespace lldb_eval {
 
+// 128-bit integers of the host. The compilers without __int128 (e.g. MSVC)
+// don't get the 128-bit scalars, the types are only placeholders there and
+// Scalar::FromSbValue() never produces such values.
+#ifdef __SIZEOF_INT128__
+#define LLDB_EVAL_HAS_INT128 1
+__extension__ typedef __int128 Int128;
+__extension__ typedef unsigned __int128 UInt128;
+#else
+#define LLDB_EVAL_HAS_INT128 0
+typedef int64_t Int128;
+typedef uint64_t UInt128;
+#endif
+
 class Scalar {
  public:
+  // New types are appended to keep the serialized literals valid, the order
+  // doesn't define the conversion ranks.
   enum class Type {
     INVALID,
     INT32,
@@ -35,6 +51,9 @@ class Scalar {
     UINT64,
     FLOAT,
     DOUBLE,
+    INT128,
+    UINT128,
+    LONG_DOUBLE,
   };
   union Data {
     int32_t int32_;
@@ -43,6 +62,9 @@ class Scalar {
     uint64_t uint64_;
     float float_;
     double double_;
+    Int128 int128_;
+    UInt128 uint128_;
+    long double long_double_;
   };
 
  public:
@@ -53,6 +75,7 @@ class Scalar {
   explicit Scalar(uint64_t value) { SetValueUInt64(value); }
   explicit Scalar(float value) { SetValueFloat(value); }
   explicit Scalar(double value) { SetValueDouble(value); }
+  explicit Scalar(long double value) { SetValueLongDouble(value); }
 
  public:
   void SetInvalid() { type_ = Type::INVALID; }
@@ -87,6 +110,21 @@ class Scalar {
     value_.double_ = value;
   }
 
+  void SetValueInt128(Int128 value) {
+    type_ = Type::INT128;
+    value_.int128_ = value;
+  }
+
+  void SetValueUInt128(UInt128 value) {
+    type_ = Type::UINT128;
+    value_.uint128_ = value;
+  }
+
+  void SetValueLongDouble(long double value) {
+    type_ = Type::LONG_DOUBLE;
+    value_.long_double_ = value;
+  }
+
   void PromoteTo(Type type);
 
   template <typename T>
@@ -106,6 +144,12 @@ class Scalar {
         return static_cast<T>(value_.float_);
       case Type::DOUBLE:
         return static_cast<T>(value_.double_);
+      case Type::INT128:
+        return static_cast<T>(value_.int128_);
+      case Type::UINT128:
+        return static_cast<T>(value_.uint128_);
+      case Type::LONG_DOUBLE:
+        return static_cast<T>(value_.long_double_);
     }
     unreachable("Scalar::Type enum wasn't exhausted in the switch statement.");
   }
@@ -114,6 +158,8 @@ class Scalar {
 
   int64_t GetInt64() const { return GetAs<int64_t>(); }
 
+  // Returns an invalid Scalar if the value isn't a scalar or can't be decoded
+  // by the host (see IsHostLongDoubleFormat()).
   static Scalar FromSbValue(lldb::SBValue value);
 
   friend const Scalar operator~(const Scalar& rhs);
@@ -158,5 +204,11 @@ bool operator<=(const Scalar& lhs, const Scalar& rhs);
 bool operator>(const Scalar& lhs, const Scalar& rhs);
 bool operator>=(const Scalar& lhs, const Scalar& rhs);
 
+// The "long double" values are computed by the host, which works only if the
+// "long double" of the target has the same format (e.g. both are the 80-bit x87
+// format). Checks the format of the target's "long double" of the given size
+// by its architecture.
+bool IsHostLongDoubleFormat(lldb::SBTarget target, uint64_t byte_size);
+
 }  // namespace lldb_eval
 #endif  // LLDB_EVAL_SCALAR_H_
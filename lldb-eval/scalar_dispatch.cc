@@ -0,0 +1,71 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/scalar_dispatch.h"
+
+#include <cstdint>
+
+#include "lldb-eval/scalar.h"
+#include "lldb/lldb-enumerations.h"
+
+namespace lldb_eval {
+
+Scalar::Type GetScalarType(lldb::BasicType basic_type, uint64_t size) {
+  switch (basic_type) {
+    case lldb::eBasicTypeBool:
+      return size == 1 ? Scalar::Type::UINT32 : Scalar::Type::INVALID;
+
+    case lldb::eBasicTypeChar:
+    case lldb::eBasicTypeSignedChar:
+    case lldb::eBasicTypeWChar:
+    case lldb::eBasicTypeSignedWChar:
+    case lldb::eBasicTypeChar16:
+    case lldb::eBasicTypeChar32:
+    case lldb::eBasicTypeShort:
+    case lldb::eBasicTypeInt:
+    case lldb::eBasicTypeLong:
+    case lldb::eBasicTypeLongLong:
+      return size == 1 || size == 2 || size == 4 ? Scalar::Type::INT32
+             : size == 8                         ? Scalar::Type::INT64
+                                                 : Scalar::Type::INVALID;
+
+    case lldb::eBasicTypeUnsignedChar:
+    case lldb::eBasicTypeUnsignedWChar:
+    case lldb::eBasicTypeUnsignedShort:
+    case lldb::eBasicTypeUnsignedInt:
+    case lldb::eBasicTypeUnsignedLong:
+    case lldb::eBasicTypeUnsignedLongLong:
+      // The narrow types are promoted to int.
+      return size == 1 || size == 2 ? Scalar::Type::INT32
+             : size == 4            ? Scalar::Type::UINT32
+             : size == 8            ? Scalar::Type::UINT64
+                                    : Scalar::Type::INVALID;
+
+    case lldb::eBasicTypeFloat:
+      return size == 4 ? Scalar::Type::FLOAT : Scalar::Type::INVALID;
+
+    case lldb::eBasicTypeDouble:
+      return size == 8 ? Scalar::Type::DOUBLE : Scalar::Type::INVALID;
+
+    default:
+      return Scalar::Type::INVALID;
+  }
+}
+
+bool IsInteger(Scalar::Type type) {
+  return type == Scalar::Type::INT32 || type == Scalar::Type::UINT32 ||
+         type == Scalar::Type::INT64 || type == Scalar::Type::UINT64;
+}
+
+}  // namespace lldb_eval
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_SCALAR_DISPATCH_H_
+#define LLDB_EVAL_SCALAR_DISPATCH_H_
+
+#include <cstdint>
+
+#include "lldb-eval/scalar.h"
+#include "lldb/lldb-enumerations.h"
+
+namespace lldb_eval {
+
+// Helpers for the loops over the native arrays of scalars, e.g. the columns of
+// the range evaluation and the elements reduced by the builtins.
+
+// Maps the basic type to the scalar type it's converted to, like
+// Scalar::FromSbValue() does. Returns INVALID for the types wider than 64 bits
+// and the unsupported types.
+Scalar::Type GetScalarType(lldb::BasicType basic_type, uint64_t size);
+
+// Checks if the type is one of the integer types handled by
+// DispatchIntegerType().
+bool IsInteger(Scalar::Type type);
+
+// Calls f(T()), where T is the C++ type of the scalar type. The types wider
+// than 64 bits aren't dispatched.
+template <typename F>
+void DispatchType(Scalar::Type type, F f) {
+  switch (type) {
+    case Scalar::Type::INT32:
+      f(int32_t());
+      break;
+    case Scalar::Type::UINT32:
+      f(uint32_t());
+      break;
+    case Scalar::Type::INT64:
+      f(int64_t());
+      break;
+    case Scalar::Type::UINT64:
+      f(uint64_t());
+      break;
+    case Scalar::Type::FLOAT:
+      f(float());
+      break;
+    case Scalar::Type::DOUBLE:
+      f(double());
+      break;
+    case Scalar::Type::INT128:
+    case Scalar::Type::UINT128:
+    case Scalar::Type::LONG_DOUBLE:
+    case Scalar::Type::INVALID:
+      break;
+  }
+}
+
+// Like DispatchType(), but only for the integer types. Used for the operators
+// which don't compile for the floating point types.
+template <typename F>
+void DispatchIntegerType(Scalar::Type type, F f) {
+  switch (type) {
+    case Scalar::Type::INT32:
+      f(int32_t());
+      break;
+    case Scalar::Type::UINT32:
+      f(uint32_t());
+      break;
+    case Scalar::Type::INT64:
+      f(int64_t());
+      break;
+    case Scalar::Type::UINT64:
+      f(uint64_t());
+      break;
+    case Scalar::Type::FLOAT:
+    case Scalar::Type::DOUBLE:
+    case Scalar::Type::INT128:
+    case Scalar::Type::UINT128:
+    case Scalar::Type::LONG_DOUBLE:
+    case Scalar::Type::INVALID:
+      break;
+  }
+}
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_SCALAR_DISPATCH_H_
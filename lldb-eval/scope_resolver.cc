@@ -0,0 +1,648 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/scope_resolver.h"
+
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lldb-eval/enum_table.h"
+#include "lldb-eval/module_index.h"
+#include "lldb/API/SBDebugger.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBModule.h"
+#include "lldb/API/SBProcess.h"
+#include "lldb/API/SBTarget.h"
+#include "lldb/API/SBThread.h"
+#include "lldb/API/SBType.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/API/SBValueList.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ThreadPool.h"
+
+namespace {
+
+const llvm::StringRef kAnonymousNamespace = "(anonymous namespace)";
+
+const uint32_t kMaxMatches = std::numeric_limits<uint32_t>::max();
+
+// Checks if the name of a global variable refers to the given qualified name.
+// lldb::SBValue::GetName() can return strings like "::globarVar", "ns::i" or
+// "int const ns::foo" depending on the version and the platform.
+bool VariableNameMatches(llvm::StringRef var_name, const std::string& name) {
+  return var_name == name || var_name == "::" + name ||
+         var_name.endswith(" " + name);
+}
+
+// Returns the first variable matching any of the candidate names and sets the
+// index of the matched candidate. Candidates are checked in the order of
+// priority, the lists are checked in their order for each candidate.
+lldb::SBValue MatchVariable(const std::vector<lldb::SBValueList>& lists,
+                            const std::vector<std::string>& candidates,
+                            size_t* candidate_index) {
+  for (size_t c = 0; c < candidates.size(); ++c) {
+    for (const auto& values : lists) {
+      for (uint32_t i = 0; i < values.GetSize(); ++i) {
+        lldb::SBValue value = values.GetValueAtIndex(i);
+        const char* value_name = value.GetName();
+        if (value_name && VariableNameMatches(value_name, candidates[c])) {
+          *candidate_index = c;
+          return value;
+        }
+      }
+    }
+  }
+  *candidate_index = candidates.size();
+  return lldb::SBValue();
+}
+
+llvm::ThreadPool& GetThreadPool() {
+  static llvm::ThreadPool* pool = new llvm::ThreadPool();
+  return *pool;
+}
+
+// Runs the query for each module on the worker pool and returns the results in
+// the order of the modules.
+template <typename T, typename Query>
+std::vector<T> QueryModules(const std::vector<lldb::SBModule>& modules,
+                            Query query) {
+  std::vector<T> results(modules.size());
+
+  // Not worth the overhead of dispatching to the pool.
+  if (modules.size() < 2) {
+    for (size_t i = 0; i < modules.size(); ++i) {
+      results[i] = query(modules[i]);
+    }
+    return results;
+  }
+
+  // Don't use ThreadPool::wait(), the pool is shared by all resolvers.
+  std::vector<std::shared_future<void>> futures;
+  futures.reserve(modules.size());
+  for (size_t i = 0; i < modules.size(); ++i) {
+    futures.push_back(GetThreadPool().async(
+        [&results, &modules, &query, i] { results[i] = query(modules[i]); }));
+  }
+  for (auto& future : futures) {
+    future.wait();
+  }
+
+  return results;
+}
+
+class ResolverRegistry {
+ public:
+  std::shared_ptr<lldb_eval::ScopeResolver> Get(lldb::SBTarget target,
+                                                lldb::SBModule module,
+                                                const std::string& function) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    EvictDeletedTargets();
+
+    TargetEntry* entry = nullptr;
+    for (auto& e : targets_) {
+      if (e.target == target) {
+        entry = &e;
+        break;
+      }
+    }
+    if (!entry) {
+      targets_.push_back({target, 0, 0, {}, {}});
+      entry = &targets_.back();
+    }
+
+    // Loading or unloading a module can make the previously missing names
+    // resolvable (and vice versa), drop everything resolved so far. The modules
+    // are compared one by one, unloading one module and loading another keeps
+    // their number the same. The walk is done only when the process has
+    // stopped since the last check (the dynamic loader runs only while the
+    // process runs), otherwise comparing the number of the modules catches
+    // the modules added by the user. Replacing a module while stopped goes
+    // unnoticed until the next stop, see ScopeResolver::ClearCache().
+    lldb::SBProcess process = target.GetProcess();
+    uint32_t process_id = process.GetUniqueID();
+    uint32_t stop_id = process.GetStopID(/*include_expression_stops=*/true);
+    bool stopped_since_check =
+        process_id != entry->process_id || stop_id != entry->stop_id;
+    if (target.GetNumModules() != entry->modules.size() ||
+        (stopped_since_check && !HasSameModules(target, entry->modules))) {
+      entry->modules.clear();
+      uint32_t num_modules = target.GetNumModules();
+      entry->modules.reserve(num_modules);
+      for (uint32_t i = 0; i < num_modules; ++i) {
+        entry->modules.push_back(target.GetModuleAtIndex(i));
+      }
+      entry->resolvers.clear();
+    }
+    entry->process_id = process_id;
+    entry->stop_id = stop_id;
+
+    // Same as in LLDB, "module`function" identifies the function.
+    std::string key = lldb_eval::GetModuleKey(module) + "`" + function;
+
+    auto it = entry->resolvers.find(key);
+    if (it != entry->resolvers.end()) {
+      return it->second;
+    }
+
+    auto resolver =
+        std::make_shared<lldb_eval::ScopeResolver>(target, module, function);
+    entry->resolvers.emplace(key, resolver);
+    return resolver;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    targets_.clear();
+  }
+
+ private:
+  struct TargetEntry {
+    lldb::SBTarget target;
+    // The process and its stop when the modules were last compared.
+    uint32_t process_id;
+    uint32_t stop_id;
+    std::vector<lldb::SBModule> modules;
+    std::unordered_map<std::string, std::shared_ptr<lldb_eval::ScopeResolver>>
+        resolvers;
+  };
+
+  static bool HasSameModules(lldb::SBTarget target,
+                             const std::vector<lldb::SBModule>& modules) {
+    if (target.GetNumModules() != modules.size()) {
+      return false;
+    }
+    for (uint32_t i = 0; i < modules.size(); ++i) {
+      if (target.GetModuleAtIndex(i) != modules[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The SB API has no weak handles, the entries hold the targets (and their
+  // modules) only until the targets are deleted from their debuggers.
+  void EvictDeletedTargets() {
+    targets_.erase(
+        std::remove_if(targets_.begin(), targets_.end(),
+                       [](TargetEntry& e) {
+                         lldb::SBDebugger debugger = e.target.GetDebugger();
+                         return !debugger.IsValid() ||
+                                debugger.GetIndexOfTarget(e.target) ==
+                                    std::numeric_limits<uint32_t>::max();
+                       }),
+        targets_.end());
+  }
+
+  std::mutex mutex_;
+  std::vector<TargetEntry> targets_;
+};
+
+ResolverRegistry& GetResolverRegistry() {
+  static ResolverRegistry* registry = new ResolverRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+llvm::StringRef GetBaseName(llvm::StringRef name) {
+  size_t depth = 0;
+  size_t start = 0;
+  for (size_t i = 0; i < name.size(); ++i) {
+    char c = name[i];
+    if (c == '<' || c == '(') {
+      ++depth;
+    } else if ((c == '>' || c == ')') && depth > 0) {
+      --depth;
+    } else if (depth == 0 && name.substr(i).startswith("::")) {
+      start = i + 2;
+      ++i;
+    }
+  }
+  return name.substr(start);
+}
+
+std::vector<std::string> GetEnclosingScopes(llvm::StringRef function_name) {
+  std::vector<std::string> scopes;
+
+  // Split the name into the "::"-separated components. The last component is
+  // the name of the function itself, it's followed by the parameter list.
+  size_t depth = 0;
+  size_t start = 0;
+  for (size_t i = 0; i < function_name.size(); ++i) {
+    if (i == start) {
+      llvm::StringRef rest = function_name.substr(i);
+      // Anonymous namespaces are the only components that contain parentheses.
+      if (rest.startswith(kAnonymousNamespace)) {
+        i += kAnonymousNamespace.size() - 1;
+        continue;
+      }
+      // Operators can contain any characters ("operator<", "operator()"), but
+      // they are always the function names, not scopes.
+      if (rest.startswith("operator")) {
+        break;
+      }
+    }
+
+    char c = function_name[i];
+    if (c == '(' && depth == 0) {
+      // The beginning of the parameter list.
+      break;
+    }
+    if (c == '<' || c == '(') {
+      ++depth;
+    } else if ((c == '>' || c == ')') && depth > 0) {
+      --depth;
+    } else if (depth == 0 && function_name.substr(i).startswith("::")) {
+      llvm::StringRef component = function_name.slice(start, i);
+      scopes.push_back(scopes.empty() ? component.str()
+                                      : scopes.back() + "::" + component.str());
+      start = i + 2;
+      ++i;
+    }
+  }
+
+  // Innermost scope goes first, the global scope goes last.
+  std::reverse(scopes.begin(), scopes.end());
+  scopes.push_back("");
+
+  return scopes;
+}
+
+ScopeResolver::ScopeResolver(lldb::SBTarget target, lldb::SBModule module,
+                             llvm::StringRef function_name)
+    : target_(target),
+      module_(module),
+      scopes_(GetEnclosingScopes(function_name)) {}
+
+std::shared_ptr<ScopeResolver> ScopeResolver::Get(lldb::SBFrame frame) {
+  lldb::SBTarget target = frame.GetThread().GetProcess().GetTarget();
+  if (!target.IsValid()) {
+    return std::make_shared<ScopeResolver>(target, lldb::SBModule(), "");
+  }
+  // For the inlined frames this is the name of the inlined function, which is
+  // exactly what we need.
+  const char* function_name = frame.GetFunctionName();
+  return GetResolverRegistry().Get(target, frame.GetModule(),
+                                   function_name ? function_name : "");
+}
+
+std::shared_ptr<ScopeResolver> ScopeResolver::Get(lldb::SBTarget target) {
+  if (!target.IsValid()) {
+    return std::make_shared<ScopeResolver>(target, lldb::SBModule(), "");
+  }
+  return GetResolverRegistry().Get(target, lldb::SBModule(), "");
+}
+
+void ScopeResolver::ClearCache() { GetResolverRegistry().Clear(); }
+
+lldb::SBType ScopeResolver::ResolveType(llvm::StringRef name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = types_.find(name.str());
+  if (it != types_.end()) {
+    return it->second;
+  }
+
+  // Internally types don't have global scope qualifier in their names and
+  // LLDB doesn't support queries with it too.
+  bool global_scope = name.startswith("::");
+  lldb::SBType type = LookupType(global_scope ? name.drop_front(2) : name,
+                                 global_scope);
+
+  types_.emplace(name.str(), type);
+  return type;
+}
+
+lldb::SBValue ScopeResolver::ResolveVariable(llvm::StringRef name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = variables_.find(name.str());
+  if (it != variables_.end()) {
+    return it->second;
+  }
+
+  // Internally values don't have global scope qualifier in their names and
+  // LLDB doesn't support queries with it too.
+  bool global_scope = name.startswith("::");
+  lldb::SBValue value = LookupVariable(
+      global_scope ? name.drop_front(2) : name, global_scope);
+
+  variables_.emplace(name.str(), value);
+  return value;
+}
+
+bool ScopeResolver::ResolveEnumerator(llvm::StringRef name, lldb::SBType* type,
+                                      uint64_t* value) {
+  lldb::SBType enum_type;
+  bool cached = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = enumerators_.find(name.str());
+    if (it != enumerators_.end()) {
+      enum_type = it->second;
+      cached = true;
+    }
+  }
+
+  // The lookup resolves the types, which takes the lock too.
+  if (!cached) {
+    bool global_scope = name.startswith("::");
+    enum_type = LookupEnumerator(global_scope ? name.drop_front(2) : name,
+                                 global_scope);
+    std::lock_guard<std::mutex> lock(mutex_);
+    enumerators_.emplace(name.str(), enum_type);
+  }
+
+  std::shared_ptr<const EnumTable> table = EnumTable::Get(enum_type);
+  if (!table || !table->Find(GetBaseName(name), value)) {
+    return false;
+  }
+  *type = enum_type;
+  return true;
+}
+
+std::vector<std::string> ScopeResolver::GetCandidateNames(
+    llvm::StringRef name, bool global_scope) const {
+  if (global_scope) {
+    return {name.str()};
+  }
+
+  std::vector<std::string> candidates;
+  candidates.reserve(scopes_.size());
+  for (const auto& scope : scopes_) {
+    candidates.push_back(scope.empty() ? name.str()
+                                       : scope + "::" + name.str());
+  }
+  return candidates;
+}
+
+std::vector<lldb::SBModule> ScopeResolver::GetOtherModules() {
+  std::vector<lldb::SBModule> modules;
+  uint32_t num_modules = target_.GetNumModules();
+  modules.reserve(num_modules);
+  for (uint32_t i = 0; i < num_modules; ++i) {
+    lldb::SBModule module = target_.GetModuleAtIndex(i);
+    if (module.IsValid() && module != module_) {
+      modules.push_back(module);
+    }
+  }
+  return modules;
+}
+
+lldb::SBType ScopeResolver::LookupType(llvm::StringRef name,
+                                       bool global_scope) {
+  std::vector<std::string> candidates = GetCandidateNames(name, global_scope);
+  std::string query = name.str();
+
+  // SBModule::FindTypes will return all matched types, including the ones one
+  // in different scopes. I.e. if seaching for "myint", this will also return
+  // "ns::myint" and "Foo::myint".
+  std::vector<std::pair<std::string, lldb::SBType>> found;
+  auto add_types = [&found](lldb::SBTypeList types) {
+    for (uint32_t i = 0; i < types.GetSize(); ++i) {
+      lldb::SBType type = types.GetTypeAtIndex(i);
+      const char* type_name = type.GetName();
+      found.emplace_back(type_name ? type_name : "", type);
+    }
+  };
+
+  // Look for the type in the enclosing scopes, the innermost scope wins. Among
+  // the matches in the same scope, the ones found first win.
+  auto find_candidate = [&found, &candidates](size_t* candidate_index) {
+    for (size_t c = 0; c < candidates.size(); ++c) {
+      for (const auto& f : found) {
+        if (f.first == candidates[c]) {
+          *candidate_index = c;
+          return f.second;
+        }
+      }
+    }
+    *candidate_index = candidates.size();
+    return lldb::SBType();
+  };
+
+  size_t candidate_index;
+  if (module_.IsValid()) {
+    add_types(module_.FindTypes(query.c_str()));
+    // The other modules can only win with a match in a more inner scope.
+    lldb::SBType type = find_candidate(&candidate_index);
+    if (type.IsValid() && candidate_index == 0) {
+      return type;
+    }
+  }
+
+  std::vector<lldb::SBModule> modules = GetOtherModules();
+  auto results = QueryModules<lldb::SBTypeList>(
+      modules, [&query](lldb::SBModule module) {
+        std::shared_ptr<ModuleIndex> index = ModuleIndex::Find(module);
+        if (index && !index->MayContainType(query)) {
+          return lldb::SBTypeList();
+        }
+        return module.FindTypes(query.c_str());
+      });
+  for (auto& types : results) {
+    add_types(types);
+  }
+
+  if (found.empty() && !module_.IsValid()) {
+    // The indexes don't know about the builtin types (e.g. "unsigned char"),
+    // but LLDB can resolve them through any module (or through the target, if
+    // nothing is loaded).
+    add_types(modules.empty() ? target_.FindTypes(query.c_str())
+                              : modules.front().FindTypes(query.c_str()));
+  }
+
+  lldb::SBType type = find_candidate(&candidate_index);
+  if (type.IsValid() || global_scope) {
+    // Look only for full matches when looking for a globally qualified type.
+    return type;
+  }
+
+  // The type is not visible from the current scope (e.g. it's a local type of
+  // some function). Pick the closest partial match, the shortest name wins and
+  // the ties are broken alphabetically to keep the results deterministic.
+  std::string suffix = "::" + query;
+  const std::pair<std::string, lldb::SBType>* best = nullptr;
+  for (const auto& f : found) {
+    if (!llvm::StringRef(f.first).endswith(suffix)) {
+      continue;
+    }
+    if (!best || f.first.size() < best->first.size() ||
+        (f.first.size() == best->first.size() && f.first < best->first)) {
+      best = &f;
+    }
+  }
+
+  return best ? best->second : lldb::SBType();
+}
+
+lldb::SBValue ScopeResolver::FindGlobalVariable(
+    const std::string& query, const std::vector<std::string>& candidates) {
+  lldb::SBTarget target = target_;
+
+  // The variables of the module of the function go first, they win among the
+  // matches in the same scope.
+  std::vector<lldb::SBValueList> lists;
+  size_t candidate_index;
+  if (module_.IsValid()) {
+    lists.push_back(
+        module_.FindGlobalVariables(target, query.c_str(), kMaxMatches));
+    // The other modules can only win with a match in a more inner scope.
+    lldb::SBValue value = MatchVariable(lists, candidates, &candidate_index);
+    if (value.IsValid() && candidate_index == 0) {
+      return value;
+    }
+  }
+
+  // The indexes don't know about the constants folded by the compiler, the
+  // modules ruled out by them are searched only if nothing is found elsewhere.
+  std::vector<lldb::SBModule> modules;
+  std::vector<lldb::SBModule> unlikely_modules;
+  for (const auto& module : GetOtherModules()) {
+    std::shared_ptr<ModuleIndex> index = ModuleIndex::Find(module);
+    if (index && !index->MayContainGlobalVariable(query)) {
+      unlikely_modules.push_back(module);
+    } else {
+      modules.push_back(module);
+    }
+  }
+
+  auto find_variables = [&target, &query](lldb::SBModule module) {
+    // SBModule::FindGlobalVariables takes a non-const reference.
+    lldb::SBTarget module_target = target;
+    return module.FindGlobalVariables(module_target, query.c_str(),
+                                      kMaxMatches);
+  };
+
+  auto results = QueryModules<lldb::SBValueList>(modules, find_variables);
+  lists.insert(lists.end(), results.begin(), results.end());
+  lldb::SBValue value = MatchVariable(lists, candidates, &candidate_index);
+  if (value.IsValid() || unlikely_modules.empty()) {
+    return value;
+  }
+
+  results = QueryModules<lldb::SBValueList>(unlikely_modules, find_variables);
+  lists.insert(lists.end(), results.begin(), results.end());
+  return MatchVariable(lists, candidates, &candidate_index);
+}
+
+lldb::SBValue ScopeResolver::LookupVariable(llvm::StringRef name,
+                                            bool global_scope) {
+  std::vector<std::string> candidates = GetCandidateNames(name, global_scope);
+
+  // List global variables with the same name. There can be many matches from
+  // other scopes (namespaces, classes), the candidates are matched in the
+  // priority order.
+  lldb::SBValue value = FindGlobalVariable(name.str(), candidates);
+
+  // LLDB can't resolve the names relative to the enclosing scopes (e.g.
+  // "ns2::x" from "ns1"), so look for all the variables with the same base
+  // name.
+  llvm::StringRef base_name = GetBaseName(name);
+  if (!value && !global_scope && base_name != name) {
+    value = FindGlobalVariable(base_name.str(), candidates);
+  }
+
+  return value;
+}
+
+lldb::SBType ScopeResolver::LookupEnumerator(llvm::StringRef name,
+                                             bool global_scope) {
+  llvm::StringRef base_name = GetBaseName(name);
+
+  // Both scoped and unscoped enumerators can be qualified by the enumeration,
+  // e.g. "Color::kRed".
+  if (base_name.size() + 2 <= name.size()) {
+    llvm::StringRef scope = name.drop_back(base_name.size() + 2);
+    lldb::SBType type =
+        ResolveType(global_scope ? ("::" + scope).str() : scope.str());
+    std::shared_ptr<const EnumTable> table = EnumTable::Get(type);
+    uint64_t value;
+    if (table && table->Find(base_name, &value)) {
+      return type;
+    }
+  }
+
+  // The enumerators of the unscoped enumerations are members of the enclosing
+  // scope of the enumeration, e.g. "ns::kRed". Look for them in the enclosing
+  // scopes, the innermost scope wins. Among the matches in the same scope, the
+  // ones found first win.
+  using Enumerators = std::vector<std::pair<std::string, lldb::SBType>>;
+  std::vector<std::string> candidates = GetCandidateNames(name, global_scope);
+  Enumerators found;
+  auto find_candidate = [&found, &candidates](size_t* candidate_index) {
+    for (size_t c = 0; c < candidates.size(); ++c) {
+      for (const auto& f : found) {
+        if (f.first == candidates[c]) {
+          *candidate_index = c;
+          return f.second;
+        }
+      }
+    }
+    *candidate_index = candidates.size();
+    return lldb::SBType();
+  };
+
+  size_t candidate_index;
+  if (module_.IsValid()) {
+    found = FindEnumerators(module_, base_name);
+    // The other modules can only win with a match in a more inner scope.
+    lldb::SBType type = find_candidate(&candidate_index);
+    if (type.IsValid() && candidate_index == 0) {
+      return type;
+    }
+  }
+
+  // The enumeration can be declared in another module, e.g. in a shared
+  // library whose headers are included by the module of the function.
+  auto results = QueryModules<Enumerators>(
+      GetOtherModules(), [&base_name](lldb::SBModule module) {
+        return FindEnumerators(module, base_name);
+      });
+  for (const auto& enumerators : results) {
+    found.insert(found.end(), enumerators.begin(), enumerators.end());
+  }
+
+  lldb::SBType type = find_candidate(&candidate_index);
+  if (type.IsValid() || global_scope) {
+    return type;
+  }
+
+  // The enumeration is not visible from the current scope (e.g. it's a local
+  // type of some function). Pick the closest partial match, same as for the
+  // types.
+  std::string suffix = "::" + name.str();
+  const std::pair<std::string, lldb::SBType>* best = nullptr;
+  for (const auto& f : found) {
+    if (!llvm::StringRef(f.first).endswith(suffix)) {
+      continue;
+    }
+    if (!best || f.first.size() < best->first.size() ||
+        (f.first.size() == best->first.size() && f.first < best->first)) {
+      best = &f;
+    }
+  }
+  return best ? best->second : lldb::SBType();
+}
+
+}  // namespace lldb_eval
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_SCOPE_RESOLVER_H_
+#define LLDB_EVAL_SCOPE_RESOLVER_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBModule.h"
+#include "lldb/API/SBTarget.h"
+#include "lldb/API/SBType.h"
+#include "lldb/API/SBValue.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace lldb_eval {
+
+// Returns the last component of the qualified name, e.g. "x" for "ns::Foo::x"
+// and "cx" for "ns::T<ns::Foo>::cx".
+llvm::StringRef GetBaseName(llvm::StringRef name);
+
+// Returns the scopes (namespaces and classes) enclosing the given function,
+// starting from the innermost one. The last element is always the global scope
+// (empty string). E.g. for "ns1::Foo::bar(int)" the result is
+// ["ns1::Foo", "ns1", ""].
+std::vector<std::string> GetEnclosingScopes(llvm::StringRef function_name);
+
+// ScopeResolver resolves type and variable names the same way the compiler
+// would do in the body of a particular function: relative names are looked up
+// in the enclosing scopes of the function, starting from the innermost one.
+// If the current frame is in "ns1::ns2::Foo::bar()", then "ns2::x" resolves to
+// "ns1::ns2::x" and "x" prefers "ns1::ns2::Foo::x" to "ns1::x".
+//
+// Most of the names used in an expression come from the module of the current
+// function, so this module is searched first. Unless the name is found there in
+// the innermost scope, the rest of the modules are searched concurrently. The
+// innermost scope still wins, the module of the function wins only among the
+// matches in the same scope, the rest are merged in the order of the modules
+// in the target to keep the lookup deterministic. Modules that can't contain
+// the type according to their ModuleIndex are skipped, the ones that can't
+// contain the variable are searched last. Indexes are never built on the
+// lookup path, see PrepareTarget().
+//
+// The results are cached, so each name is looked up only once per function.
+class ScopeResolver {
+ public:
+  ScopeResolver(lldb::SBTarget target, lldb::SBModule module,
+                llvm::StringRef function_name);
+
+  // Returns a resolver for the function of the given frame. Resolvers are
+  // shared by all evaluations in the same function of the same module.
+  static std::shared_ptr<ScopeResolver> Get(lldb::SBFrame frame);
+  // Returns a resolver for the global scope of the target.
+  static std::shared_ptr<ScopeResolver> Get(lldb::SBTarget target);
+
+  // Drops the shared resolvers together with the names resolved by them, the
+  // following lookups start from scratch.
+  static void ClearCache();
+
+  // Resolves the type by its (possibly qualified) name, e.g. "myint",
+  // "ns::Foo" or "::ns::T<int>".
+  lldb::SBType ResolveType(llvm::StringRef name);
+
+  // Resolves the global or static variable by its (possibly qualified) name,
+  // e.g. "x", "Foo::y" or "::ns::x".
+  lldb::SBValue ResolveVariable(llvm::StringRef name);
+
+  // Resolves the enumerator by its (possibly qualified) name, e.g. "kRed",
+  // "Color::kRed" or "::ns::kRed". Sets the enumeration type and the value of
+  // the enumerator. The enumerators of the unscoped enumerations are looked up
+  // among the enumeration types of the module of the function first, then
+  // among the ones of the other modules of the target.
+  bool ResolveEnumerator(llvm::StringRef name, lldb::SBType* type,
+                         uint64_t* value);
+
+  const std::vector<std::string>& scopes() const { return scopes_; }
+
+ private:
+  lldb::SBType LookupType(llvm::StringRef name, bool global_scope);
+  lldb::SBValue LookupVariable(llvm::StringRef name, bool global_scope);
+  lldb::SBType LookupEnumerator(llvm::StringRef name, bool global_scope);
+
+  // Looks up the global variable by the given query and returns the first one
+  // matching any of the candidate names.
+  lldb::SBValue FindGlobalVariable(const std::string& query,
+                                   const std::vector<std::string>& candidates);
+
+  // Returns all modules of the target except for the module of the function.
+  std::vector<lldb::SBModule> GetOtherModules();
+
+  // Returns the candidate qualified names for the given name, in the order of
+  // the lookup priority.
+  std::vector<std::string> GetCandidateNames(llvm::StringRef name,
+                                             bool global_scope) const;
+
+ private:
+  lldb::SBTarget target_;
+  lldb::SBModule module_;
+  std::vector<std::string> scopes_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, lldb::SBType> types_;
+  std::unordered_map<std::string, lldb::SBValue> variables_;
+  // Enumeration types declaring the enumerators.
+  std::unordered_map<std::string, lldb::SBType> enumerators_;
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_SCOPE_RESOLVER_H_
@@ -0,0 +1,641 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/std_layout.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-enumerations.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSwitch.h"
+
+namespace {
+
+using lldb_eval::StdClass;
+
+// The members are looked up in the nested members and the base classes, e.g.
+// "_M_impl._M_start" of libstdc++ std::vector is in a base class of a member of
+// a base class.
+const int kMaxMemberDepth = 6;
+
+// Offsets of the members the objects are decoded from, in bytes.
+struct StdLayout {
+  StdClass std_class = StdClass::kNone;
+  // kVector: the begin pointer. kString, kStringView: the data pointer.
+  // kArray: the elements. kUniquePtr, kSharedPtr: the pointer.
+  uint64_t data_offset = 0;
+  // kVector: the end pointer. kString, kStringView: the size.
+  uint64_t end_offset = 0;
+  // kArray: the number of the elements.
+  uint64_t count = 0;
+
+  // libc++ strings keep the short strings inside the object. The lowest bit of
+  // the first byte of the short representation tells if the string is long,
+  // the rest of the byte is the size of a short string.
+  bool short_strings = false;
+  uint64_t short_offset = 0;
+  uint64_t short_data_offset = 0;
+
+  // kMap, kSet: "data_offset" is the root pointer. kUnorderedMap,
+  // kUnorderedSet: "data_offset" is the pointer to the first node,
+  // "buckets_offset" and "bucket_count_offset" are the bucket array. The
+  // number of the elements is at "end_offset".
+  uint64_t buckets_offset = 0;
+  uint64_t bucket_count_offset = 0;
+  // The element and the key types can't be derived from the template
+  // arguments of the containers alone (e.g. libc++ wraps the pairs of the
+  // maps), the types are cached together with the offsets.
+  lldb::SBType element_type;
+  lldb::SBType key_type;
+  // The offsets in the nodes, the addresses are filled by DecodeStdObject().
+  lldb_eval::StdNodes nodes;
+};
+
+// Returns the name of the class template in the "std" namespace, e.g. "vector"
+// of "std::__1::vector<int, std::__1::allocator<int> >", or an empty string.
+llvm::StringRef GetStdTemplateName(llvm::StringRef name) {
+  if (!name.consume_front("std::")) {
+    return llvm::StringRef();
+  }
+  // Skip the inline namespaces, e.g. "__1::" of libc++ or "__cxx11::" of
+  // libstdc++.
+  while (name.startswith("__")) {
+    size_t end = name.find("::");
+    if (end == llvm::StringRef::npos || end > name.find('<')) {
+      break;
+    }
+    name = name.drop_front(end + 2);
+  }
+  size_t template_args = name.find('<');
+  if (template_args == llvm::StringRef::npos) {
+    return llvm::StringRef();
+  }
+  return name.take_front(template_args);
+}
+
+StdClass GetStdClass(llvm::StringRef name) {
+  return llvm::StringSwitch<StdClass>(GetStdTemplateName(name))
+      .Case("vector", StdClass::kVector)
+      .Case("basic_string", StdClass::kString)
+      .Case("basic_string_view", StdClass::kStringView)
+      .Case("array", StdClass::kArray)
+      .Case("unique_ptr", StdClass::kUniquePtr)
+      .Case("shared_ptr", StdClass::kSharedPtr)
+      .Case("map", StdClass::kMap)
+      .Case("set", StdClass::kSet)
+      .Case("unordered_map", StdClass::kUnorderedMap)
+      .Case("unordered_set", StdClass::kUnorderedSet)
+      .Default(StdClass::kNone);
+}
+
+bool IsStdTemplate(lldb::SBType type, llvm::StringRef name) {
+  return type.IsValid() &&
+         GetStdTemplateName(type.GetCanonicalType().GetName()) == name;
+}
+
+// Looks for the member with the given name in the type, its base classes and
+// its members. Sets the offset of the member within the type.
+bool FindMember(lldb::SBType type, llvm::StringRef name, uint64_t* offset,
+                lldb::SBType* member_type, int depth = 0) {
+  if (depth > kMaxMemberDepth) {
+    return false;
+  }
+  type = type.GetCanonicalType();
+
+  uint32_t num_fields = type.GetNumberOfFields();
+  for (uint32_t i = 0; i < num_fields; ++i) {
+    lldb::SBTypeMember field = type.GetFieldAtIndex(i);
+    const char* field_name = field.GetName();
+    if (field_name && name == field_name && !field.IsBitfield()) {
+      *offset = field.GetOffsetInBytes();
+      *member_type = field.GetType();
+      return true;
+    }
+  }
+
+  uint32_t num_bases = type.GetNumberOfDirectBaseClasses();
+  for (uint32_t i = 0; i < num_bases; ++i) {
+    lldb::SBTypeMember base = type.GetDirectBaseClassAtIndex(i);
+    if (FindMember(base.GetType(), name, offset, member_type, depth + 1)) {
+      *offset += base.GetOffsetInBytes();
+      return true;
+    }
+  }
+
+  for (uint32_t i = 0; i < num_fields; ++i) {
+    lldb::SBTypeMember field = type.GetFieldAtIndex(i);
+    lldb::SBType field_type = field.GetType().GetCanonicalType();
+    if (!(field_type.GetTypeClass() &
+          (lldb::eTypeClassClass | lldb::eTypeClassStruct |
+           lldb::eTypeClassUnion))) {
+      continue;
+    }
+    if (FindMember(field_type, name, offset, member_type, depth + 1)) {
+      *offset += field.GetOffsetInBytes();
+      return true;
+    }
+  }
+  return false;
+}
+
+// Looks for the first of the alternative pairs of members, e.g. the members of
+// libstdc++ and of libc++.
+bool FindMembers(lldb::SBType type,
+                 std::initializer_list<std::pair<const char*, const char*>>
+                     alternatives,
+                 uint64_t* first_offset, uint64_t* second_offset,
+                 lldb::SBType* first_type) {
+  lldb::SBType second_type;
+  for (const auto& names : alternatives) {
+    if (FindMember(type, names.first, first_offset, first_type) &&
+        FindMember(type, names.second, second_offset, &second_type)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Alignment of the type, the largest alignment of its scalar members.
+uint64_t GetAlignment(lldb::SBType type, uint64_t address_size) {
+  type = type.GetCanonicalType();
+  if (type.IsPointerType() || type.IsReferenceType()) {
+    return address_size;
+  }
+  if (type.IsArrayType()) {
+    return GetAlignment(type.GetArrayElementType(), address_size);
+  }
+  uint32_t num_fields = type.GetNumberOfFields();
+  uint32_t num_bases = type.GetNumberOfDirectBaseClasses();
+  if (num_fields == 0 && num_bases == 0) {
+    uint64_t size = type.GetByteSize();
+    return size == 0 ? 1 : std::min<uint64_t>(size, 16);
+  }
+  uint64_t alignment = 1;
+  for (uint32_t i = 0; i < num_fields; ++i) {
+    lldb::SBType field_type = type.GetFieldAtIndex(i).GetType();
+    alignment = std::max(alignment, GetAlignment(field_type, address_size));
+  }
+  for (uint32_t i = 0; i < num_bases; ++i) {
+    lldb::SBType base_type = type.GetDirectBaseClassAtIndex(i).GetType();
+    alignment = std::max(alignment, GetAlignment(base_type, address_size));
+  }
+  return alignment;
+}
+
+uint64_t AlignTo(uint64_t offset, uint64_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+// libc++ maps keep the pairs in the "__cc_" (or "__cc") member of
+// "__value_type" and "__hash_value_type". Adds the offset of the pair to the
+// offset of the element.
+lldb::SBType UnwrapValueType(lldb::SBType type, uint64_t* offset) {
+  type = type.GetCanonicalType();
+  llvm::StringRef name = GetStdTemplateName(type.GetName());
+  if (name != "__value_type" && name != "__hash_value_type") {
+    return type;
+  }
+  uint64_t pair_offset;
+  lldb::SBType pair_type;
+  if (!FindMember(type, "__cc_", &pair_offset, &pair_type) &&
+      !FindMember(type, "__cc", &pair_offset, &pair_type)) {
+    return lldb::SBType();
+  }
+  *offset += pair_offset;
+  return pair_type.GetCanonicalType();
+}
+
+// std::map and std::set are red-black trees. The links of the nodes are in a
+// base class of the nodes, the element follows them.
+bool ComputeTreeLayout(lldb::SBType type, StdLayout* layout) {
+  bool is_map = layout->std_class == StdClass::kMap;
+  uint64_t offset, link_offset, tree_offset, size_offset;
+  lldb::SBType member_type, node_type, tree_type;
+  lldb_eval::StdNodes& nodes = layout->nodes;
+
+  if (FindMember(type, "_M_header", &offset, &node_type)) {
+    // libstdc++: the parent of the header node is the root.
+    if (!FindMember(node_type, "_M_parent", &link_offset, &member_type) ||
+        !FindMember(node_type, "_M_left", &nodes.left_offset, &member_type) ||
+        !FindMember(node_type, "_M_right", &nodes.right_offset,
+                    &member_type) ||
+        !FindMember(type, "_M_node_count", &size_offset, &member_type) ||
+        !FindMember(type, "_M_t", &tree_offset, &tree_type)) {
+      return false;
+    }
+    layout->element_type =
+        tree_type.GetCanonicalType().GetTemplateArgumentType(1);
+  } else if (FindMembers(type, {{"__end_node_", "__size_"}},
+                         &offset, &size_offset, &member_type) ||
+             FindMembers(type, {{"__pair1_", "__pair3_"}}, &offset,
+                         &size_offset, &member_type)) {
+    // libc++: the left child of the end node is the root.
+    if (!FindMember(member_type, "__left_", &link_offset, &node_type) ||
+        !FindMember(type, "__tree_", &tree_offset, &tree_type)) {
+      return false;
+    }
+    node_type = node_type.GetCanonicalType().GetPointeeType();
+    if (!FindMember(node_type, "__left_", &nodes.left_offset, &member_type) ||
+        !FindMember(node_type, "__right_", &nodes.right_offset,
+                    &member_type)) {
+      return false;
+    }
+    layout->element_type =
+        tree_type.GetCanonicalType().GetTemplateArgumentType(0);
+  } else {
+    return false;
+  }
+
+  layout->data_offset = offset + link_offset;
+  layout->end_offset = size_offset;
+  nodes.value_offset = node_type.GetCanonicalType().GetByteSize();
+  layout->element_type =
+      UnwrapValueType(layout->element_type, &nodes.value_offset);
+  layout->key_type = type.GetTemplateArgumentType(0);
+  nodes.standard_keys =
+      IsStdTemplate(type.GetTemplateArgumentType(is_map ? 2 : 1), "less");
+  return layout->element_type.IsValid() && layout->key_type.IsValid() &&
+         nodes.value_offset > 0;
+}
+
+// std::unordered_map and std::unordered_set keep all elements in a singly
+// linked list, the buckets point to the nodes before their first nodes.
+bool ComputeHashTableLayout(lldb::SBType type, uint64_t address_size,
+                            StdLayout* layout) {
+  bool is_map = layout->std_class == StdClass::kUnorderedMap;
+  uint64_t offset, link_offset, table_offset, count_offset;
+  lldb::SBType member_type, node_type, table_type, buckets_type;
+  lldb_eval::StdNodes& nodes = layout->nodes;
+
+  if (FindMember(type, "_M_buckets", &layout->buckets_offset, &member_type)) {
+    // libstdc++: "_M_before_begin" is the node before the first node. The
+    // nodes start with the link, the element follows it (and the cached hash
+    // follows the element).
+    if (!FindMember(type, "_M_bucket_count", &layout->bucket_count_offset,
+                    &member_type) ||
+        !FindMember(type, "_M_before_begin", &offset, &node_type) ||
+        !FindMember(node_type, "_M_nxt", &link_offset, &member_type) ||
+        !FindMember(type, "_M_element_count", &layout->end_offset,
+                    &member_type) ||
+        !FindMember(type, "_M_h", &table_offset, &table_type)) {
+      return false;
+    }
+    layout->element_type =
+        table_type.GetCanonicalType().GetTemplateArgumentType(1);
+    nodes.value_offset = node_type.GetCanonicalType().GetByteSize();
+  } else if (FindMember(type, "__bucket_list_", &layout->buckets_offset,
+                        &buckets_type)) {
+    // libc++: the bucket list is a std::unique_ptr with the bucket count in
+    // its deleter. The nodes are the link, the hash and the element.
+    if ((!FindMember(buckets_type, "__data_", &count_offset, &member_type) &&
+         !FindMember(buckets_type, "__size_", &count_offset, &member_type)) ||
+        (!FindMember(type, "__p1_", &offset, &node_type) &&
+         !FindMember(type, "__first_node_", &offset, &node_type)) ||
+        !FindMember(node_type, "__next_", &link_offset, &member_type) ||
+        (!FindMember(type, "__p2_", &layout->end_offset, &member_type) &&
+         !FindMember(type, "__size_", &layout->end_offset, &member_type)) ||
+        !FindMember(type, "__table_", &table_offset, &table_type)) {
+      return false;
+    }
+    layout->bucket_count_offset = layout->buckets_offset + count_offset;
+    layout->element_type =
+        table_type.GetCanonicalType().GetTemplateArgumentType(0);
+    nodes.libcxx_buckets = true;
+    nodes.hash_offset = address_size;
+    nodes.value_offset = 2 * address_size;
+  } else {
+    return false;
+  }
+
+  layout->data_offset = offset + link_offset;
+  nodes.next_offset = link_offset;
+  layout->element_type =
+      UnwrapValueType(layout->element_type, &nodes.value_offset);
+  if (!layout->element_type.IsValid()) {
+    return false;
+  }
+  nodes.value_offset = AlignTo(
+      nodes.value_offset, GetAlignment(layout->element_type, address_size));
+  layout->key_type = type.GetTemplateArgumentType(0);
+  nodes.standard_hash =
+      IsStdTemplate(type.GetTemplateArgumentType(is_map ? 2 : 1), "hash");
+  nodes.standard_keys = IsStdTemplate(
+      type.GetTemplateArgumentType(is_map ? 3 : 2), "equal_to");
+  return layout->key_type.IsValid();
+}
+
+StdLayout ComputeLayout(lldb::SBType type, uint64_t address_size) {
+  StdLayout layout;
+  StdClass std_class = GetStdClass(type.GetName());
+  lldb::SBType member_type;
+  layout.std_class = std_class;
+
+  switch (std_class) {
+    case StdClass::kNone:
+      return layout;
+
+    case StdClass::kVector:
+      // Both implementations keep the begin and the end pointers. The
+      // iterators of libstdc++ std::vector<bool> are not pointers.
+      if (!FindMembers(type,
+                       {{"_M_start", "_M_finish"}, {"__begin_", "__end_"}},
+                       &layout.data_offset, &layout.end_offset,
+                       &member_type) ||
+          !member_type.GetCanonicalType().IsPointerType()) {
+        return StdLayout();
+      }
+      break;
+
+    case StdClass::kString: {
+      // libstdc++ strings (the C++11 ABI).
+      if (FindMembers(type, {{"_M_p", "_M_string_length"}},
+                      &layout.data_offset, &layout.end_offset, &member_type)) {
+        break;
+      }
+      // libc++ strings, the long and the short representations.
+      uint64_t long_offset, size_offset, data_offset;
+      lldb::SBType long_type, short_type;
+      if (!FindMember(type, "__l", &long_offset, &long_type) ||
+          !FindMember(type, "__s", &layout.short_offset, &short_type) ||
+          !FindMember(long_type, "__data_", &data_offset, &member_type) ||
+          !FindMember(long_type, "__size_", &size_offset, &member_type) ||
+          !FindMember(short_type, "__data_", &layout.short_data_offset,
+                      &member_type)) {
+        return StdLayout();
+      }
+      layout.data_offset = long_offset + data_offset;
+      layout.end_offset = long_offset + size_offset;
+      layout.short_data_offset += layout.short_offset;
+      layout.short_strings = true;
+      break;
+    }
+
+    case StdClass::kStringView:
+      if (!FindMembers(type,
+                       {{"_M_str", "_M_len"},
+                        {"__data_", "__size_"},
+                        {"__data", "__size"}},
+                       &layout.data_offset, &layout.end_offset,
+                       &member_type)) {
+        return StdLayout();
+      }
+      break;
+
+    case StdClass::kArray: {
+      if (!FindMember(type, "_M_elems", &layout.data_offset, &member_type) &&
+          !FindMember(type, "__elems_", &layout.data_offset, &member_type)) {
+        return StdLayout();
+      }
+      member_type = member_type.GetCanonicalType();
+      uint64_t element_size = type.GetTemplateArgumentType(0).GetByteSize();
+      if (!member_type.IsArrayType() || element_size == 0) {
+        return StdLayout();
+      }
+      layout.count = member_type.GetByteSize() / element_size;
+      break;
+    }
+
+    case StdClass::kUniquePtr:
+      // The deleters are usually empty, then the object is just the pointer
+      // (both implementations keep it first).
+      if (type.GetByteSize() != address_size) {
+        return StdLayout();
+      }
+      layout.data_offset = 0;
+      break;
+
+    case StdClass::kSharedPtr:
+      if (!FindMember(type, "_M_ptr", &layout.data_offset, &member_type) &&
+          !FindMember(type, "__ptr_", &layout.data_offset, &member_type)) {
+        return StdLayout();
+      }
+      break;
+
+    case StdClass::kMap:
+    case StdClass::kSet:
+      if (!ComputeTreeLayout(type, &layout)) {
+        return StdLayout();
+      }
+      break;
+
+    case StdClass::kUnorderedMap:
+    case StdClass::kUnorderedSet:
+      if (!ComputeHashTableLayout(type, address_size, &layout)) {
+        return StdLayout();
+      }
+      break;
+  }
+  return layout;
+}
+
+// The layouts are cached by the types, they don't change between the
+// evaluations. SBType doesn't expose its module in LLDB 10, so the types with
+// the same name are told apart by comparing them, the types of different
+// modules (e.g. of a 32-bit and a 64-bit process) are not equal.
+class LayoutRegistry {
+ public:
+  StdLayout Get(lldb::SBType type, uint64_t address_size) {
+    std::string key = std::to_string(address_size) + ":" + type.GetName();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (const StdLayout* layout = Find(key, type)) {
+        return *layout;
+      }
+    }
+    StdLayout layout = ComputeLayout(type, address_size);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!Find(key, type)) {
+      layouts_[key].emplace_back(type, layout);
+    }
+    return layout;
+  }
+
+ private:
+  // Must be called with the lock held.
+  const StdLayout* Find(const std::string& key, lldb::SBType type) {
+    auto it = layouts_.find(key);
+    if (it == layouts_.end()) {
+      return nullptr;
+    }
+    for (auto& [cached_type, layout] : it->second) {
+      if (cached_type == type) {
+        return &layout;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  std::mutex mutex_;
+  // Address size and type name -> the types with that name and their layouts.
+  std::unordered_map<std::string,
+                     std::vector<std::pair<lldb::SBType, StdLayout>>>
+      layouts_;
+};
+
+LayoutRegistry& GetLayoutRegistry() {
+  static LayoutRegistry* registry = new LayoutRegistry();
+  return *registry;
+}
+
+bool ReadUnsigned(lldb::SBData& data, uint64_t offset, uint64_t size,
+                  uint64_t* value) {
+  if (offset + size > data.GetByteSize()) {
+    return false;
+  }
+  lldb::SBError error;
+  switch (size) {
+    case 1:
+      *value = data.GetUnsignedInt8(error, offset);
+      break;
+    case 4:
+      *value = data.GetUnsignedInt32(error, offset);
+      break;
+    case 8:
+      *value = data.GetUnsignedInt64(error, offset);
+      break;
+    default:
+      return false;
+  }
+  return error.Success();
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+bool DecodeStdObject(lldb::SBValue value, StdObject* object) {
+  if (value.GetType().IsReferenceType()) {
+    value = value.Dereference();
+  }
+  lldb::SBType type = value.GetType().GetCanonicalType();
+  if (!(type.GetTypeClass() &
+        (lldb::eTypeClassClass | lldb::eTypeClassStruct))) {
+    return false;
+  }
+
+  lldb::SBData data = value.GetData();
+  uint64_t address_size = data.GetAddressByteSize();
+  StdLayout layout = GetLayoutRegistry().Get(type, address_size);
+  if (layout.std_class == StdClass::kNone) {
+    return false;
+  }
+
+  object->std_class = layout.std_class;
+  object->element_type = layout.element_type.IsValid()
+                             ? layout.element_type
+                             : type.GetTemplateArgumentType(0);
+  object->size = 0;
+  object->key_type = layout.key_type;
+  object->nodes = layout.nodes;
+  if (!object->element_type.IsValid()) {
+    return false;
+  }
+
+  uint64_t element_size = object->element_type.GetByteSize();
+  uint64_t end;
+  switch (layout.std_class) {
+    case StdClass::kNone:
+      return false;
+
+    case StdClass::kVector:
+      if (element_size == 0 ||
+          !ReadUnsigned(data, layout.data_offset, address_size,
+                        &object->data) ||
+          !ReadUnsigned(data, layout.end_offset, address_size, &end) ||
+          end < object->data) {
+        return false;
+      }
+      object->size = (end - object->data) / element_size;
+      return true;
+
+    case StdClass::kString:
+      if (layout.short_strings) {
+        uint64_t flags;
+        if (!ReadUnsigned(data, layout.short_offset, 1, &flags)) {
+          return false;
+        }
+        if (!(flags & 1)) {
+          // The short string is in the object.
+          lldb::addr_t address = value.GetLoadAddress();
+          if (address == LLDB_INVALID_ADDRESS) {
+            return false;
+          }
+          object->data = address + layout.short_data_offset;
+          object->size = flags >> 1;
+          return true;
+        }
+      }
+      return ReadUnsigned(data, layout.data_offset, address_size,
+                          &object->data) &&
+             ReadUnsigned(data, layout.end_offset, address_size,
+                          &object->size);
+
+    case StdClass::kStringView:
+      return ReadUnsigned(data, layout.data_offset, address_size,
+                          &object->data) &&
+             ReadUnsigned(data, layout.end_offset, address_size,
+                          &object->size);
+
+    case StdClass::kArray: {
+      lldb::addr_t address = value.GetLoadAddress();
+      if (address == LLDB_INVALID_ADDRESS) {
+        return false;
+      }
+      object->data = address + layout.data_offset;
+      object->size = layout.count;
+      return true;
+    }
+
+    case StdClass::kUniquePtr:
+    case StdClass::kSharedPtr:
+      return ReadUnsigned(data, layout.data_offset, address_size,
+                          &object->data);
+
+    case StdClass::kMap:
+    case StdClass::kSet:
+      return ReadUnsigned(data, layout.data_offset, address_size,
+                          &object->nodes.head) &&
+             ReadUnsigned(data, layout.end_offset, address_size,
+                          &object->size);
+
+    case StdClass::kUnorderedMap:
+    case StdClass::kUnorderedSet:
+      return ReadUnsigned(data, layout.data_offset, address_size,
+                          &object->nodes.head) &&
+             ReadUnsigned(data, layout.end_offset, address_size,
+                          &object->size) &&
+             ReadUnsigned(data, layout.buckets_offset, address_size,
+                          &object->nodes.buckets) &&
+             ReadUnsigned(data, layout.bucket_count_offset, address_size,
+                          &object->nodes.bucket_count);
+  }
+  return false;
+}
+
+StdClass GetStdClass(lldb::SBType type) {
+  return ::GetStdClass(type.GetCanonicalType().GetName());
+}
+
+}  // namespace lldb_eval
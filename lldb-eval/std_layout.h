@@ -0,0 +1,124 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_STD_LAYOUT_H_
+#define LLDB_EVAL_STD_LAYOUT_H_
+
+#include <cstdint>
+
+#include "lldb/API/SBType.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-types.h"
+
+namespace lldb_eval {
+
+// Classes of the C++ standard library, which are decoded natively.
+enum class StdClass {
+  kNone,
+  kVector,
+  kString,
+  kStringView,
+  kArray,
+  kUniquePtr,
+  kSharedPtr,
+  kMap,
+  kSet,
+  kUnorderedMap,
+  kUnorderedSet,
+};
+
+// Nodes of the associative containers, see std_lookup.h.
+struct StdNodes {
+  // std::map, std::set: the root of the red-black tree. The unordered
+  // containers: the first node of the list of all elements.
+  lldb::addr_t head = 0;
+  // Offsets in the nodes: the children in the tree, the next node in the list
+  // and the element.
+  uint64_t left_offset = 0;
+  uint64_t right_offset = 0;
+  uint64_t next_offset = 0;
+  uint64_t value_offset = 0;
+  // The elements are ordered by std::less or compared by std::equal_to, i.e.
+  // the keys can be looked up.
+  bool standard_keys = false;
+
+  // The unordered containers: the array of the buckets, each bucket points to
+  // the node before its first node. The keys are hashed by std::hash.
+  lldb::addr_t buckets = 0;
+  uint64_t bucket_count = 0;
+  bool standard_hash = false;
+  // libc++ keeps the hash in the nodes and masks it by the power of two bucket
+  // counts.
+  bool libcxx_buckets = false;
+  uint64_t hash_offset = 0;
+};
+
+// Contents of an object of the standard library class.
+struct StdObject {
+  StdClass std_class = StdClass::kNone;
+  // Type of the elements, or of the object the smart pointer points to.
+  lldb::SBType element_type;
+  // Address of the first element, or the pointer of the smart pointer.
+  lldb::addr_t data = 0;
+  // Number of the elements, not used by the smart pointers.
+  uint64_t size = 0;
+
+  // The associative containers: type of the keys and the nodes. The elements
+  // are the std::pairs of the maps and the keys of the sets.
+  lldb::SBType key_type;
+  StdNodes nodes;
+
+  bool IsSmartPointer() const {
+    return std_class == StdClass::kUniquePtr ||
+           std_class == StdClass::kSharedPtr;
+  }
+  bool IsString() const {
+    return std_class == StdClass::kString ||
+           std_class == StdClass::kStringView;
+  }
+  bool IsAssociative() const {
+    return std_class == StdClass::kMap || std_class == StdClass::kSet ||
+           IsUnordered();
+  }
+  bool IsUnordered() const {
+    return std_class == StdClass::kUnorderedMap ||
+           std_class == StdClass::kUnorderedSet;
+  }
+  bool IsMap() const {
+    return std_class == StdClass::kMap ||
+           std_class == StdClass::kUnorderedMap;
+  }
+};
+
+// Decodes the object of std::vector, std::basic_string, std::basic_string_view,
+// std::array, std::unique_ptr, std::shared_ptr, std::map, std::set,
+// std::unordered_map or std::unordered_set (or a reference to it). Both
+// libstdc++ and libc++ layouts are supported.
+//
+// The members are read directly, neither the data formatters of LLDB nor the
+// functions of the process are used. The offsets of the members are looked up
+// once per type and cached. Returns false if the value isn't an object of
+// these classes or its layout isn't recognized (e.g. std::vector<bool>, the
+// copy-on-write strings of the old libstdc++ ABI).
+bool DecodeStdObject(lldb::SBValue value, StdObject* object);
+
+// Returns the class of the standard library the type is an instance of, or
+// kNone. Only the name of the type is checked, not its layout.
+StdClass GetStdClass(lldb::SBType type);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_STD_LAYOUT_H_
@@ -0,0 +1,445 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/std_lookup.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "lldb-eval/memory_reader.h"
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-enumerations.h"
+#include "llvm/Support/FormatVariadic.h"
+
+namespace {
+
+using lldb_eval::EvalError;
+using lldb_eval::EvalErrorCode;
+using lldb_eval::ReadSet;
+using lldb_eval::StdKey;
+using lldb_eval::StdNodes;
+using lldb_eval::StdObject;
+
+// Red-black trees of n nodes are at most 2 * log2(n + 1) deep, the deeper
+// trees are corrupted.
+const int kMaxTreeDepth = 128;
+
+// Upper bound of the string keys.
+const size_t kMaxKeyLength = 1024 * 1024;
+
+// Reads the nodes of the containers through the cache of the current stop and
+// decodes their members. The writes made while the process stays stopped
+// invalidate the cache (see InvalidateStopCache()).
+class NodeReader {
+ public:
+  NodeReader(lldb::SBTarget target, ReadSet* read_set)
+      : reader_(target.GetProcess(), read_set),
+        byte_order_(target.GetByteOrder()),
+        address_size_(target.GetAddressByteSize()) {}
+
+  bool Read(lldb::addr_t address, size_t size, std::string* bytes,
+            EvalError& error) {
+    if (!reader_.ReadCached(address, size, bytes)) {
+      error.Set(EvalErrorCode::UNKNOWN,
+                llvm::formatv("can't read memory at 0x{0:x}", address));
+      return false;
+    }
+    return true;
+  }
+
+  uint64_t GetUnsigned(const std::string& bytes, uint64_t offset,
+                       uint64_t size) const {
+    return lldb_eval::DecodeUnsigned(bytes, offset, size, byte_order_);
+  }
+
+  lldb::addr_t GetPointer(const std::string& bytes, uint64_t offset) const {
+    return GetUnsigned(bytes, offset, address_size_);
+  }
+
+  uint64_t address_size() const { return address_size_; }
+
+ private:
+  lldb_eval::MemoryReader reader_;
+  lldb::ByteOrder byte_order_;
+  uint64_t address_size_;
+};
+
+// Truncates the integer to the size of the type and sign-extends it if the
+// type is signed.
+uint64_t Normalize(uint64_t value, uint64_t size, bool is_signed) {
+  if (size >= sizeof(uint64_t)) {
+    return value;
+  }
+  uint64_t mask = (uint64_t{1} << (size * 8)) - 1;
+  value &= mask;
+  if (is_signed && (value >> (size * 8 - 1)) & 1) {
+    value |= ~mask;
+  }
+  return value;
+}
+
+int CompareIntegers(uint64_t lhs, uint64_t rhs, bool is_signed) {
+  if (is_signed) {
+    int64_t signed_lhs = static_cast<int64_t>(lhs);
+    int64_t signed_rhs = static_cast<int64_t>(rhs);
+    return (signed_lhs > signed_rhs) - (signed_lhs < signed_rhs);
+  }
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+bool IsIntegral(lldb::SBType type) {
+  lldb::BasicType basic_type = type.GetCanonicalType().GetBasicType();
+  return basic_type >= lldb::eBasicTypeChar &&
+         basic_type <= lldb::eBasicTypeBool;
+}
+
+bool IsCharType(lldb::SBType type) {
+  lldb::BasicType basic_type = type.GetCanonicalType().GetBasicType();
+  return basic_type == lldb::eBasicTypeChar ||
+         basic_type == lldb::eBasicTypeSignedChar ||
+         basic_type == lldb::eBasicTypeUnsignedChar;
+}
+
+bool IsCharString(lldb::SBType type) {
+  return lldb_eval::GetStdClass(type) == lldb_eval::StdClass::kString &&
+         IsCharType(type.GetCanonicalType().GetTemplateArgumentType(0));
+}
+
+// Compares the keys in the nodes with the key of the lookup.
+class KeyComparer {
+ public:
+  KeyComparer(lldb::SBTarget target, const StdObject& object,
+              const StdKey& key, NodeReader* reader)
+      : target_(target),
+        key_type_(object.key_type),
+        key_(key),
+        reader_(reader) {
+    key_size_ = key_type_.GetByteSize();
+  }
+
+  // Size of the keys in the nodes.
+  uint64_t key_size() const { return key_size_; }
+
+  // Integral key of the node, "offset" is the offset of the key in the
+  // contents of the node.
+  uint64_t GetInteger(const std::string& node, uint64_t offset) const {
+    return Normalize(reader_->GetUnsigned(node, offset, key_size_), key_size_,
+                     key_.is_signed);
+  }
+
+  // Sets "order" to the sign of the difference of the key of the node (at
+  // the given address) and the key of the lookup.
+  bool Compare(lldb::addr_t address, const std::string& node, uint64_t offset,
+               int* order, EvalError& error) {
+    if (!key_.is_string) {
+      *order = CompareIntegers(GetInteger(node, offset), key_.integer,
+                               key_.is_signed);
+      return true;
+    }
+
+    // Only the common prefix of the strings is read, the sizes decide if the
+    // prefixes are equal.
+    lldb_eval::StdObject str;
+    lldb::SBValue value = target_.CreateValueFromAddress(
+        "key", target_.ResolveLoadAddress(address), key_type_);
+    if (!lldb_eval::DecodeStdObject(value, &str)) {
+      error.Set(EvalErrorCode::UNKNOWN,
+                llvm::formatv("can't read the key at 0x{0:x}", address));
+      return false;
+    }
+    size_t size = static_cast<size_t>(
+        std::min<uint64_t>(str.size, key_.str.size()));
+    std::string prefix;
+    if (size > 0 && !reader_->Read(str.data, size, &prefix, error)) {
+      return false;
+    }
+    int diff = size > 0 ? memcmp(prefix.data(), key_.str.data(), size) : 0;
+    if (diff == 0) {
+      *order = CompareIntegers(str.size, key_.str.size(), false);
+    } else {
+      *order = diff > 0 ? 1 : -1;
+    }
+    return true;
+  }
+
+ private:
+  lldb::SBTarget target_;
+  lldb::SBType key_type_;
+  const StdKey& key_;
+  NodeReader* reader_;
+  uint64_t key_size_;
+};
+
+void ReportCorruptedNodes(lldb::addr_t address, EvalError& error) {
+  error.Set(EvalErrorCode::UNKNOWN,
+            llvm::formatv("the nodes of the container at 0x{0:x} are corrupted",
+                          address));
+}
+
+bool FindInTree(const StdNodes& nodes, NodeReader& reader,
+                KeyComparer& comparer, lldb::addr_t* element,
+                EvalError& error) {
+  uint64_t node_size =
+      std::max({nodes.left_offset + reader.address_size(),
+                nodes.right_offset + reader.address_size(),
+                nodes.value_offset + comparer.key_size()});
+  std::string node;
+  lldb::addr_t address = nodes.head;
+  for (int depth = 0; address != 0; ++depth) {
+    if (depth == kMaxTreeDepth) {
+      ReportCorruptedNodes(nodes.head, error);
+      return false;
+    }
+    if (!reader.Read(address, static_cast<size_t>(node_size), &node, error)) {
+      return false;
+    }
+    int order;
+    if (!comparer.Compare(address + nodes.value_offset, node,
+                          nodes.value_offset, &order, error)) {
+      return false;
+    }
+    if (order == 0) {
+      *element = address + nodes.value_offset;
+      return true;
+    }
+    address = reader.GetPointer(
+        node, order > 0 ? nodes.left_offset : nodes.right_offset);
+  }
+  return true;
+}
+
+// Index of the bucket of the hash. libc++ masks the hash if the number of the
+// buckets is a power of two.
+uint64_t GetBucket(const StdNodes& nodes, uint64_t hash) {
+  uint64_t count = nodes.bucket_count;
+  if (nodes.libcxx_buckets && (count & (count - 1)) == 0) {
+    return hash & (count - 1);
+  }
+  return hash % count;
+}
+
+bool FindInHashTable(const StdObject& object, const StdKey& key,
+                     NodeReader& reader, KeyComparer& comparer,
+                     lldb::addr_t* element, EvalError& error) {
+  const StdNodes& nodes = object.nodes;
+  uint64_t address_size = reader.address_size();
+  uint64_t node_size =
+      std::max({nodes.next_offset + address_size,
+                nodes.hash_offset + address_size,
+                nodes.value_offset + comparer.key_size()});
+
+  // std::hash of the integers is the identity, the bucket of the key is known
+  // without running the code of the process.
+  bool use_buckets = !key.is_string && nodes.standard_hash &&
+                     nodes.buckets != 0 && nodes.bucket_count != 0;
+  uint64_t bucket = 0;
+  lldb::addr_t address = nodes.head;
+  if (use_buckets) {
+    bucket = GetBucket(nodes, Normalize(key.integer, address_size, false));
+    std::string link;
+    if (!reader.Read(nodes.buckets + bucket * address_size,
+                     static_cast<size_t>(address_size), &link, error)) {
+      return false;
+    }
+    // The bucket points to the node before its first node.
+    lldb::addr_t before = reader.GetPointer(link, 0);
+    if (before == 0) {
+      return true;
+    }
+    if (!reader.Read(before + nodes.next_offset,
+                     static_cast<size_t>(address_size), &link, error)) {
+      return false;
+    }
+    address = reader.GetPointer(link, 0);
+  }
+
+  std::string node;
+  for (uint64_t count = 0; address != 0; ++count) {
+    if (count > object.size) {
+      ReportCorruptedNodes(nodes.head, error);
+      return false;
+    }
+    if (!reader.Read(address, static_cast<size_t>(node_size), &node, error)) {
+      return false;
+    }
+    if (use_buckets) {
+      // The buckets are contiguous parts of the list, the next bucket starts
+      // where the key would be already found.
+      uint64_t hash =
+          nodes.libcxx_buckets
+              ? reader.GetPointer(node, nodes.hash_offset)
+              : Normalize(comparer.GetInteger(node, nodes.value_offset),
+                          address_size, false);
+      if (GetBucket(nodes, hash) != bucket) {
+        return true;
+      }
+    }
+    int order;
+    if (!comparer.Compare(address + nodes.value_offset, node,
+                          nodes.value_offset, &order, error)) {
+      return false;
+    }
+    if (order == 0) {
+      *element = address + nodes.value_offset;
+      return true;
+    }
+    address = reader.GetPointer(node, nodes.next_offset);
+  }
+  return true;
+}
+
+bool ReadStringKey(lldb::SBTarget target, lldb::SBValue value,
+                   ReadSet* read_set, std::string* str, EvalError& error) {
+  lldb::SBType type = value.GetType().GetCanonicalType();
+
+  lldb_eval::StdObject object;
+  if (lldb_eval::DecodeStdObject(value, &object) && object.IsString() &&
+      IsCharType(object.element_type)) {
+    if (object.size > kMaxKeyLength) {
+      error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                llvm::formatv("the key is longer than {0} bytes",
+                              kMaxKeyLength));
+      return false;
+    }
+    if (object.size == 0) {
+      str->clear();
+      return true;
+    }
+    return NodeReader(target, read_set)
+        .Read(object.data, static_cast<size_t>(object.size), str, error);
+  }
+
+  bool terminated;
+  lldb::addr_t address;
+  size_t max_length = kMaxKeyLength;
+  if (type.IsArrayType() && IsCharType(type.GetArrayElementType())) {
+    size_t size = static_cast<size_t>(type.GetByteSize());
+    address = value.GetLoadAddress();
+    if (address == LLDB_INVALID_ADDRESS) {
+      // E.g. a string literal, the contents are in the host memory.
+      lldb::SBData data = value.GetData();
+      lldb::SBError read_error;
+      str->assign(std::min(size, max_length), '\0');
+      if (!str->empty()) {
+        data.ReadRawData(read_error, 0, &(*str)[0], str->size());
+      }
+      const char* end =
+          static_cast<const char*>(memchr(str->data(), 0, str->size()));
+      if (end) {
+        str->resize(static_cast<size_t>(end - str->data()));
+      }
+      return true;
+    }
+    // The arrays don't have to be terminated.
+    max_length = std::min(max_length, size);
+  } else if (type.IsPointerType() && IsCharType(type.GetPointeeType())) {
+    address = static_cast<lldb::addr_t>(value.GetValueAsUnsigned());
+    if (address == 0) {
+      error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+                "the key is a null pointer");
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  lldb_eval::MemoryReader reader(target.GetProcess(), read_set);
+  if (!reader.ReadCString(address, max_length, str, &terminated)) {
+    error.Set(EvalErrorCode::UNKNOWN,
+              llvm::formatv("can't read memory at 0x{0:x}",
+                            reader.failed_address()));
+    return false;
+  }
+  if (!terminated && max_length == kMaxKeyLength) {
+    error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+              llvm::formatv("the key is longer than {0} bytes",
+                            kMaxKeyLength));
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+namespace lldb_eval {
+
+bool MakeStdKey(lldb::SBTarget target, const StdObject& object,
+                lldb::SBValue value, ReadSet* read_set, StdKey* key,
+                EvalError& error) {
+  if (value.GetType().IsReferenceType()) {
+    value = value.Dereference();
+  }
+  lldb::SBType key_type = object.key_type;
+  lldb::SBType type = value.GetType().GetCanonicalType();
+
+  if (IsIntegral(key_type) && key_type.GetByteSize() <= sizeof(uint64_t)) {
+    if (IsIntegral(type)) {
+      bool value_is_signed = type.GetTypeFlags() & lldb::eTypeIsSigned;
+      uint64_t bits =
+          value_is_signed ? static_cast<uint64_t>(value.GetValueAsSigned())
+                          : value.GetValueAsUnsigned();
+      key->is_string = false;
+      key->is_signed =
+          key_type.GetCanonicalType().GetTypeFlags() & lldb::eTypeIsSigned;
+      key->integer = Normalize(bits, key_type.GetByteSize(), key->is_signed);
+      return true;
+    }
+  } else if (IsCharString(key_type)) {
+    key->is_string = true;
+    if (ReadStringKey(target, value, read_set, &key->str, error)) {
+      return true;
+    }
+    if (error) {
+      return false;
+    }
+  } else {
+    error.Set(EvalErrorCode::NOT_IMPLEMENTED,
+              llvm::formatv("lookups by the keys of type '{0}' are not "
+                            "supported",
+                            key_type.GetName()));
+    return false;
+  }
+
+  error.Set(EvalErrorCode::INVALID_OPERAND_TYPE,
+            llvm::formatv("cannot convert '{0}' to the key type '{1}'",
+                          value.GetTypeName(), key_type.GetName()));
+  return false;
+}
+
+bool FindStdKey(lldb::SBTarget target, const StdObject& object,
+                const StdKey& key, ReadSet* read_set, lldb::addr_t* element,
+                EvalError& error) {
+  *element = 0;
+  // Custom comparators can't be called without running the code of the
+  // process.
+  if (!object.nodes.standard_keys) {
+    error.Set(EvalErrorCode::NOT_IMPLEMENTED,
+              "lookups in the containers with custom key comparison are not "
+              "supported");
+    return false;
+  }
+
+  NodeReader reader(target, read_set);
+  KeyComparer comparer(target, object, key, &reader);
+  if (object.IsUnordered()) {
+    return FindInHashTable(object, key, reader, comparer, element, error);
+  }
+  return FindInTree(object.nodes, reader, comparer, element, error);
+}
+
+}  // namespace lldb_eval
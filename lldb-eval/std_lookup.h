@@ -0,0 +1,71 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_STD_LOOKUP_H_
+#define LLDB_EVAL_STD_LOOKUP_H_
+
+#include <cstdint>
+#include <string>
+
+#include "lldb-eval/eval.h"
+#include "lldb-eval/read_set.h"
+#include "lldb-eval/std_layout.h"
+#include "lldb/API/SBTarget.h"
+#include "lldb/API/SBValue.h"
+#include "lldb/lldb-types.h"
+
+namespace lldb_eval {
+
+// Key of a lookup in an associative container, converted to the key type of
+// the container.
+struct StdKey {
+  bool is_string = false;
+  // Integral keys, sign-extended if the key type is signed.
+  uint64_t integer = 0;
+  bool is_signed = false;
+  // std::string keys.
+  std::string str;
+};
+
+// Converts the value to the key of the container. The integral keys accept
+// integers, the std::string keys accept string literals, C strings, arrays of
+// chars and std::string objects. Other key types aren't supported.
+bool MakeStdKey(lldb::SBTarget target, const StdObject& object,
+                lldb::SBValue value, ReadSet* read_set, StdKey* key,
+                EvalError& error);
+
+// Looks up the key in the std::map, std::set, std::unordered_map or
+// std::unordered_set decoded by DecodeStdObject(). Sets "element" to the
+// address of the element with the key (the std::pair of the maps), or to 0 if
+// there is no such element.
+//
+// The nodes are read directly from the memory of the process:
+//  - the red-black trees are walked from the root, O(log n) nodes are read;
+//  - the hash tables are walked from the bucket of the key, if the key is an
+//    integer hashed by std::hash (the identity). The hashes of other keys
+//    (e.g. the strings) are computed by the library, the list of all nodes is
+//    scanned instead.
+// Each node is read by a single request, which covers the links, the hash and
+// the key. The nodes are cached until the process is resumed or its memory is
+// written (see InvalidateStopCache()), the lookups in the same stop don't read
+// them again.
+bool FindStdKey(lldb::SBTarget target, const StdObject& object,
+                const StdKey& key, ReadSet* read_set, lldb::addr_t* element,
+                EvalError& error);
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_STD_LOOKUP_H_
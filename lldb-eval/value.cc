@@ -53,8 +53,10 @@ namespace lldb_eval {
 
 bool Value::IsScalar() {
   if (type_ == Type::SB_VALUE) {
-    return sb_value_.GetType().GetCanonicalType().GetBasicType() !=
-           lldb::eBasicTypeInvalid;
+    // Enumerations are promoted to the integers, see Scalar::FromSbValue().
+    lldb::SBType type = sb_value_.GetType().GetCanonicalType();
+    return type.GetBasicType() != lldb::eBasicTypeInvalid ||
+           type.GetTypeClass() == lldb::eTypeClassEnumeration;
   }
   return type_ == Type::BOOLEAN || type_ == Type::SCALAR;
 }
@@ -148,6 +150,18 @@ lldb::SBValue Value::AsSbValue(lldb::SBTarget target) const {
           return CreateSbValue(target, scalar_.value_.double_,
                                lldb::eBasicTypeDouble);
         }
+        case Scalar::Type::INT128: {
+          return CreateSbValue(target, scalar_.value_.int128_,
+                               lldb::eBasicTypeInt128);
+        }
+        case Scalar::Type::UINT128: {
+          return CreateSbValue(target, scalar_.value_.uint128_,
+                               lldb::eBasicTypeUnsignedInt128);
+        }
+        case Scalar::Type::LONG_DOUBLE: {
+          return CreateSbValue(target, scalar_.value_.long_double_,
+                               lldb::eBasicTypeLongDouble);
+        }
       }
       break;
     }
@@ -218,6 +232,20 @@ Value CastScalarToBasicType(const Scalar& value, lldb::SBType type,
     case lldb::eBasicTypeDouble:
       ret = CreateSbValue(target, value.GetAs<double>(), type);
       break;
+    case lldb::eBasicTypeLongDouble:
+      // The host and the target must use the same format.
+      if (IsHostLongDoubleFormat(target, type.GetByteSize())) {
+        ret = CreateSbValue(target, value.GetAs<long double>(), type);
+      }
+      break;
+#if LLDB_EVAL_HAS_INT128
+    case lldb::eBasicTypeInt128:
+      ret = CreateSbValue(target, value.GetAs<Int128>(), type);
+      break;
+    case lldb::eBasicTypeUnsignedInt128:
+      ret = CreateSbValue(target, value.GetAs<UInt128>(), type);
+      break;
+#endif
 
     default:
       // Invalid basic type, can't cast to it.
@@ -278,6 +306,14 @@ Value CastPointerToBasicType(const Pointer& value, lldb::SBType type,
     case lldb::eBasicTypeUnsignedLongLong:
       ret = CreateSbValue(target, static_cast<unsigned long long>(addr), type);
       break;
+#if LLDB_EVAL_HAS_INT128
+    case lldb::eBasicTypeInt128:
+      ret = CreateSbValue(target, static_cast<Int128>(addr), type);
+      break;
+    case lldb::eBasicTypeUnsignedInt128:
+      ret = CreateSbValue(target, static_cast<UInt128>(addr), type);
+      break;
+#endif
 
     default:
       // Invalid basic type, can't cast to it.
@@ -287,4 +323,29 @@ Value CastPointerToBasicType(const Pointer& value, lldb::SBType type,
   return Value(ret);
 }
 
+Value CastScalarToEnumType(const Scalar& value, lldb::SBType type,
+                           lldb::SBTarget target) {
+  lldb::SBValue ret;
+
+  switch (type.GetByteSize()) {
+    case 1:
+      ret = CreateSbValue(target, value.GetAs<int8_t>(), type);
+      break;
+    case 2:
+      ret = CreateSbValue(target, value.GetAs<int16_t>(), type);
+      break;
+    case 4:
+      ret = CreateSbValue(target, value.GetAs<int32_t>(), type);
+      break;
+    case 8:
+      ret = CreateSbValue(target, value.GetAs<int64_t>(), type);
+      break;
+    default:
+      // Unsupported size of the enumeration.
+      return Value();
+  }
+
+  return Value(ret, /* is_rvalue */ true);
+}
+
 }  // namespace lldb_eval
@@ -65,8 +65,14 @@ class Value {
  public:
   bool IsValid() const { return type_ != Type::INVALID; }
 
+  Type type() const { return type_; }
+
   bool IsRValue() const { return is_rvalue_; }
 
+  // Checks if the value is backed by an LLDB value (e.g. a variable), as
+  // opposed to the values computed by the interpreter.
+  bool IsSbValue() const { return type_ == Type::SB_VALUE; }
+
   bool IsScalar();
   bool IsPointer();
 
@@ -93,6 +99,11 @@ Value CastScalarToBasicType(const Scalar& value, lldb::SBType type,
 Value CastPointerToBasicType(const Pointer& value, lldb::SBType type,
                              lldb::SBTarget target);
 
+// Creates the value of the enumeration type, e.g. for the enumerators and the
+// casts of the integers to the enumerations.
+Value CastScalarToEnumType(const Scalar& value, lldb::SBType type,
+                           lldb::SBTarget target);
+
 }  // namespace lldb_eval
 
 #endif  // LLDB_EVAL_VALUE_H_
@@ -0,0 +1,145 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lldb-eval/watch_set.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lldb-eval/api.h"
+#include "lldb-eval/compiled_expression.h"
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBValue.h"
+
+namespace {
+
+// Larger values are compared only by their value strings.
+const uint64_t kMaxDataSize = 64 * 1024;
+
+std::string ToString(const char* str) { return str ? str : ""; }
+
+std::string ReadValueData(lldb::SBValue value) {
+  if (!value.IsValid() || value.GetByteSize() > kMaxDataSize) {
+    return "";
+  }
+  lldb::SBData data = value.GetData();
+  lldb::SBError error;
+  std::string contents(data.GetByteSize(), '\0');
+  if (!contents.empty()) {
+    data.ReadRawData(error, 0, &contents[0], contents.size());
+  }
+  return error.Success() ? contents : "";
+}
+
+bool SnapshotsEqual(const lldb_eval::WatchSnapshot& a,
+                    const lldb_eval::WatchSnapshot& b) {
+  return a.success == b.success && a.value == b.value &&
+         a.summary == b.summary && a.type == b.type && a.error == b.error;
+}
+
+struct EvalResult {
+  lldb::SBValue value;
+  lldb::SBError error;
+  bool reused;
+};
+
+}  // namespace
+
+namespace lldb_eval {
+
+WatchSnapshot TakeSnapshot(lldb::SBValue value, const lldb::SBError& error) {
+  WatchSnapshot snapshot;
+  snapshot.success = !error.Fail();
+  if (snapshot.success) {
+    snapshot.value = ToString(value.GetValue());
+    snapshot.summary = ToString(value.GetSummary());
+    snapshot.type = ToString(value.GetTypeName());
+  } else {
+    snapshot.error = ToString(error.GetCString());
+  }
+  return snapshot;
+}
+
+WatchSetImpl::WatchSetImpl() : next_id_(0) {}
+
+uint32_t WatchSetImpl::Add(const char* expression) {
+  uint32_t id = next_id_++;
+  Entry& entry = entries_[id];
+  entry.expr = std::make_unique<CompiledExpression>(expression);
+  entry.has_snapshot = false;
+  return id;
+}
+
+bool WatchSetImpl::Remove(uint32_t id) { return entries_.erase(id) > 0; }
+
+uint32_t WatchSetImpl::GetSize() const {
+  return static_cast<uint32_t>(entries_.size());
+}
+
+std::vector<WatchChange> WatchSetImpl::Evaluate(lldb::SBFrame frame) {
+  std::vector<WatchChange> changes;
+  // Canonical expression -> result.
+  std::unordered_map<std::string, EvalResult> results;
+
+  for (auto& it : entries_) {
+    Entry& entry = it.second;
+
+    // The entries with the same canonical form are evaluated once. The key
+    // depends on the frame, e.g. "(x)-1" is a cast only if "x" is a type.
+    const std::string& key = entry.expr->Prepare(frame);
+    auto result_it = results.find(key);
+    if (result_it == results.end()) {
+      EvalResult result;
+      result.value = entry.expr->Evaluate(frame, result.error);
+      result.reused = entry.expr->reused();
+      result_it = results.emplace(key, result).first;
+    }
+    const EvalResult& result = result_it->second;
+
+    // Nothing the result depends on has changed.
+    if (result.reused && entry.has_snapshot) {
+      continue;
+    }
+
+    WatchSnapshot snapshot = TakeSnapshot(result.value, result.error);
+    std::string data =
+        snapshot.success ? ReadValueData(result.value) : std::string();
+
+    if (entry.has_snapshot && SnapshotsEqual(snapshot, entry.snapshot) &&
+        data == entry.data) {
+      continue;
+    }
+
+    WatchChange change;
+    change.id = it.first;
+    change.value = result.value;
+    change.error = result.error;
+    change.is_new = !entry.has_snapshot;
+    change.previous = entry.snapshot;
+    changes.push_back(change);
+
+    entry.has_snapshot = true;
+    entry.snapshot = snapshot;
+    entry.data = data;
+  }
+
+  return changes;
+}
+
+}  // namespace lldb_eval
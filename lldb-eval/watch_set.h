@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LLDB_EVAL_WATCH_SET_H_
+#define LLDB_EVAL_WATCH_SET_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lldb-eval/api.h"
+#include "lldb-eval/compiled_expression.h"
+#include "lldb/API/SBError.h"
+#include "lldb/API/SBFrame.h"
+#include "lldb/API/SBValue.h"
+
+namespace lldb_eval {
+
+// Takes a snapshot of the evaluation result.
+WatchSnapshot TakeSnapshot(lldb::SBValue value, const lldb::SBError& error);
+
+// Implementation of the WatchSet API. Every entry is a CompiledExpression, so
+// the entries whose inputs haven't changed since the previous stop are not
+// re-evaluated. Entries with the same canonical form in the given frame (see
+// PrintCanonical()) are evaluated once. The per-stop caches (frame snapshots,
+// scope resolvers) are shared by all entries.
+class WatchSetImpl : public WatchSet {
+ public:
+  WatchSetImpl();
+
+  uint32_t Add(const char* expression) override;
+  bool Remove(uint32_t id) override;
+  uint32_t GetSize() const override;
+  std::vector<WatchChange> Evaluate(lldb::SBFrame frame) override;
+
+ private:
+  struct Entry {
+    std::unique_ptr<CompiledExpression> expr;
+    bool has_snapshot;
+    WatchSnapshot snapshot;
+    // Raw contents of the value. Aggregates don't have a value string, so the
+    // changes of their members are detected by comparing the contents.
+    std::string data;
+  };
+
+ private:
+  uint32_t next_id_;
+  // Ordered by ID.
+  std::map<uint32_t, Entry> entries_;
+};
+
+}  // namespace lldb_eval
+
+#endif  // LLDB_EVAL_WATCH_SET_H_
@@ -12,8 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <array>
 #include <limits>
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 static void TestArithmetic() {
   int a = 1;
@@ -88,6 +95,98 @@ static void TestLocalVariables() {
   // BREAK(TestLocalVariables)
 }
 
+static void TestVariableShadowing() {
+  int a = 1;
+  int b = 2;
+  {
+    int a = 3;
+    {
+      int b = 4;
+
+      // BREAK(TestVariableShadowing)
+    }
+  }
+}
+
+static int shadowed_static = 1;
+
+static void TestStaticShadowing() {
+  int outer = shadowed_static;
+  int shadowed_static = outer + 1;
+  int counter = 10;
+  {
+    static int counter = 20;
+    (void)counter;
+
+    // BREAK(TestStaticShadowing)
+  }
+  (void)counter;
+}
+
+static void TestRegisters() {
+  int a = 3;
+  int b = 4;
+
+  // BREAK(TestRegisters)
+}
+
+static void TestResultCache() {
+  int a = 3;
+  int b = 4;
+
+  // BREAK(TestResultCache)
+}
+
+static void TestNativeFormatter() {
+  enum Flags : unsigned { kLow = 1, kHigh = 0x80000000u };
+  enum Delta { kBack = -1, kForward = 1 };
+
+  int a = 3;
+  int b = 4;
+  Flags flags = static_cast<Flags>(kLow | kHigh);
+  Delta delta = static_cast<Delta>(-2);
+  Delta back = kBack;
+  char c = 'x';
+  char nl = '\n';
+
+  // BREAK(TestNativeFormatter)
+}
+
+static void TestCompiledExpression() {
+  int a = 3;
+  int b = 4;
+
+  // BREAK(TestCompiledExpression)
+}
+
+static void TestWatchSet() {
+  int a = 3;
+  int b = 4;
+
+  // BREAK(TestWatchSet)
+}
+
+static void TestBatchEvaluation() {
+  int a = 3;
+  int b = 4;
+
+  // BREAK(TestBatchEvaluation)
+}
+
+static void TestSerializedExpression() {
+  int a = 3;
+  int b = 4;
+
+  // BREAK(TestSerializedExpression)
+}
+
+static void TestEvaluateInto() {
+  int a = 3;
+  int b = 4;
+
+  // BREAK(TestEvaluateInto)
+}
+
 static void TestIndirection() {
   int val = 1;
   int* p = &val;
@@ -164,6 +263,248 @@ static void TestSubscript() {
   // BREAK(TestSubscript)
 }
 
+static void TestChildPages() {
+  C c_arr[2];
+  c_arr[0].field_ = 0;
+  c_arr[1].field_ = 1;
+
+  uint8_t uint8_arr[256];
+  uint8_arr[255] = 0xAB;
+
+  // BREAK(TestChildPages)
+}
+
+static void TestArraySlice() {
+  typedef int* td_int_ptr_t;
+
+  int int_arr[] = {1, 2, 3};
+  td_int_ptr_t td_int_ptr = int_arr;
+  int idx_1 = 1;
+
+  uint8_t uint8_arr[256];
+  uint8_arr[255] = 0xAB;
+
+  // BREAK(TestArraySlice)
+}
+
+static void TestRangeEvaluation() {
+  struct Point {
+    int x;
+    double y;
+    bool visible;
+  };
+
+  Point points[100];
+  Point* points_ptr = points;
+  for (int i = 0; i < 100; ++i) {
+    points[i].x = i;
+    points[i].y = i * 0.5;
+    points[i].visible = i % 2 == 0;
+  }
+
+  int scale = 3;
+
+  // BREAK(TestRangeEvaluation)
+}
+
+static void TestBuiltins() {
+  int latencies[] = {5, 3, 9, 1, 7};
+  unsigned int counters[] = {0xFFFFFFFF, 2};
+  double weights[] = {0.5, 1.5, -2.0};
+  char name[] = "abc";
+
+  struct Slot {
+    bool busy;
+    int id;
+  };
+  Slot slots[4] = {{true, 10}, {false, 20}, {true, 30}, {false, 40}};
+
+  int n = 3;
+  int* latencies_ptr = latencies;
+
+  // BREAK(TestBuiltins)
+}
+
+static void TestStringBuiltins() {
+  const char* greeting = "hello world";
+  char buf[] = "foo";
+  char unterminated[3] = {'x', 'y', 'z'};
+  const char* null_str = nullptr;
+  int n = 1;
+
+  // BREAK(TestStringBuiltins)
+}
+
+static void TestMemoryBuiltins() {
+  char request[] = "GET /index.html HTTP/1.1";
+  char expected[] = "GET /";
+  const char* request_ptr = request;
+  unsigned char ring[8] = {1, 2, 0xff, 3, 0xde, 0xad, 0xbe, 0xef};
+  unsigned char magic[2] = {0xbe, 0xef};
+  int n = 4;
+
+  // BREAK(TestMemoryBuiltins)
+}
+
+static void TestListBuiltins() {
+  struct Node {
+    int id;
+    Node* next;
+  };
+  struct Chain {
+    int value;
+    struct Links {
+      Chain* prev;
+      Chain* next;
+    } links;
+  };
+
+  Node nodes[5];
+  for (int i = 0; i < 5; ++i) {
+    nodes[i].id = i * 10;
+    nodes[i].next = i + 1 < 5 ? &nodes[i + 1] : nullptr;
+  }
+  Node* list = &nodes[0];
+  Node* empty_list = nullptr;
+
+  Node cycle[3] = {{1, &cycle[1]}, {2, &cycle[2]}, {3, &cycle[0]}};
+  Node* cycle_head = &cycle[0];
+
+  Chain chain[3];
+  for (int i = 0; i < 3; ++i) {
+    chain[i].value = i + 1;
+    chain[i].links.prev = i > 0 ? &chain[i - 1] : nullptr;
+    chain[i].links.next = i + 1 < 3 ? &chain[i + 1] : nullptr;
+  }
+  Chain* chain_head = &chain[0];
+
+  // BREAK(TestListBuiltins)
+}
+
+static void TestBitfields() {
+  enum Mode { kOff, kRead, kWrite, kReadWrite };
+  enum Sign { kNegative = -1, kZero };
+  struct Header {
+    unsigned version : 3;
+    unsigned : 0;
+    unsigned flags : 5;
+  };
+  struct Status : Header {
+    bool ready : 1;
+    Mode mode : 2;
+    Sign sign : 2;
+    int delta : 5;
+    unsigned code : 12;
+    struct {
+      unsigned low : 4;
+      unsigned high : 4;
+    };
+    long long wide : 40;
+    int plain;
+  };
+
+  Status status;
+  status.version = 5;
+  status.flags = 17;
+  status.ready = true;
+  status.mode = kWrite;
+  status.sign = kNegative;
+  status.delta = -3;
+  status.code = 2748;
+  status.low = 9;
+  status.high = 6;
+  status.wide = -549755813887LL;
+  status.plain = 7;
+  Status* status_ptr = &status;
+  Status& status_ref = status;
+
+  // BREAK(TestBitfields)
+}
+
+enum Color { kRed, kGreen = 5, kBlue };
+enum class State { kIdle, kRunning, kStopped = -1 };
+enum Limit : unsigned long long { kMaxLimit = 0xFFFFFFFFFFFFFFFFULL };
+
+namespace net {
+enum Proto { kTcp = 6, kUdp = 17 };
+}  // namespace net
+
+static void TestEnums() {
+  Color color = kGreen;
+  State state = State::kRunning;
+  State stopped = State::kStopped;
+  Limit limit = kMaxLimit;
+  net::Proto proto = net::kUdp;
+
+  // BREAK(TestEnums)
+}
+
+static void TestWideScalars() {
+  __extension__ typedef __int128 int128_t;
+  __extension__ typedef unsigned __int128 uint128_t;
+
+  int128_t i128 = -(static_cast<int128_t>(1) << 100) - 5;
+  int128_t i128_small = 1000;
+  uint128_t u128 = (static_cast<uint128_t>(3) << 100) + 7;
+  uint128_t u128_max = ~static_cast<uint128_t>(0);
+  uint128_t u128_small = 12345;
+  int128_t i128_shift = 3;
+  uint128_t u128_shift = 5;
+  long double ld = 1.5L;
+  long double ld_neg = -0.25L;
+
+  // BREAK(TestWideScalars)
+}
+
+static void TestStdContainers() {
+  struct Node {
+    int value;
+  };
+
+  std::vector<int> vec = {1, 2, 3};
+  std::vector<int>& vec_ref = vec;
+  std::vector<int> empty_vec;
+  std::vector<Node> nodes = {{10}, {20}};
+  std::string short_str = "hi";
+  std::string long_str = "a string which doesn't fit inline";
+  std::array<int, 3> arr = {10, 20, 30};
+  std::unique_ptr<int> uptr(new int(42));
+  std::unique_ptr<Node> node_ptr(new Node{7});
+  std::unique_ptr<int> null_uptr;
+  std::shared_ptr<int> sptr = std::make_shared<int>(5);
+  int n = 1;
+
+  // BREAK(TestStdContainers)
+}
+
+static void TestStdAssociativeContainers() {
+  struct ByLength {
+    bool operator()(const std::string& lhs, const std::string& rhs) const {
+      return lhs.size() < rhs.size();
+    }
+  };
+
+  std::map<int, int> squares;
+  for (int i = -50; i <= 50; ++i) {
+    squares[i] = i * i;
+  }
+  std::map<std::string, int> ages = {{"alice", 30}, {"bob", 25}, {"carol", 41}};
+  std::set<unsigned> primes = {2, 3, 5, 7, 11, 13};
+  std::unordered_map<long, int> ids;
+  for (int i = 0; i < 100; ++i) {
+    ids[i * 7] = i;
+  }
+  std::unordered_map<std::string, double> prices = {{"apple", 1.5},
+                                                    {"pear", 2.25}};
+  std::unordered_set<char> vowels = {'a', 'e', 'i', 'o', 'u'};
+  std::map<std::string, int, ByLength> by_length = {{"one", 1}};
+  std::string bob = "bob";
+  const char* carol = "carol";
+  int n = 7;
+
+  // BREAK(TestStdAssociativeContainers)
+}
+
 // Referenced by TestCStyleCast
 namespace ns {
 
@@ -332,6 +673,27 @@ static void TestTemplateTypes() {
   // BREAK(TestTemplateTypes)
 }
 
+// Referenced by TestScopedLookup.
+namespace scope_ns {
+
+int x = 1;
+typedef int mytype;
+
+namespace inner {
+
+int x = 2;
+using mytype = double;
+
+static void TestScopedLookup() {
+  // BREAK(TestScopedLookup)
+  // BREAK(TestModuleIndex)
+  // BREAK(TestPrepareTarget)
+}
+
+}  // namespace inner
+
+}  // namespace scope_ns
+
 namespace test_binary {
 
 void main() {
@@ -342,13 +704,36 @@ void main() {
   TestPointerArithmetic();
   TestLogicalOperators();
   TestLocalVariables();
+  TestVariableShadowing();
+  TestStaticShadowing();
+  TestRegisters();
+  TestResultCache();
+  TestNativeFormatter();
+  TestCompiledExpression();
+  TestWatchSet();
+  TestBatchEvaluation();
+  TestSerializedExpression();
+  TestEvaluateInto();
   tm.TestInstanceVariables();
   TestIndirection();
   tm.TestAddressOf(42);
   TestSubscript();
+  TestChildPages();
+  TestArraySlice();
+  TestRangeEvaluation();
+  TestBuiltins();
+  TestStringBuiltins();
+  TestMemoryBuiltins();
+  TestListBuiltins();
+  TestBitfields();
+  TestEnums();
+  TestWideScalars();
+  TestStdContainers();
+  TestStdAssociativeContainers();
   TestCStyleCast();
   TestQualifiedId();
   TestTemplateTypes();
+  scope_ns::inner::TestScopedLookup();
 
   // break here
 }
@@ -18,10 +18,15 @@
 #include <string>
 
 #include "cpp-linenoise/linenoise.hpp"
+#include "lldb-eval/api.h"
 #include "lldb-eval/eval.h"
+#include "lldb-eval/frame_snapshot.h"
 #include "lldb-eval/parser.h"
+#include "lldb-eval/result_view.h"
 #include "lldb-eval/runner.h"
+#include "lldb-eval/scope_resolver.h"
 #include "lldb-eval/value.h"
+#include "lldb/API/SBError.h"
 #include "lldb/API/SBFrame.h"
 #include "lldb/API/SBProcess.h"
 #include "lldb/API/SBTarget.h"
@@ -54,14 +59,24 @@ void EvalExpr(lldb::SBFrame frame, const std::string& expr) {
   if (error) {
     std::cerr << error.message() << std::endl;
   } else {
-    // Due to various bugs result can still be NULL even though there was no
-    // error reported. Printing NULL leads to segfault, so check and replace it.
-    auto sb_value =
-        result.AsSbValue(expr_ctx.GetExecutionContext().GetTarget());
+    // Format the result natively, LLDB formatters are used only for the
+    // aggregates.
+    char data[64];
+    lldb_eval::ResultView view(data, sizeof(data));
+    lldb::SBError view_error;
+    lldb_eval::ResultViewBuilder::Build(
+        result, expr_ctx.GetExecutionContext().GetTarget(), &view,
+        view_error);
 
-    if (sb_value.IsValid()) {
-      std::cerr << "value = " << sb_value.GetValue() << std::endl;
-      std::cerr << "type  = " << sb_value.GetTypeName() << std::endl;
+    // Due to various bugs result can still be NULL even though there was no
+    // error reported.
+    if (view.size() > 0) {
+      char value[256];
+      char type[256];
+      view.FormatValue(value, sizeof(value));
+      view.FormatTypeName(type, sizeof(type));
+      std::cerr << "value = " << value << std::endl;
+      std::cerr << "type  = " << type << std::endl;
     } else {
       std::cerr << "Unknown error, result is invalid." << std::endl;
     }
@@ -129,12 +144,38 @@ int main(int argc, char** argv) {
 
   lldb::SBFrame frame = process.GetSelectedThread().GetSelectedFrame();
 
+  // Build the lookup indexes in the background, evaluation doesn't have to
+  // wait for it.
+  auto time_prepare = std::chrono::high_resolution_clock::now();
+  auto preparation = lldb_eval::PrepareTarget(process.GetTarget());
+
   if (repl_mode) {
     RunRepl(frame);
   } else {
+    std::cerr << "[cold]" << std::endl;
+    EvalExpr(frame, expr);
+
+    preparation->Wait();
+    auto elapsed_prepare =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - time_prepare);
+    std::cerr << "==========" << std::endl
+              << "indexed " << preparation->GetNumModules()
+              << " modules in " << elapsed_prepare.count() << "us"
+              << std::endl;
+
+    // Drop the names resolved by the cold run, so that the lookups go through
+    // the indexes again.
+    lldb_eval::ScopeResolver::ClearCache();
+    lldb_eval::FrameSnapshot::ClearCache();
+
+    std::cerr << "[warm]" << std::endl;
     EvalExpr(frame, expr);
   }
 
+  // LLDB must not be used from the background threads after it's terminated.
+  preparation->Wait();
+
   process.Destroy();
   lldb::SBDebugger::Terminate();
 
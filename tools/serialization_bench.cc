@@ -0,0 +1,106 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the time it takes to parse the expressions with the time it takes
+// to load them from the binary encoding.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "lldb-eval/ast.h"
+#include "lldb-eval/ast_serialization.h"
+#include "lldb-eval/expression_context.h"
+#include "lldb-eval/parser.h"
+#include "lldb/API/SBExecutionContext.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace {
+
+const std::vector<std::string> kExpressions = {
+    "1 + 2 * (4 - 5) + 6 / 3 - (7 % 8)",
+    "obj->a->b + obj->a->c * 2",
+    "(unsigned long long)ptr->data[i] << 3",
+    "x > 0 ? (float)x / 3.5 : -~y",
+    "!flag && (count & 0xff) != 0 || items[n - 1].value <= 1e10",
+};
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedUs(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 10000;
+
+  std::vector<lldb_eval::ExprResult> trees;
+  for (const auto& expr : kExpressions) {
+    lldb_eval::ExpressionContext expr_ctx(expr, lldb::SBExecutionContext());
+    lldb_eval::Parser parser(expr_ctx);
+    trees.push_back(parser.Run());
+    if (parser.HasError()) {
+      std::cerr << parser.GetError() << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<const lldb_eval::AstNode*> library_trees;
+  for (const auto& tree : trees) {
+    library_trees.push_back(tree.get());
+  }
+  std::string data = lldb_eval::AstLibrary::Build(library_trees);
+
+  std::string error;
+  auto library = lldb_eval::AstLibrary::Create(
+      llvm::MemoryBuffer::getMemBuffer(data), &error);
+  if (!library) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  auto start = Clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (const auto& expr : kExpressions) {
+      lldb_eval::ExpressionContext expr_ctx(expr, lldb::SBExecutionContext());
+      lldb_eval::Parser parser(expr_ctx);
+      parser.Run();
+    }
+  }
+  double parse_us = ElapsedUs(start);
+
+  start = Clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (uint32_t j = 0; j < library->size(); ++j) {
+      library->Load(j, &error);
+    }
+  }
+  double load_us = ElapsedUs(start);
+
+  double count = static_cast<double>(iterations) *
+                 static_cast<double>(kExpressions.size());
+  std::cout << "encoded size: " << data.size() << " bytes for "
+            << kExpressions.size() << " expressions" << std::endl;
+  std::cout << "parse: " << parse_us / count << "us per expression"
+            << std::endl;
+  std::cout << "load:  " << load_us / count << "us per expression"
+            << std::endl;
+
+  return 0;
+}